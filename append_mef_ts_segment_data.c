@@ -0,0 +1,134 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Append time-series data to the existing data in the specified segment
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *	Adapted from PyMef (by Jan Cimbalnik, Matt Stead, Ben Brinkmann, and Dan Crepeau)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_write.h"
+#include "matmef_utils.h"
+#include "mex_utils.h"
+#include <ctype.h>
+
+
+/**
+ * Main entry point for 'append_mef_ts_segment_data'
+ *
+ * @param channelPath			Path (absolute or relative) to an existing MEF3 channel folder
+ * @param segmentNum			The segment number Should be 0 or a positive integer (1, 2, ...)
+ * @param passwordL1			Level 1 password on the segment data; Pass empty string/variable for no encryption
+ * @param passwordL2			Level 2 password on the segment data; Pass empty string/variable for no encryption
+ * @param data					The data to append as a 1-D array of data-type int32
+ * @param numThreads			The number of threads used to encode the data [1 = single-threaded (default), 0 = one thread per processor]
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	
+	//
+	// channel and segment paths
+	// 
+
+	// check the number of input arguments
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:noChannelPathArg", "'channelPath' input argument not set");
+	if (nrhs < 2)				mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:noSegmentNumPathArg", "'segmentNum' input argument not set");
+
+	si1 channel_path[MEF_FULL_FILE_NAME_BYTES];
+	si1 channel_name[MEF_BASE_FILE_NAME_BYTES];
+	si1 segment_path[MEF_FULL_FILE_NAME_BYTES];
+	int segment_num = 0;
+	
+	// prepare the channel path input argument, check input and transfer the channel path and name to c-variables
+	prep_channel_segment(prhs[0], prhs[1], channel_path, channel_name, &segment_num, segment_path, TIME_SERIES_CHANNEL_TYPE);
+	
+	// build the time-series data and indices filepaths
+	si1 tdat_path[MEF_FULL_FILE_NAME_BYTES];
+	si1 tidx_path[MEF_FULL_FILE_NAME_BYTES];
+	sprintf(tdat_path, "%s%c%s-%06d.tdat", segment_path, pathSeparator, channel_name, segment_num);
+	sprintf(tidx_path, "%s%c%s-%06d.tidx", segment_path, pathSeparator, channel_name, segment_num);
+
+	// check if the data and indices files exist (should be written before)
+	if (!fileExists(tdat_path))
+		mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:dataFileDoesNotExists", "Data file '%s' does not exists, write the data (write_mef_ts_segment_data) before appending", tdat_path);
+	if (!fileExists(tidx_path))
+		mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:indicesFileDoesNotExists", "Indices file '%s' does not exists, write the data (write_mef_ts_segment_data) before appending", tidx_path);
+	
+	
+	// 
+	// passwords
+	// 
+	
+	si1 password_l1[PASSWORD_BYTES] = {0};
+	si1 password_l2[PASSWORD_BYTES] = {0};
+	
+	// check the level 1 password
+	if (nrhs < 3)					mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:noPasswordL1Arg", "'passwordL1' input argument not set, pass empty string for no encryption");
+	if (!mxIsEmpty(prhs[2])) {
+		if (!mxIsChar(prhs[2]))		mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidPasswordL1Arg", "'passwordL1' input argument invalid, should be a string (array of characters)");
+		
+		// convert matlab char-array to UTF-8 character string
+		if (!cpyMxStringToUtf8CharString(prhs[2], password_l1, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidPasswordL1Arg", "'passwordL1' input argument invalid, could not convert matlab char array to UTF-8 bytes");
+		
+	}
+	
+	// check the level 2 password
+	if (nrhs < 4)					mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:noPasswordL2Arg", "'passwordL2' input argument not set, pass empty string for no encryption");
+	if (!mxIsEmpty(prhs[3])) {
+		if (!mxIsChar(prhs[3]))		mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidPasswordL2Arg", "'passwordL2' input argument invalid, should be a string (array of characters)");
+		
+		// convert matlab char-array to UTF-8 character string
+		if (!cpyMxStringToUtf8CharString(prhs[3], password_l2, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidPasswordL2Arg", "'passwordL2' input argument invalid, could not convert matlab char array to UTF-8 bytes");
+		
+	}	
+	
+	// make sure that level 1 is set when level 2 is set
+    if (password_l1[0] == '\0' && password_l2[0] != '\0')
+		mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:level2passWithoutLevel1passArg", "level 2 password cannot be set without level 1 password.");
+	
+	
+	//
+	// Data
+	//
+	
+	if (nrhs < 5)								mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:noDataArg", "'data' input argument not set");
+	if (mxIsEmpty(prhs[4]))						mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidDataArg", "'data' input argument is empty");
+	if (!mxIsNumeric(prhs[4])) 					mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidDataArg", "'data' input argument is not numeric, should be an vector of int32 values");
+	if (mxGetClassID(prhs[4]) != mxINT32_CLASS) mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidDataArg", "'data' input argument has data as '%s', should be an vector of int32 values", mxGetClassName(prhs[4]));
+	if (mxGetNumberOfDimensions(prhs[4]) > 2) 	mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidDataArg", "'data' input argument has too many dimensions, should be an vector of N-x-1 int32 values");
+	
+	// check the size of the dimensions
+	const mwSize *dims = mxGetDimensions(prhs[4]);
+	if (dims[1] != 1) 							mexErrMsgIdAndTxt("MATLAB:append_mef_ts_segment_data:invalidDataArg", "'data' input argument does not have the right dimensions, should be a vector of N-x-1 int32 values");
+	
+	
+	//
+	// Number of threads
+	//
+	
+	si8 num_threads = 1;
+	if (nrhs > 5) {
+		if (!getInputArgAsInt64(prhs[5], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
+	
+	// 
+	// append the data
+	// (# lossy compression flag - not used)
+	// 
+	bool lossy_flag = false;
+	if (!append_mef_ts_data_and_indices(segment_path, password_l1, password_l2, prhs[4], lossy_flag, (si4) num_threads))
+		mexErrMsgTxt("Error while appending time-series data");
+	
+	return;
+	
+}
@@ -0,0 +1,33 @@
+%    
+%   Appends time-series data to the existing data (.tdat & tidx) of a specified segment
+%
+%   append_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, data, numThreads)
+%
+%       channelPath         = Absolute path to an existing MEF3 channel directory
+%       segmentNum          = The segment number. Should be 0 or a positive integer (1, 2, ...)
+%       passwordL1          = Segment data level 1 password; Pass empty string/variable for no encryption
+%       passwordL2          = Segment data level 2 password; Pass empty string/variable for no encryption
+%       data                = The data to append as a 1-D array of data-type int32
+%       numThreads          = (optional) The number of threads used to encode the data [1 = single-threaded, 0 = one thread per processor]
+%                             Default = 1 - Single-threaded
+%
+%   Note:  This function requires that the segment already has time-series data (.tdat & .tidx), written 
+%          using write_mef_ts_segment_data. The new samples are encoded into blocks (with the same number of samples
+%          per block as the existing data) that directly follow the last block in time. The blocks are appended to 
+%          the data file and the indices, universal headers and metadata (.tmet) are updated; existing blocks are not rewritten.
+%
+%   Example:
+%       write_mef_ts_segment_data(chPath, 0, [], [], 1000, int32(firstChunk'));
+%       append_mef_ts_segment_data(chPath, 0, [], [], int32(nextChunk'));
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+%   Adapted from PyMef (by Jan Cimbalnik, Matt Stead, Ben Brinkmann, and Dan Crepeau)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function append_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, data, numThreads)
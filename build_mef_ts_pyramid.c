@@ -0,0 +1,96 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Build the multi-resolution pyramid sidecars (decimated mean, minimum and maximum levels) of a time-series channel
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_pyramid.h"
+
+
+/**
+ * Main entry point for 'build_mef_ts_pyramid'
+ *
+ * @param channelPath       Path (absolute or relative) to the MEF3 channel folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @param numLevels         The number of levels to build [0 = determined by the number of samples in each segment (default)]
+ * @param numThreads        The number of threads used to decode the data [0 = one thread per processor (default), 1 = single-threaded]
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+
+	
+	//
+	// channel path
+	// 
+	
+	// check the channel path input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:build_mef_ts_pyramid:noChannelPathArg", "'channelPath' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:build_mef_ts_pyramid:invalidChannelPathArg", "'channelPath' input argument invalid, should be a string (array of characters)");
+	if(mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:build_mef_ts_pyramid:invalidChannelPathArg", "'channelPath' input argument invalid, argument is empty");
+	
+	// set the channel path
+	si1 channel_path[MEF_FULL_FILE_NAME_BYTES];
+	char *mat_channel_path = mxArrayToString(prhs[0]);
+	MEF_strncpy(channel_path, mat_channel_path, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_channel_path);
+
+
+	// 
+	// password (optional)
+	// 
+	
+	si1 password[PASSWORD_BYTES] = {0};
+	
+	// check if a password input argument is given and is not empty
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+	
+		// check the password input argument data type
+		if (!mxIsChar(prhs[1]))
+			mexErrMsgIdAndTxt("MATLAB:build_mef_ts_pyramid:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+
+		// convert password (matlab char-array to UTF-8 character string)
+		if (!cpyMxStringToUtf8CharString(prhs[1], password, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:build_mef_ts_pyramid:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+
+	}
+	
+	
+    //
+    // Number of levels
+    //
+    
+	si8 num_levels = 0;
+	if (nrhs > 2) {
+		if (!getInputArgAsInt64(prhs[2], "numLevels", 0, PYRAMID_MAX_LEVELS, &num_levels))	return;
+	}
+	
+	
+    //
+    // Number of threads
+    //
+    
+	si8 num_threads = 0;
+	if (nrhs > 3) {
+		if (!getInputArgAsInt64(prhs[3], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
+	
+	// 
+	// build the pyramids
+	// 
+	if (!build_channel_pyramid(channel_path, password, (si4) num_levels, (si4) num_threads))
+		mexErrMsgTxt("Error while building the channel pyramid");
+	
+	// succesfull return from call
+	return;
+	
+}
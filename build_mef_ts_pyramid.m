@@ -0,0 +1,30 @@
+%
+%   Build the multi-resolution pyramids of a time-series channel, which allow for fast zoomed-out reads (see read_mef_ts_pyramid)
+%
+%   build_mef_ts_pyramid(channelPath, password, numLevels, numThreads)
+%
+%       channelPath     = path (absolute or relative) to the MEF3 channel folder
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       numLevels       = The number of levels to build, in which each point holds the mean, minimum and maximum of 4, 16,
+%                         64, ... samples. Pass 0 to add levels as long as a level holds at least 64 points (up to 12 levels).
+%                         Default = 0 - Determined by the number of samples in each segment
+%       numThreads      = The number of threads used to decode the data [1 = single-threaded, 0 = one thread per processor]
+%                         Default = 0 - One thread per processor
+%
+%   Notes:
+%       - A pyramid is built for each segment and stored as a sidecar file (.tpyr) next to the data file (.tdat) of the
+%         segment. The levels are RED encoded (and encrypted with the same level as the data of the segment).
+%       - The sidecar files are specific to matmef and are not part of the MEF3 format; other MEF3 readers ignore them.
+%       - Existing pyramids are replaced. A pyramid is no longer used once the data of its segment changes (e.g. by
+%         appending data), in which case it should be rebuilt.
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function build_mef_ts_pyramid(channelPath, password, numLevels, numThreads)
@@ -0,0 +1,112 @@
+/**
+ * 	@file
+ * 	AES-128 decryption using the AES instructions of the processor (when available), with meflib's AES as fallback
+ *
+ *  Note: the fallback calls meflib's AES_decrypt, so meflib should be compiled into the same mex file
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "matmef_aes.h"
+
+
+#ifdef MATMEF_AESNI
+
+/**
+ * 	Derive the round keys of the equivalent inverse cipher from the expanded key (in the order in which they are used)
+ */
+MATMEF_AESNI_TARGET static void aesni_prepare_round_keys(ui1 *round_keys, ui1 *expanded_key) {
+	si4		i;
+	
+	_mm_storeu_si128((__m128i *) round_keys, _mm_loadu_si128((const __m128i *) (expanded_key + AES_128_ROUNDS * ENCRYPTION_BLOCK_BYTES)));
+	for (i = 1; i < AES_128_ROUNDS; i++)
+		_mm_storeu_si128((__m128i *) (round_keys + i * ENCRYPTION_BLOCK_BYTES), _mm_aesimc_si128(_mm_loadu_si128((const __m128i *) (expanded_key + (AES_128_ROUNDS - i) * ENCRYPTION_BLOCK_BYTES))));
+	_mm_storeu_si128((__m128i *) (round_keys + AES_128_ROUNDS * ENCRYPTION_BLOCK_BYTES), _mm_loadu_si128((const __m128i *) expanded_key));
+	
+}
+
+/**
+ * 	Decrypt a single block (16 bytes) with the AES instructions
+ */
+MATMEF_AESNI_TARGET static void aesni_decrypt_block(ui1 *round_keys, ui1 *in, ui1 *out) {
+	si4		i;
+	
+	__m128i state = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in), _mm_loadu_si128((const __m128i *) round_keys));
+	for (i = 1; i < AES_128_ROUNDS; i++)
+		state = _mm_aesdec_si128(state, _mm_loadu_si128((const __m128i *) (round_keys + i * ENCRYPTION_BLOCK_BYTES)));
+	state = _mm_aesdeclast_si128(state, _mm_loadu_si128((const __m128i *) (round_keys + AES_128_ROUNDS * ENCRYPTION_BLOCK_BYTES)));
+	_mm_storeu_si128((__m128i *) out, state);
+	
+}
+
+#endif
+
+
+/**
+ * 	Check whether the processor supports the AES instructions
+ *
+ * 	@return                     True if the AES instructions can be used, false otherwise
+ */
+bool aes_hardware_available() {
+	
+#ifdef MATMEF_AESNI
+	#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 25)) != 0;
+	#else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			return false;
+		return (ecx & bit_AES) != 0;
+	#endif
+#else
+	return false;
+#endif
+	
+}
+
+/**
+ * 	Prepare a key for decryption, so that it can be reused for each block that is decrypted
+ *
+ * 	@param key                  Pointer to the key struct to prepare
+ * 	@param expanded_key         The expanded key (ENCRYPTION_KEY_BYTES, e.g. the level 1 or 2 key from the password data)
+ */
+void prepare_aes_decrypt_key(AES_DECRYPT_KEY *key, ui1 *expanded_key) {
+	
+	key->expanded_key = expanded_key;
+	key->hardware = aes_hardware_available();
+	
+#ifdef MATMEF_AESNI
+	if (key->hardware)
+		aesni_prepare_round_keys(key->round_keys, expanded_key);
+#endif
+	
+}
+
+/**
+ * 	Decrypt a single block (16 bytes) with a prepared key
+ *
+ * 	@param key                  Pointer to the prepared key
+ * 	@param in                   Pointer to the block to decrypt
+ * 	@param out                  Pointer to the output (can be the same as the input, decrypting in place)
+ */
+void aes_decrypt_block(AES_DECRYPT_KEY *key, ui1 *in, ui1 *out) {
+	
+#ifdef MATMEF_AESNI
+	if (key->hardware) {
+		aesni_decrypt_block(key->round_keys, in, out);
+		return;
+	}
+#endif
+	
+	AES_decrypt(in, out, NULL, key->expanded_key);
+	
+}
@@ -0,0 +1,57 @@
+#ifndef MATMEF_AES_
+#define MATMEF_AES_
+/**
+ * 	@file - headers
+ * 	AES-128 decryption using the AES instructions of the processor (when available), with meflib's AES as fallback
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include <stdbool.h>
+
+// The AES instructions (AES-NI) are only available on x86/x64, whether the processor supports them is determined at runtime
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define MATMEF_AESNI
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define MATMEF_AESNI_TARGET
+	#else
+		#include <cpuid.h>
+		#define MATMEF_AESNI_TARGET		__attribute__((target("aes,sse2")))
+	#endif
+	#include <wmmintrin.h>
+#endif
+
+// Number of rounds (and round keys - 1) of AES-128
+#define AES_128_ROUNDS		10
+
+
+// 
+// Structures
+//
+
+// A key to decrypt with, prepared once (e.g. for all blocks of a read)
+typedef struct {
+	ui1		*expanded_key;									// the expanded key (as meflib expands it), used when the AES instructions are not available
+	bool	hardware;										// whether the AES instructions are used
+	ui1		round_keys[(AES_128_ROUNDS + 1) * ENCRYPTION_BLOCK_BYTES];	// the (reversed) round keys of the equivalent inverse cipher, for the AES instructions
+} AES_DECRYPT_KEY;
+
+
+//
+// Functions
+//
+
+bool aes_hardware_available();
+void prepare_aes_decrypt_key(AES_DECRYPT_KEY *key, ui1 *expanded_key);
+void aes_decrypt_block(AES_DECRYPT_KEY *key, ui1 *in, ui1 *out);
+
+
+#endif   // MATMEF_AES_
@@ -0,0 +1,229 @@
+/**
+ * 	@file
+ * 	Batched reading of many byte ranges of (many) files at once, by a pool of threads
+ *
+ *	Reading a range of many channels otherwise reads the data files one after another, with a single read in flight at
+ *	any time. Storage such as NVMe drives and parallel (network) filesystems only reach their throughput with many
+ *	requests in flight. A batch therefore collects all byte ranges that are needed up front (split into chunks) and has
+ *	them read by a pool of threads. Each file is opened once for the batch, and the threads read chunks of it at the
+ *	same time with positioned reads (pread, or ReadFile at an offset on Windows) on the shared descriptor, which go
+ *	straight to the file without a (per thread) stdio buffer or file position.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_batchio.h"
+
+
+/**
+ * 	Add a byte range of a file to a batch, split into chunks of (at most) BATCH_READ_CHUNK_BYTES
+ *
+ * 	@param reads                Pointer to the array of reads in the batch (reallocated when needed)
+ * 	@param num_reads            Pointer to the number of reads in the batch
+ * 	@param reads_size           Pointer to the allocated number of reads in the array
+ * 	@param file_path            The path to the file (the pointer is kept, the path should remain valid until the batch is read)
+ * 	@param file_offset          The offset of the range in the file
+ * 	@param bytes                The number of bytes to read
+ * 	@param data                 The buffer to read the range into
+ * 	@return                     True if successful, false on failure (memory allocation)
+ */
+bool add_batch_reads(BATCH_READ **reads, ui8 *num_reads, ui8 *reads_size, si1 *file_path, ui8 file_offset, ui8 bytes, ui1 *data) {
+
+	while (bytes > 0) {
+
+		// make room in the array
+		if (*num_reads == *reads_size) {
+			ui8 new_size = (*reads_size == 0) ? 256 : *reads_size * 2;
+			BATCH_READ *new_reads = (BATCH_READ *) realloc(*reads, (size_t) new_size * sizeof(BATCH_READ));
+			if (new_reads == NULL)
+				return false;
+			*reads = new_reads;
+			*reads_size = new_size;
+		}
+
+		// add a chunk
+		BATCH_READ *read = &(*reads)[(*num_reads)++];
+		read->file_path = file_path;
+		read->file_offset = file_offset;
+		read->bytes = (bytes > BATCH_READ_CHUNK_BYTES) ? BATCH_READ_CHUNK_BYTES : bytes;
+		read->data = data;
+		read->bytes_read = 0;
+
+		file_offset += read->bytes;
+		data += read->bytes;
+		bytes -= read->bytes;
+
+	}
+
+	return true;
+
+}
+
+/**
+ * 	Read all the byte ranges of a batch
+ *
+ *	Each file is opened once (on the calling thread); reads of the same file that follow each other share the opened 
+ *	file. The reads are divided over the threads interleaved, so the reads of each file (which are added in order) are 
+ *	spread over the threads as well. Bytes that could not be read are left as they are, the number of bytes read is set
+ *	for each read.
+ *
+ * 	@param reads                The reads in the batch
+ * 	@param num_reads            The number of reads in the batch
+ * 	@param num_threads          The number of threads to read with (the number of reads in flight; capped at the number of reads)
+ * 	@return                     True if all bytes were read, false otherwise
+ */
+bool read_batch(BATCH_READ *reads, ui8 num_reads, si4 num_threads) {
+	si4		i;
+	ui8		j;
+
+	if (num_reads == 0)		return true;
+
+	// open the files (a file for each run of reads of the same file)
+	ui8 num_files = 0;
+	for (j = 0; j < num_reads; j++)
+		if (j == 0 || reads[j].file_path != reads[j - 1].file_path)		num_files++;
+	BATCH_FILE *files = (BATCH_FILE *) calloc((size_t) num_files, sizeof(BATCH_FILE));
+	if (files == NULL)
+		return false;
+	num_files = 0;
+	for (j = 0; j < num_reads; j++) {
+		if (j == 0 || reads[j].file_path != reads[j - 1].file_path)
+			open_batch_file(&files[num_files++], reads[j].file_path);
+		reads[j].file = num_files - 1;
+	}
+
+	// divide the reads over the workers
+	si4 num_workers = resolve_number_of_threads(num_threads, (si8) num_reads);
+	BATCH_WORKER *workers = (BATCH_WORKER *) calloc((size_t) num_workers, sizeof(BATCH_WORKER));
+	if (workers == NULL)
+		num_workers = 0;
+	for (i = 0; i < num_workers; i++) {
+		workers[i].reads = reads;
+		workers[i].num_reads = num_reads;
+		workers[i].files = files;
+		workers[i].first_read = (ui8) i;
+		workers[i].read_step = (ui8) num_workers;
+	}
+
+	// read (sequentially on the calling thread if the workers could not be allocated)
+	if (num_workers > 0) {
+		run_threads(num_workers, read_batch_worker, workers, sizeof(BATCH_WORKER));
+	} else {
+		BATCH_WORKER worker = {reads, num_reads, files, 0, 1};
+		read_batch_worker(&worker);
+	}
+	free (workers);
+
+	// close the files
+	for (j = 0; j < num_files; j++)
+		close_batch_file(&files[j]);
+	free (files);
+
+	// check if everything was read
+	for (j = 0; j < num_reads; j++)
+		if (reads[j].bytes_read != reads[j].bytes)	return false;
+	return true;
+
+}
+
+/**
+ * 	Worker function that reads part of a batch, with positioned reads on the (shared) opened files
+ *
+ *	Note: runs on other threads than the main (matlab) thread, so no matlab API functions are called here
+ *
+ * 	@param arg                  Pointer to the (BATCH_WORKER) worker
+ */
+void read_batch_worker(void *arg) {
+	BATCH_WORKER *worker = (BATCH_WORKER *) arg;
+	ui8		i;
+
+	for (i = worker->first_read; i < worker->num_reads; i += worker->read_step) {
+		BATCH_READ *read = &worker->reads[i];
+		read->bytes_read = read_batch_file_at(&worker->files[read->file], read->file_offset, read->data, read->bytes);
+	}
+
+}
+
+/**
+ * 	Open a file for the reads of a batch
+ *
+ * 	@param file                 Pointer to the batch file to open (set as not opened on failure)
+ * 	@param file_path            The path to the file
+ * 	@return                     True if successful, false on failure
+ */
+bool open_batch_file(BATCH_FILE *file, si1 *file_path) {
+	#ifdef _WIN32
+		file->handle = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		return (file->handle != INVALID_HANDLE_VALUE);
+	#else
+		file->fd = open(file_path, O_RDONLY);
+		return (file->fd >= 0);
+	#endif
+}
+
+/**
+ * 	Close a file that was opened for the reads of a batch
+ *
+ * 	@param file                 Pointer to the batch file
+ */
+void close_batch_file(BATCH_FILE *file) {
+	#ifdef _WIN32
+		if (file->handle != INVALID_HANDLE_VALUE)
+			CloseHandle(file->handle);
+		file->handle = INVALID_HANDLE_VALUE;
+	#else
+		if (file->fd >= 0)
+			close(file->fd);
+		file->fd = -1;
+	#endif
+}
+
+/**
+ * 	Read a number of bytes from an opened batch file at a given offset, without using (or moving) a shared file position,
+ *	so that multiple threads can read from the same file at the same time
+ *
+ *	Note: runs on other threads than the main (matlab) thread, so no matlab API functions are called here
+ *
+ * 	@param file                 Pointer to the opened batch file
+ * 	@param offset               The offset in the file to read from
+ * 	@param data                 The buffer to read into
+ * 	@param num_bytes            The number of bytes to read
+ * 	@return                     The number of bytes that were read
+ */
+ui8 read_batch_file_at(BATCH_FILE *file, ui8 offset, ui1 *data, ui8 num_bytes) {
+	ui8		bytes_read = 0;
+
+	#ifdef _WIN32
+		if (file->handle == INVALID_HANDLE_VALUE)	return 0;
+		while (bytes_read < num_bytes) {
+			OVERLAPPED overlapped;
+			DWORD n = 0;
+			memset(&overlapped, 0, sizeof(OVERLAPPED));
+			overlapped.Offset = (DWORD) ((offset + bytes_read) & 0xFFFFFFFF);
+			overlapped.OffsetHigh = (DWORD) ((offset + bytes_read) >> 32);
+			DWORD to_read = (num_bytes - bytes_read > 0x40000000) ? 0x40000000 : (DWORD) (num_bytes - bytes_read);
+			if (!ReadFile(file->handle, data + bytes_read, to_read, &n, &overlapped) || n == 0)
+				break;
+			bytes_read += n;
+		}
+	#else
+		if (file->fd < 0)	return 0;
+		while (bytes_read < num_bytes) {
+			ssize_t n = pread(file->fd, data + bytes_read, (size_t) (num_bytes - bytes_read), (off_t) (offset + bytes_read));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			bytes_read += (ui8) n;
+		}
+	#endif
+
+	return bytes_read;
+
+}
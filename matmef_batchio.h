@@ -0,0 +1,76 @@
+#ifndef MATMEF_BATCHIO_
+#define MATMEF_BATCHIO_
+/**
+ * 	@file - headers
+ * 	Batched reading of many byte ranges of (many) files at once, by a pool of threads
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include "matmef_threads.h"
+#include <stdbool.h>
+
+#ifndef _WIN32
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+// The maximum size of a single read in a batch (larger ranges are split, so that they are read in parallel as well)
+#define BATCH_READ_CHUNK_BYTES		(4 * 1024 * 1024)
+
+
+//
+// Structures
+//
+
+// A file that is opened once for (all reads of) a batch, and read from by all workers at the same time
+typedef struct {
+	#ifdef _WIN32
+		HANDLE	handle;				// INVALID_HANDLE_VALUE if the file could not be opened
+	#else
+		int		fd;					// -1 if the file could not be opened
+	#endif
+} BATCH_FILE;
+
+// A byte range of a file to read in a batch
+typedef struct {
+	si1		*file_path;			// the path to the file (reads of the same file should point to the same path, they then share an opened file)
+	ui8		file_offset;
+	ui8		bytes;
+	ui1		*data;				// the buffer to read into
+	ui8		bytes_read;			// the number of bytes that were read (set once the batch is read)
+	ui8		file;				// the index of the opened file (set when the batch is read)
+} BATCH_READ;
+
+// A worker that reads part of a batch
+typedef struct {
+	BATCH_READ	*reads;
+	ui8			num_reads;
+	BATCH_FILE	*files;				// the opened files of the batch
+	ui8			first_read;			// the first read of the worker
+	ui8			read_step;			// the step to the next read of the worker
+} BATCH_WORKER;
+
+
+//
+// Functions
+//
+
+bool add_batch_reads(BATCH_READ **reads, ui8 *num_reads, ui8 *reads_size, si1 *file_path, ui8 file_offset, ui8 bytes, ui1 *data);
+bool read_batch(BATCH_READ *reads, ui8 num_reads, si4 num_threads);
+void read_batch_worker(void *arg);
+bool open_batch_file(BATCH_FILE *file, si1 *file_path);
+void close_batch_file(BATCH_FILE *file);
+ui8 read_batch_file_at(BATCH_FILE *file, ui8 offset, ui1 *data, ui8 num_bytes);
+
+
+#endif   // MATMEF_BATCHIO_
@@ -0,0 +1,258 @@
+/**
+ * 	@file
+ * 	A size-bounded (least recently used) cache of decoded RED blocks, which is kept alive across mex calls
+ *
+ *	Reads that revisit the same blocks (e.g. scrolling back and forth through a channel in a viewer, or sliding
+ *	windows) copy the samples of these blocks from the cache instead of decoding them again. The cache is bounded
+ *	by the number of bytes of decoded samples, when full the least recently used blocks are evicted.
+ *
+ *	Note: the cache is not thread-safe, it should only be used from the main (matlab) thread
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_cache.h"
+
+
+// the cache (disabled until a capacity is set)
+static BLOCK_CACHE	block_cache = {0};
+
+
+/**
+ * 	Retrieve the cache of decoded blocks
+ *
+ * 	@return                     Pointer to the cache, or NULL if the cache is disabled
+ */
+BLOCK_CACHE *get_block_cache() {
+	return (block_cache.capacity > 0) ? &block_cache : NULL;
+}
+
+/**
+ * 	Set the capacity of the cache of decoded blocks (evicting the least recently used blocks if the cache holds more)
+ *
+ * 	@param capacity             The maximum number of bytes of decoded samples to cache (0 = disable and release the cache)
+ */
+void set_block_cache_capacity(ui8 capacity) {
+	
+	evict_cached_blocks(&block_cache, capacity);
+	block_cache.capacity = capacity;
+	
+	// release the hash table when disabled
+	if (capacity == 0) {
+		free (block_cache.buckets);
+		block_cache.buckets = NULL;
+	}
+	
+}
+
+/**
+ * 	Remove all blocks from the cache of decoded blocks and reset the hit/miss counters
+ */
+void flush_block_cache() {
+	evict_cached_blocks(&block_cache, 0);
+	block_cache.hits = 0;
+	block_cache.misses = 0;
+}
+
+/**
+ * 	Determine the identifier of a channel for the keys of its cached blocks (a hash of the path of the channel)
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@return                     The identifier
+ */
+ui8 block_cache_channel_id(CHANNEL *channel) {
+	ui8		hash = 14695981039346656037ULL;		// FNV-1a
+	si1		*c;
+	
+	for (c = channel->path; *c; c++)
+		hash = (hash ^ (ui1) *c) * 1099511628211ULL;
+	hash = (hash ^ (ui1) '/') * 1099511628211ULL;
+	for (c = channel->name; *c; c++)
+		hash = (hash ^ (ui1) *c) * 1099511628211ULL;
+	
+	return hash;
+}
+
+/**
+ * 	Set the key of a block in the cache
+ *
+ * 	@param key                  Pointer to the key to set
+ * 	@param channel_id           The identifier of the channel (see block_cache_channel_id)
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param segment              The index of the segment
+ * 	@param block                The index of the block in the segment
+ * 	@param access_level         The access level of the password that the block is decoded with
+ */
+void set_block_cache_key(BLOCK_CACHE_KEY *key, ui8 channel_id, CHANNEL *channel, ui4 segment, ui4 block, si1 access_level) {
+	FILE_PROCESSING_STRUCT *data_fps = channel->segments[segment].time_series_data_fps;
+	
+	memset(key, 0, sizeof(BLOCK_CACHE_KEY));
+	key->channel_id = channel_id;
+	key->segment = segment;
+	key->block = block;
+	key->file_length = data_fps->file_length;
+	key->body_CRC = data_fps->universal_header->body_CRC;
+	key->access_level = access_level;
+	
+}
+
+/**
+ * 	Determine the bucket of a key in the hash table of the cache
+ *
+ * 	@param key                  Pointer to the key
+ * 	@return                     The index of the bucket
+ */
+static ui4 block_cache_bucket(BLOCK_CACHE_KEY *key) {
+	ui8 hash = key->channel_id ^ ((ui8) key->segment * 0x9E3779B97F4A7C15ULL) ^ ((ui8) key->block * 0xC2B2AE3D27D4EB4FULL);
+	return (ui4) ((hash ^ (hash >> 32)) % BLOCK_CACHE_BUCKETS);
+}
+
+/**
+ * 	Check whether two keys are equal
+ */
+static bool block_cache_keys_equal(BLOCK_CACHE_KEY *a, BLOCK_CACHE_KEY *b) {
+	return a->channel_id == b->channel_id && a->segment == b->segment && a->block == b->block && 
+		   a->file_length == b->file_length && a->body_CRC == b->body_CRC && a->access_level == b->access_level;
+}
+
+/**
+ * 	Find a block in the cache (and mark it as the most recently used), counting a hit or a miss
+ *  (a miss is only counted when the read could have added the block to the cache)
+ *
+ * 	@param cache                Pointer to the cache
+ * 	@param key                  Pointer to the key of the block
+ * 	@param validated            Whether the CRC of the block should have been validated (blocks that were decoded in a 
+ *                              trusted read are not used for reads that validate the CRCs)
+ * 	@param number_of_samples    The number of samples in the block (as a check)
+ * 	@param cacheable            Whether the read adds the blocks it decodes to the cache (if not, a miss is not counted)
+ * 	@return                     Pointer to the decoded samples of the block, or NULL if the block is not in the cache
+ */
+si4 *find_cached_block(BLOCK_CACHE *cache, BLOCK_CACHE_KEY *key, bool validated, ui4 number_of_samples, bool cacheable) {
+	BLOCK_CACHE_ENTRY	*entry = NULL;
+	
+	if (cache->buckets != NULL) {
+		entry = cache->buckets[block_cache_bucket(key)];
+		while (entry != NULL && !block_cache_keys_equal(&entry->key, key))
+			entry = entry->next_in_bucket;
+	}
+	if (entry == NULL || (validated && !entry->validated) || entry->number_of_samples != number_of_samples) {
+		if (cacheable)
+			cache->misses++;
+		return NULL;
+	}
+	
+	// move to the front of the list
+	if (entry != cache->newest) {
+		entry->newer->older = entry->older;
+		if (entry->older != NULL)	entry->older->newer = entry->newer;
+		else						cache->oldest = entry->newer;
+		entry->newer = NULL;
+		entry->older = cache->newest;
+		cache->newest->newer = entry;
+		cache->newest = entry;
+	}
+	
+	cache->hits++;
+	return entry->samples;
+	
+}
+
+/**
+ * 	Add a (decoded) block to the cache, evicting the least recently used blocks to make room
+ *  (a block that is already in the cache is replaced)
+ *
+ * 	@param cache                Pointer to the cache
+ * 	@param key                  Pointer to the key of the block
+ * 	@param samples              The decoded samples of the block (copied into the cache)
+ * 	@param number_of_samples    The number of samples in the block
+ * 	@param validated            Whether the CRC of the block was validated
+ */
+void cache_block(BLOCK_CACHE *cache, BLOCK_CACHE_KEY *key, si4 *samples, ui4 number_of_samples, bool validated) {
+	BLOCK_CACHE_ENTRY	*entry;
+	ui8					bytes = (ui8) number_of_samples * sizeof(si4);
+	
+	if (bytes == 0 || bytes > cache->capacity)	return;
+	
+	// allocate the hash table on first use
+	if (cache->buckets == NULL) {
+		cache->buckets = (BLOCK_CACHE_ENTRY **) calloc((size_t) BLOCK_CACHE_BUCKETS, sizeof(BLOCK_CACHE_ENTRY *));
+		if (cache->buckets == NULL)		return;
+	}
+	
+	// remove an existing entry of the block
+	ui4 bucket = block_cache_bucket(key);
+	for (entry = cache->buckets[bucket]; entry != NULL; entry = entry->next_in_bucket) {
+		if (block_cache_keys_equal(&entry->key, key)) {
+			remove_cached_block(cache, entry);
+			break;
+		}
+	}
+	
+	// make room
+	evict_cached_blocks(cache, cache->capacity - bytes);
+	
+	// create the entry (with the samples directly after it)
+	entry = (BLOCK_CACHE_ENTRY *) malloc(sizeof(BLOCK_CACHE_ENTRY) + (size_t) bytes);
+	if (entry == NULL)	return;
+	entry->key = *key;
+	entry->validated = validated;
+	entry->number_of_samples = number_of_samples;
+	entry->samples = (si4 *) (entry + 1);
+	memcpy(entry->samples, samples, (size_t) bytes);
+	
+	// add to the front of the list and to the bucket
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if (cache->newest != NULL)	cache->newest->newer = entry;
+	else						cache->oldest = entry;
+	cache->newest = entry;
+	entry->next_in_bucket = cache->buckets[bucket];
+	cache->buckets[bucket] = entry;
+	
+	cache->bytes += bytes;
+	cache->num_entries++;
+	
+}
+
+/**
+ * 	Evict the least recently used blocks from the cache until it holds no more than a given number of bytes
+ *
+ * 	@param cache                Pointer to the cache
+ * 	@param capacity             The maximum number of bytes of decoded samples to keep
+ */
+void evict_cached_blocks(BLOCK_CACHE *cache, ui8 capacity) {
+	while (cache->oldest != NULL && cache->bytes > capacity)
+		remove_cached_block(cache, cache->oldest);
+}
+
+/**
+ * 	Remove a block from the cache and free its memory
+ *
+ * 	@param cache                Pointer to the cache
+ * 	@param entry                Pointer to the entry of the block
+ */
+void remove_cached_block(BLOCK_CACHE *cache, BLOCK_CACHE_ENTRY *entry) {
+	
+	// remove from the list
+	if (entry->newer != NULL)	entry->newer->older = entry->older;
+	else						cache->newest = entry->older;
+	if (entry->older != NULL)	entry->older->newer = entry->newer;
+	else						cache->oldest = entry->newer;
+	
+	// remove from the bucket
+	BLOCK_CACHE_ENTRY **link = &cache->buckets[block_cache_bucket(&entry->key)];
+	while (*link != entry)
+		link = &(*link)->next_in_bucket;
+	*link = entry->next_in_bucket;
+	
+	cache->bytes -= (ui8) entry->number_of_samples * sizeof(si4);
+	cache->num_entries--;
+	free (entry);
+	
+}
@@ -0,0 +1,81 @@
+#ifndef MATMEF_CACHE_
+#define MATMEF_CACHE_
+/**
+ * 	@file - headers
+ * 	A size-bounded (least recently used) cache of decoded RED blocks, which is kept alive across mex calls
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include <stdbool.h>
+
+
+// The default size of the cache (in bytes of decoded samples)
+#define BLOCK_CACHE_DEFAULT_BYTES	(256 * 1024 * 1024)
+
+// The number of buckets in the hash table of the cache
+#define BLOCK_CACHE_BUCKETS			65536
+
+
+// 
+// Structures
+//
+
+// The key of a cached block, which identifies the block by its channel, segment and index, and the data file by its
+// length and body CRC (so that blocks of data files that were changed, e.g. appended to, are not used)
+typedef struct {
+	ui8		channel_id;			// hash of the channel path
+	ui4		segment;
+	ui4		block;				// index of the block in the segment
+	si8		file_length;		// length of the segment's data file
+	ui4		body_CRC;			// body CRC of the segment's data file
+	si1		access_level;		// the access level of the password that the block was decoded with
+} BLOCK_CACHE_KEY;
+
+// A cached (decoded) block
+typedef struct BLOCK_CACHE_ENTRY {
+	BLOCK_CACHE_KEY				key;
+	bool						validated;			// whether the CRC of the block was validated when it was decoded
+	ui4							number_of_samples;
+	si4							*samples;			// the decoded samples (allocated together with the entry)
+	struct BLOCK_CACHE_ENTRY	*newer;				// the neighbours in the list of entries (from most to least recently used)
+	struct BLOCK_CACHE_ENTRY	*older;
+	struct BLOCK_CACHE_ENTRY	*next_in_bucket;	// the next entry in the same bucket of the hash table
+} BLOCK_CACHE_ENTRY;
+
+// The cache
+typedef struct {
+	BLOCK_CACHE_ENTRY	**buckets;
+	BLOCK_CACHE_ENTRY	*newest;
+	BLOCK_CACHE_ENTRY	*oldest;
+	ui8					capacity;			// the maximum number of bytes of decoded samples (0 = disabled)
+	ui8					bytes;				// the number of bytes of decoded samples in the cache
+	ui8					num_entries;
+	ui8					hits;
+	ui8					misses;
+} BLOCK_CACHE;
+
+
+//
+// Functions
+//
+
+BLOCK_CACHE *get_block_cache();
+void set_block_cache_capacity(ui8 capacity);
+void flush_block_cache();
+ui8 block_cache_channel_id(CHANNEL *channel);
+void set_block_cache_key(BLOCK_CACHE_KEY *key, ui8 channel_id, CHANNEL *channel, ui4 segment, ui4 block, si1 access_level);
+si4 *find_cached_block(BLOCK_CACHE *cache, BLOCK_CACHE_KEY *key, bool validated, ui4 number_of_samples, bool cacheable);
+void cache_block(BLOCK_CACHE *cache, BLOCK_CACHE_KEY *key, si4 *samples, ui4 number_of_samples, bool validated);
+void evict_cached_blocks(BLOCK_CACHE *cache, ui8 capacity);
+void remove_cached_block(BLOCK_CACHE *cache, BLOCK_CACHE_ENTRY *entry);
+
+
+#endif   // MATMEF_CACHE_
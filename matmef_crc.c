@@ -0,0 +1,104 @@
+/**
+ * 	@file
+ * 	Fast (slice-by-8) calculation of the Koopman-32 CRC that is used by MEF3
+ *
+ *  The CRC is identical to the one calculated by meflib (CRC_calculate/CRC_update), but instead of 
+ *  one table lookup per byte, eight bytes are processed per step using eight derived tables.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "matmef_crc.h"
+
+
+// the (byte-at-a-time) Koopman table that meflib uses, which is also the first of the slice tables
+static ui4 crc_tables[CRC_SLICE_BYTES][CRC_TABLE_ENTRIES] = { CRC_KOOPMAN32_KEY };
+static bool crc_tables_initialized = false;
+
+
+/**
+ * 	Derive the slice tables from the Koopman table
+ *
+ *	Note: should be called (from the main thread) before any threads calculate CRCs. Until initialized, 
+ *	      the CRCs are calculated byte-at-a-time (which gives the same result)
+ */
+void initialize_crc_tables() {
+	ui4		i, k;
+	
+	if (crc_tables_initialized)		return;
+	
+	// each table advances the CRC of the previous table by one more (zero) byte
+	for (k = 1; k < CRC_SLICE_BYTES; k++)
+		for (i = 0; i < CRC_TABLE_ENTRIES; i++)
+			crc_tables[k][i] = (crc_tables[k - 1][i] >> 8) ^ crc_tables[0][crc_tables[k - 1][i] & 0xff];
+	
+	crc_tables_initialized = true;
+	
+}
+
+/**
+ * 	Update a CRC with a block of data
+ *
+ * 	@param block                Pointer to the data
+ * 	@param block_bytes          The number of bytes of data
+ * 	@param current_crc          The CRC to update (CRC_START_VALUE to start a new CRC)
+ * 	@return                     The updated CRC
+ */
+ui4 crc_update_sliced(const ui1 *block, si8 block_bytes, ui4 current_crc) {
+	ui4		crc = current_crc;
+	
+#ifdef MATMEF_CRC_SLICED
+	if (crc_tables_initialized) {
+		ui4		one, two;
+		
+		// process eight bytes per step
+		while (block_bytes >= CRC_SLICE_BYTES) {
+			memcpy(&one, block, sizeof(ui4));
+			memcpy(&two, block + sizeof(ui4), sizeof(ui4));
+			one ^= crc;
+			crc =	crc_tables[7][one & 0xff] ^ crc_tables[6][(one >> 8) & 0xff] ^ crc_tables[5][(one >> 16) & 0xff] ^ crc_tables[4][one >> 24] ^
+					crc_tables[3][two & 0xff] ^ crc_tables[2][(two >> 8) & 0xff] ^ crc_tables[1][(two >> 16) & 0xff] ^ crc_tables[0][two >> 24];
+			block += CRC_SLICE_BYTES;
+			block_bytes -= CRC_SLICE_BYTES;
+		}
+		
+	}
+#endif
+	
+	// process the remaining bytes one at a time
+	while (block_bytes-- > 0)
+		crc = (crc >> 8) ^ crc_tables[0][(crc ^ *block++) & 0xff];
+	
+	return crc;
+	
+}
+
+/**
+ * 	Calculate the CRC of a block of data
+ *
+ * 	@param block                Pointer to the data
+ * 	@param block_bytes          The number of bytes of data
+ * 	@return                     The CRC
+ */
+ui4 crc_calculate_sliced(const ui1 *block, si8 block_bytes) {
+	return crc_update_sliced(block, block_bytes, CRC_START_VALUE);
+}
+
+/**
+ * 	Check whether the CRC of a block of data matches a given CRC
+ *
+ * 	@param block                Pointer to the data
+ * 	@param block_bytes          The number of bytes of data
+ * 	@param crc_to_validate      The CRC to compare to
+ * 	@return                     True if the CRC matches, false otherwise
+ */
+bool crc_validate_sliced(const ui1 *block, si8 block_bytes, ui4 crc_to_validate) {
+	return crc_calculate_sliced(block, block_bytes) == crc_to_validate;
+}
@@ -0,0 +1,39 @@
+#ifndef MATMEF_CRC_
+#define MATMEF_CRC_
+/**
+ * 	@file - headers
+ * 	Fast (slice-by-8) calculation of the Koopman-32 CRC that is used by MEF3
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include <stdbool.h>
+
+
+// the number of bytes that are processed per step (and the number of tables)
+#define CRC_SLICE_BYTES		8
+
+// slicing is only used on little-endian platforms, others fall back to the byte-at-a-time calculation
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+	#define MATMEF_CRC_SLICED
+#endif
+
+
+//
+// Functions
+//
+
+void initialize_crc_tables();
+ui4 crc_update_sliced(const ui1 *block, si8 block_bytes, ui4 current_crc);
+ui4 crc_calculate_sliced(const ui1 *block, si8 block_bytes);
+bool crc_validate_sliced(const ui1 *block, si8 block_bytes, ui4 crc_to_validate);
+
+
+#endif   // MATMEF_CRC_
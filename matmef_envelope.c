@@ -0,0 +1,507 @@
+/**
+ * 	@file
+ * 	Min/max envelopes and contiguous ranges of time-series channels, built from the time-series indices only (without decoding any data)
+ *
+ *	Each time-series index entry holds the start time, number of samples, discontinuity flag and the minimum and maximum 
+ *	sample value of its block. The envelopes and ranges are therefore built by only reading the metadata and index files
+ *	of the channels, which makes it possible to get an overview of a whole recording without reading or decoding the data files.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_envelope.h"
+#include "matmef_crc.h"
+
+// the meflib globals (defined in meflib.c, which is included by matmef_read.c)
+extern MEF_GLOBALS	*MEF_globals;
+
+
+// Envelope struct (one for each channel)
+const int ENVELOPE_NUMFIELDS			= 5;
+const char *ENVELOPE_FIELDNAMES[] 		= {	
+	"name",
+	"time",
+	"numSamples",
+	"min",
+	"max"
+};
+
+// Ranges struct (one for each channel)
+const int RANGES_NUMFIELDS				= 6;
+const char *RANGES_FIELDNAMES[] 		= {	
+	"name",
+	"startSample",
+	"endSample",
+	"startTime",
+	"endTime",
+	"segment"
+};
+
+
+/**
+ * 	Build the min/max envelopes of multiple time-series channels in a session from their indices, either per
+ *	block or merged into a number of (equally sized) bins over the range.
+ *
+ * 	@param session_path         The path to the session directory
+ * 	@param channel_names        Array of (num_channels) channel names (without the .timd extension)
+ * 	@param num_channels         The number of channels
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ *	@param range_start          Start of the time range (as an epoch/unix timestamp; -1 for the first block of the channels)
+ *	@param range_end            End of the time range (as an epoch/unix timestamp; -1 for the end of the last block of the channels)
+ *	@param num_bins             The number of bins to merge the blocks into (0 = an envelope per block)
+ *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
+ * 	@return                     Pointer to a matlab struct array (mxArray) with the envelope of each channel, or NULL on failure
+ */
+mxArray *read_session_channels_envelope(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, si8 range_start, si8 range_end, si4 num_bins, bool apply_conv_factor) {
+	si4		i;
+	bool	success;
+	
+	// open the channels and build their block lookup tables
+	CHANNEL **channels = (CHANNEL **) calloc((size_t) num_channels, sizeof(CHANNEL *));
+	BLOCK_LOOKUP *lookups = (BLOCK_LOOKUP *) calloc((size_t) num_channels, sizeof(BLOCK_LOOKUP));
+	PASSWORD_DATA *password_data = NULL;
+	if (channels == NULL || lookups == NULL) {
+		free (channels);
+		free (lookups);
+		mexPrintf("Error: could not allocated enough memory for the channels, exiting....\n");
+		return NULL;
+	}
+	success = open_session_channels_indices(session_path, channel_names, num_channels, password, channels, lookups, &password_data);
+	
+	// determine the range (if not given, the range spans the blocks of all channels)
+	if (success && (range_start < 0 || range_end < 0)) {
+		si8 first_time = LLONG_MAX;
+		si8 last_time = LLONG_MIN;
+		for (i = 0; i < num_channels; i++) {
+			if (lookups[i].num_blocks == 0)		continue;
+			if (lookups[i].blocks[0].start_time < first_time)
+				first_time = lookups[i].blocks[0].start_time;
+			
+			ui8 last_block = lookups[i].num_blocks - 1;
+			TIME_SERIES_INDEX *tsi = &channels[i]->segments[lookups[i].blocks[last_block].segment].time_series_indices_fps->time_series_indices[lookups[i].blocks[last_block].block];
+			si8 end_time = lookup_block_end_time(&lookups[i], last_block, (ui4) tsi->number_of_samples);
+			if (end_time > last_time)
+				last_time = end_time;
+		}
+		if (range_start < 0)	range_start = first_time;
+		if (range_end < 0)		range_end = last_time;
+	}
+	if (success && range_end <= range_start) {
+		mexPrintf("Error: the end of the range should be after the start of the range (or the channels have no blocks), exiting...\n");
+		success = false;
+	}
+	
+	// create the envelope of each channel
+	mxArray *mat_envelope = NULL;
+	if (success) {
+		mat_envelope = mxCreateStructMatrix(1, num_channels, ENVELOPE_NUMFIELDS, ENVELOPE_FIELDNAMES);
+		for (i = 0; i < num_channels; i++) {
+			
+			// the conversion factor
+			sf8 fac = 1.0;
+			if (apply_conv_factor && channels[i]->metadata.time_series_section_2->units_conversion_factor != 0.0)
+				fac = channels[i]->metadata.time_series_section_2->units_conversion_factor;
+			
+			// 
+			mxSetField(mat_envelope, i, "name", mxCreateString(channel_names[i]));
+			if (num_bins > 0)
+				success = set_binned_envelope(mat_envelope, i, channels[i], &lookups[i], range_start, range_end, num_bins, fac);
+			else
+				success = set_block_envelope(mat_envelope, i, channels[i], &lookups[i], range_start, range_end, fac);
+			if (!success)	break;
+			
+		}
+		
+		if (!success) {
+			mexPrintf("Error: could not allocated enough memory for the envelopes, exiting....\n");
+			mxDestroyArray(mat_envelope);
+			mat_envelope = NULL;
+		}
+	}
+	
+	// free the channel objects and lookup tables
+	free_session_channels_indices(channels, lookups, num_channels, password_data);
+	
+	// return the envelopes
+	return mat_envelope;
+	
+}
+
+/**
+ * 	Determine the end time of a block in a lookup table (the start time of the block plus its duration)
+ *
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param block                The index of the block in the lookup table
+ * 	@param number_of_samples    The number of samples in the block
+ * 	@return                     The end time (exclusive) of the block
+ */
+si8 lookup_block_end_time(BLOCK_LOOKUP *lookup, ui8 block, ui4 number_of_samples) {
+	return lookup->blocks[block].start_time + (si8) ((((sf8) number_of_samples / lookup->sampling_frequency) * 1000000.0) + 0.5);
+}
+
+/**
+ * 	Set the envelope of a channel with the minimum and maximum of each block that overlaps with a time range
+ *
+ * 	@param mat_envelope         The envelope struct array
+ * 	@param index                The index of the channel in the struct array
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ *	@param range_start          Start of the time range
+ *	@param range_end            End of the time range (exclusive)
+ *	@param fac                  The factor to multiply the minimum and maximum values with
+ * 	@return                     True if successful, false on failure
+ */
+bool set_block_envelope(mxArray *mat_envelope, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup, si8 range_start, si8 range_end, sf8 fac) {
+	ui8		i, k;
+	
+	// count the blocks that overlap with the range (blocks without samples are skipped)
+	ui8 num_blocks = 0;
+	for (i = 0; i < lookup->num_blocks; i++) {
+		TIME_SERIES_INDEX *tsi = &channel->segments[lookup->blocks[i].segment].time_series_indices_fps->time_series_indices[lookup->blocks[i].block];
+		if (tsi->number_of_samples <= 0)		continue;
+		if (lookup->blocks[i].start_time >= range_end)		continue;
+		if (lookup_block_end_time(lookup, i, (ui4) tsi->number_of_samples) <= range_start)		continue;
+		num_blocks++;
+	}
+	
+	// create the output arrays
+	mxArray *mat_time = mxCreateNumericMatrix(num_blocks, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_samples = mxCreateDoubleMatrix(num_blocks, 1, mxREAL);
+	mxArray *mat_min = mxCreateDoubleMatrix(num_blocks, 1, mxREAL);
+	mxArray *mat_max = mxCreateDoubleMatrix(num_blocks, 1, mxREAL);
+	if (mat_time == NULL || mat_samples == NULL || mat_min == NULL || mat_max == NULL)
+		return false;
+	si8 *out_time = (si8 *) mxGetData(mat_time);
+	sf8 *out_samples = mxGetPr(mat_samples);
+	sf8 *out_min = mxGetPr(mat_min);
+	sf8 *out_max = mxGetPr(mat_max);
+	
+	// fill the envelope (a negative factor swaps the minimum and maximum)
+	for (i = 0, k = 0; i < lookup->num_blocks && k < num_blocks; i++) {
+		TIME_SERIES_INDEX *tsi = &channel->segments[lookup->blocks[i].segment].time_series_indices_fps->time_series_indices[lookup->blocks[i].block];
+		if (tsi->number_of_samples <= 0)		continue;
+		if (lookup->blocks[i].start_time >= range_end)		continue;
+		if (lookup_block_end_time(lookup, i, (ui4) tsi->number_of_samples) <= range_start)		continue;
+		
+		out_time[k] = lookup->blocks[i].start_time;
+		out_samples[k] = (sf8) tsi->number_of_samples;
+		out_min[k] = (fac < 0 ? tsi->maximum_sample_value : tsi->minimum_sample_value) * fac;
+		out_max[k] = (fac < 0 ? tsi->minimum_sample_value : tsi->maximum_sample_value) * fac;
+		k++;
+	}
+	
+	mxSetField(mat_envelope, index, "time", mat_time);
+	mxSetField(mat_envelope, index, "numSamples", mat_samples);
+	mxSetField(mat_envelope, index, "min", mat_min);
+	mxSetField(mat_envelope, index, "max", mat_max);
+	return true;
+	
+}
+
+/**
+ * 	Set the envelope of a channel by merging the minimum and maximum of the blocks into a number of (equally sized) 
+ *	bins over a time range. A block that spans multiple bins contributes to each of these bins, its samples are
+ *	divided over the bins by the time it overlaps with each. Bins without blocks hold NaN values.
+ *
+ * 	@param mat_envelope         The envelope struct array
+ * 	@param index                The index of the channel in the struct array
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ *	@param range_start          Start of the time range
+ *	@param range_end            End of the time range (exclusive)
+ *	@param num_bins             The number of bins
+ *	@param fac                  The factor to multiply the minimum and maximum values with
+ * 	@return                     True if successful, false on failure
+ */
+bool set_binned_envelope(mxArray *mat_envelope, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup, si8 range_start, si8 range_end, si4 num_bins, sf8 fac) {
+	ui8		i;
+	si8		b;
+	
+	// create the output arrays
+	mxArray *mat_time = mxCreateNumericMatrix(num_bins, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_samples = mxCreateDoubleMatrix(num_bins, 1, mxREAL);
+	mxArray *mat_min = mxCreateDoubleMatrix(num_bins, 1, mxREAL);
+	mxArray *mat_max = mxCreateDoubleMatrix(num_bins, 1, mxREAL);
+	if (mat_time == NULL || mat_samples == NULL || mat_min == NULL || mat_max == NULL)
+		return false;
+	si8 *out_time = (si8 *) mxGetData(mat_time);
+	sf8 *out_samples = mxGetPr(mat_samples);
+	sf8 *out_min = mxGetPr(mat_min);
+	sf8 *out_max = mxGetPr(mat_max);
+	
+	// set the start time of the bins, and start the bins empty
+	sf8 bin_width = (sf8) (range_end - range_start) / num_bins;
+	for (b = 0; b < num_bins; b++) {
+		out_time[b] = range_start + (si8) ((b * bin_width) + 0.5);
+		out_samples[b] = 0;
+		out_min[b] = mxGetInf();
+		out_max[b] = -mxGetInf();
+	}
+	
+	// merge the blocks into the bins (a negative factor swaps the minimum and maximum)
+	for (i = 0; i < lookup->num_blocks; i++) {
+		TIME_SERIES_INDEX *tsi = &channel->segments[lookup->blocks[i].segment].time_series_indices_fps->time_series_indices[lookup->blocks[i].block];
+		if (tsi->number_of_samples <= 0)		continue;
+		
+		// check whether the block overlaps with the range
+		si8 block_start = lookup->blocks[i].start_time;
+		si8 block_end = lookup_block_end_time(lookup, i, (ui4) tsi->number_of_samples);
+		if (block_start >= range_end || block_end <= range_start)		continue;
+		if (block_end <= block_start)	block_end = block_start + 1;
+		
+		// determine the bins that the block overlaps with
+		si8 first_bin = (si8) ((block_start - range_start) / bin_width);
+		si8 last_bin = (si8) ((block_end - 1 - range_start) / bin_width);
+		if (first_bin < 0)					first_bin = 0;
+		if (last_bin >= num_bins)			last_bin = num_bins - 1;
+		
+		// 
+		sf8 block_min = (fac < 0 ? tsi->maximum_sample_value : tsi->minimum_sample_value) * fac;
+		sf8 block_max = (fac < 0 ? tsi->minimum_sample_value : tsi->maximum_sample_value) * fac;
+		sf8 samples_per_us = (sf8) tsi->number_of_samples / (block_end - block_start);
+		for (b = first_bin; b <= last_bin; b++) {
+			if (block_min < out_min[b])		out_min[b] = block_min;
+			if (block_max > out_max[b])		out_max[b] = block_max;
+			
+			// the samples of the block in the bin
+			sf8 overlap_start = range_start + (b * bin_width);
+			sf8 overlap_end = range_start + ((b + 1) * bin_width);
+			if (overlap_start < block_start)	overlap_start = block_start;
+			if (overlap_end > block_end)		overlap_end = block_end;
+			if (overlap_end > overlap_start)
+				out_samples[b] += (overlap_end - overlap_start) * samples_per_us;
+		}
+	}
+	
+	// round the number of samples, and mark the empty bins
+	for (b = 0; b < num_bins; b++) {
+		out_samples[b] = floor(out_samples[b] + 0.5);
+		if (out_min[b] > out_max[b]) {
+			out_min[b] = mxGetNaN();
+			out_max[b] = mxGetNaN();
+		}
+	}
+	
+	mxSetField(mat_envelope, index, "time", mat_time);
+	mxSetField(mat_envelope, index, "numSamples", mat_samples);
+	mxSetField(mat_envelope, index, "min", mat_min);
+	mxSetField(mat_envelope, index, "max", mat_max);
+	return true;
+	
+}
+
+/**
+ * 	Determine the contiguous ranges of multiple time-series channels in a session from their indices
+ *
+ *	A new range starts at the first block of each segment and at each block that is flagged as discontinuous; a range
+ *	ends where the next range starts (or at the end of the last block of the segment).
+ *
+ * 	@param session_path         The path to the session directory
+ * 	@param channel_names        Array of (num_channels) channel names (without the .timd extension)
+ * 	@param num_channels         The number of channels
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ * 	@return                     Pointer to a matlab struct array (mxArray) with the ranges of each channel, or NULL on failure
+ */
+mxArray *read_session_channels_ranges(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password) {
+	si4		i;
+	bool	success;
+	
+	// open the channels and build their block lookup tables
+	CHANNEL **channels = (CHANNEL **) calloc((size_t) num_channels, sizeof(CHANNEL *));
+	BLOCK_LOOKUP *lookups = (BLOCK_LOOKUP *) calloc((size_t) num_channels, sizeof(BLOCK_LOOKUP));
+	PASSWORD_DATA *password_data = NULL;
+	if (channels == NULL || lookups == NULL) {
+		free (channels);
+		free (lookups);
+		mexPrintf("Error: could not allocated enough memory for the channels, exiting....\n");
+		return NULL;
+	}
+	success = open_session_channels_indices(session_path, channel_names, num_channels, password, channels, lookups, &password_data);
+	
+	// create the ranges of each channel
+	mxArray *mat_ranges = NULL;
+	if (success) {
+		mat_ranges = mxCreateStructMatrix(1, num_channels, RANGES_NUMFIELDS, RANGES_FIELDNAMES);
+		for (i = 0; success && i < num_channels; i++) {
+			mxSetField(mat_ranges, i, "name", mxCreateString(channel_names[i]));
+			success = set_contiguous_ranges(mat_ranges, i, channels[i], &lookups[i]);
+		}
+		
+		if (!success) {
+			mexPrintf("Error: could not allocated enough memory for the ranges, exiting....\n");
+			mxDestroyArray(mat_ranges);
+			mat_ranges = NULL;
+		}
+	}
+	
+	// free the channel objects and lookup tables
+	free_session_channels_indices(channels, lookups, num_channels, password_data);
+	
+	// return the ranges
+	return mat_ranges;
+	
+}
+
+/**
+ * 	Set the contiguous ranges of a channel (the start and end sample, start and end time and segment of each range)
+ *
+ * 	@param mat_ranges           The ranges struct array
+ * 	@param index                The index of the channel in the struct array
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@return                     True if successful, false on failure
+ */
+bool set_contiguous_ranges(mxArray *mat_ranges, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup) {
+	ui8		i, k;
+	
+	// count the ranges (blocks that start a range)
+	ui8 num_ranges = 0;
+	for (i = 0; i < lookup->num_blocks; i++)
+		if (block_starts_range(channel, lookup, i))
+			num_ranges++;
+	
+	// create the output arrays
+	mxArray *mat_start_sample = mxCreateNumericMatrix(num_ranges, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_end_sample = mxCreateNumericMatrix(num_ranges, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_start_time = mxCreateNumericMatrix(num_ranges, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_end_time = mxCreateNumericMatrix(num_ranges, 1, mxINT64_CLASS, mxREAL);
+	mxArray *mat_segment = mxCreateDoubleMatrix(num_ranges, 1, mxREAL);
+	if (mat_start_sample == NULL || mat_end_sample == NULL || mat_start_time == NULL || mat_end_time == NULL || mat_segment == NULL)
+		return false;
+	si8 *out_start_sample = (si8 *) mxGetData(mat_start_sample);
+	si8 *out_end_sample = (si8 *) mxGetData(mat_end_sample);
+	si8 *out_start_time = (si8 *) mxGetData(mat_start_time);
+	si8 *out_end_time = (si8 *) mxGetData(mat_end_time);
+	sf8 *out_segment = mxGetPr(mat_segment);
+	
+	// fill the ranges (each range is extended by every block up to the block that starts the next range)
+	for (i = 0, k = 0; i < lookup->num_blocks; i++) {
+		TIME_SERIES_INDEX *tsi = &channel->segments[lookup->blocks[i].segment].time_series_indices_fps->time_series_indices[lookup->blocks[i].block];
+		if (block_starts_range(channel, lookup, i)) {
+			k++;
+			out_start_sample[k - 1] = lookup->blocks[i].start_sample;
+			out_start_time[k - 1] = lookup->blocks[i].start_time;
+			out_segment[k - 1] = lookup->blocks[i].segment;
+		}
+		out_end_sample[k - 1] = lookup->blocks[i].start_sample + tsi->number_of_samples;
+		out_end_time[k - 1] = lookup_block_end_time(lookup, i, (ui4) tsi->number_of_samples);
+	}
+	
+	mxSetField(mat_ranges, index, "startSample", mat_start_sample);
+	mxSetField(mat_ranges, index, "endSample", mat_end_sample);
+	mxSetField(mat_ranges, index, "startTime", mat_start_time);
+	mxSetField(mat_ranges, index, "endTime", mat_end_time);
+	mxSetField(mat_ranges, index, "segment", mat_segment);
+	return true;
+	
+}
+
+/**
+ * 	Determine whether a block starts a contiguous range, which is the first block of a segment or a block that is flagged as discontinuous
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param block                The index of the block in the lookup table
+ * 	@return                     True if the block starts a range
+ */
+bool block_starts_range(CHANNEL *channel, BLOCK_LOOKUP *lookup, ui8 block) {
+	if (lookup->blocks[block].block == 0)
+		return true;
+	TIME_SERIES_INDEX *tsi = &channel->segments[lookup->blocks[block].segment].time_series_indices_fps->time_series_indices[lookup->blocks[block].block];
+	return (tsi->RED_block_flags & RED_DISCONTINUITY_MASK) != 0;
+}
+
+/**
+ * 	Open multiple time-series channels in a session (of which only the metadata and indices are used) and build
+ *	their block lookup tables. The password data is processed once and shared between the channels (as read_MEF_session does)
+ *
+ * 	@param session_path         The path to the session directory
+ * 	@param channel_names        Array of (num_channels) channel names (without the .timd extension)
+ * 	@param num_channels         The number of channels
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ * 	@param channels             Array of (num_channels) pointers that will hold the channel objects (should start as NULL pointers)
+ * 	@param lookups              Array of (num_channels) lookup tables that will be built (should start zeroed)
+ * 	@param password_data        Pointer to a variable that will hold the shared password data
+ * 	@return                     True if successful, false on failure (release the channels using free_session_channels_indices either way)
+ */
+bool open_session_channels_indices(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, CHANNEL **channels, BLOCK_LOOKUP *lookups, PASSWORD_DATA **password_data) {
+	si4		i;
+	si1		channel_path[MEF_FULL_FILE_NAME_BYTES];
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	initialize_crc_tables();
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	
+	*password_data = NULL;
+	for (i = 0; i < num_channels; i++) {
+		
+		// read the channel metadata
+		MEF_snprintf(channel_path, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", session_path, channel_names[i], TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING);
+		channels[i] = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, *password_data, MEF_FALSE, MEF_FALSE);
+		
+		// check the number of segments
+		// (without segments, password data that was processed for this channel is held by the channel record indices,
+		// it is kept as the shared password data so that free_session_channels_indices frees it)
+		if (channels[i]->number_of_segments == 0) {
+			mexPrintf("Error: no segments in channel '%s', most likely due to an invalid channel folder, exiting...\n", channel_names[i]);
+			if (*password_data == NULL && channels[i]->record_indices_fps != NULL)
+				*password_data = channels[i]->record_indices_fps->password_data;
+			return false;
+		}
+		if (*password_data == NULL)
+			*password_data = channels[i]->segments[0].metadata_fps->password_data;
+		
+		// check if the data is encrypted and/or the correctness of password
+		if (channels[i]->metadata.section_1->section_2_encryption > 0) {
+			if (password == NULL)
+				mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+			else
+				mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+			return false;
+		}
+		
+		// build the lookup table of the blocks (with the settings of the channel's session)
+		READ_CONTEXT context;
+		capture_read_context(&context);
+		if (!build_block_lookup(channels[i], &context, &lookups[i])) {
+			mexPrintf("Error: could not build the block lookup table of channel '%s', exiting...\n", channel_names[i]);
+			return false;
+		}
+		
+	}
+	
+	return true;
+	
+}
+
+/**
+ * 	Release the channel objects and lookup tables that were opened by open_session_channels_indices (including the arrays themselves)
+ *
+ * 	@param channels             Array of (num_channels) pointers to the channel objects
+ * 	@param lookups              Array of (num_channels) lookup tables
+ * 	@param num_channels         The number of channels
+ * 	@param password_data        The shared password data (freed once, at the end)
+ */
+void free_session_channels_indices(CHANNEL **channels, BLOCK_LOOKUP *lookups, si4 num_channels, PASSWORD_DATA *password_data) {
+	si4		i;
+	
+	for (i = 0; i < num_channels; i++) {
+		free_block_lookup(&lookups[i]);
+		if (channels[i] != NULL)
+			free_channel(channels[i], MEF_TRUE);
+	}
+	free (password_data);
+	free (channels);
+	free (lookups);
+	
+}
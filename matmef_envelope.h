@@ -0,0 +1,37 @@
+#ifndef MATMEF_ENVELOPE_
+#define MATMEF_ENVELOPE_
+/**
+ * 	@file - headers
+ * 	Min/max envelopes and contiguous ranges of time-series channels, built from the time-series indices only (without decoding any data)
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "meflib/meflib/meflib.h"
+#include "matmef_read.h"
+#include <stdbool.h>
+
+
+//
+// Functions
+//
+
+mxArray *read_session_channels_envelope(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, si8 range_start, si8 range_end, si4 num_bins, bool apply_conv_factor);
+si8 lookup_block_end_time(BLOCK_LOOKUP *lookup, ui8 block, ui4 number_of_samples);
+bool set_block_envelope(mxArray *mat_envelope, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup, si8 range_start, si8 range_end, sf8 fac);
+bool set_binned_envelope(mxArray *mat_envelope, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup, si8 range_start, si8 range_end, si4 num_bins, sf8 fac);
+mxArray *read_session_channels_ranges(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password);
+bool set_contiguous_ranges(mxArray *mat_ranges, si4 index, CHANNEL *channel, BLOCK_LOOKUP *lookup);
+bool block_starts_range(CHANNEL *channel, BLOCK_LOOKUP *lookup, ui8 block);
+bool open_session_channels_indices(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, CHANNEL **channels, BLOCK_LOOKUP *lookups, PASSWORD_DATA **password_data);
+void free_session_channels_indices(CHANNEL **channels, BLOCK_LOOKUP *lookups, si4 num_channels, PASSWORD_DATA *password_data);
+
+
+#endif   // MATMEF_ENVELOPE_
@@ -0,0 +1,215 @@
+/**
+ * 	@file
+ * 	Table of opened (parsed) MEF3 channels, which can be kept alive across mex calls and are referred to by a handle
+ *
+ *	Opening a channel parses the metadata and indices of all segments once (read_MEF_channel), the data files are
+ *	kept open as well. Reads through a handle therefore only need to seek and decode the blocks that are touched.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_handles.h"
+#include "matmef_crc.h"
+#include "mex.h"
+
+// the meflib globals (defined in meflib.c, which is included by matmef_read.c)
+extern MEF_GLOBALS	*MEF_globals;
+
+
+// the table of opened channels
+static CHANNEL_HANDLE	*channel_handles = NULL;
+static ui4				num_channel_handles = 0;
+static ui4				channel_handles_size = 0;
+static ui8				next_channel_handle_id = 1;
+
+
+/**
+ * 	Open a time-series channel and add it to the table of opened channels
+ *
+ * 	@param channel_path         The path to the channel directory
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ * 	@return                     The handle to the opened channel, or 0 on failure
+ */
+ui8 open_channel_handle(si1 *channel_path, si1 *password) {
+	ui4		i;
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// initialize MEF library (once, the globals and tables are kept while channels are open)
+	if (MEF_globals == NULL)
+		(void) initialize_meflib();
+	initialize_crc_tables();
+	
+	// make room in the table
+	if (num_channel_handles == channel_handles_size) {
+		ui4 new_size = (channel_handles_size == 0) ? 16 : channel_handles_size * 2;
+		CHANNEL_HANDLE *new_handles = (CHANNEL_HANDLE *) realloc(channel_handles, new_size * sizeof(CHANNEL_HANDLE));
+		if (new_handles == NULL) {
+			mexPrintf("Error: could not allocated enough memory for the channel handle, exiting....\n");
+			return 0;
+		}
+		channel_handles = new_handles;
+		channel_handles_size = new_size;
+	}
+	
+	// read the channel metadata
+	// note: the recording time offset is reset so that the offset of this channel's session is picked up
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	MEF_globals->recording_time_offset = MEF_GLOBALS_RECORDING_TIME_OFFSET_DEFAULT;
+	CHANNEL *channel = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, NULL, MEF_FALSE, MEF_FALSE);
+	
+	// check the number of segments
+	if (channel->number_of_segments == 0) {
+		mexPrintf("Error: no segments in channel, most likely due to an invalid channel folder, exiting...\n");
+
+		// without segments, the password data (if any) was processed with the channel record indices
+		if (channel->record_indices_fps != NULL)
+			channel->record_indices_fps->directives.free_password_data = MEF_TRUE;
+		free_channel(channel, MEF_TRUE);
+		return 0;
+	}
+	
+	// the channel owns the password data
+	channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
+	
+	// check if the data is encrypted and/or the correctness of password
+	if (channel->metadata.section_1->section_2_encryption > 0) {
+		if (password == NULL)
+			mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+		else
+			mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+		free_channel(channel, MEF_TRUE);
+		return 0;
+	}
+	
+	// check if the channel is indeed of a time-series channel
+	if (channel->channel_type != TIME_SERIES_CHANNEL_TYPE) {
+		mexPrintf("Error: not a time series channel, exiting...\n");
+		free_channel(channel, MEF_TRUE);
+		return 0;
+	}
+	
+	// add to the table
+	CHANNEL_HANDLE *handle = &channel_handles[num_channel_handles];
+	handle->channel = channel;
+	capture_read_context(&handle->context);
+	
+	// build the block lookup table (with the offset of the channel's session)
+	if (!build_block_lookup(channel, &handle->context, &handle->lookup)) {
+		mexPrintf("Error: could not build the block lookup table, exiting...\n");
+		free_channel(channel, MEF_TRUE);
+		return 0;
+	}
+	
+	// the readahead of the channel
+	handle->readahead = (READAHEAD *) malloc(sizeof(READAHEAD));
+	if (handle->readahead == NULL) {
+		mexPrintf("Error: could not allocated enough memory for the channel handle, exiting....\n");
+		free_channel(channel, MEF_TRUE);
+		free_block_lookup(&handle->lookup);
+		return 0;
+	}
+	init_readahead(handle->readahead);
+	
+	// keep the data files open between reads
+	for (i = 0; i < (ui4) channel->number_of_segments; i++)
+		channel->segments[i].time_series_data_fps->directives.close_file = MEF_FALSE;
+	
+	handle->id = next_channel_handle_id++;
+	num_channel_handles++;
+	
+	return handle->id;
+	
+}
+
+/**
+ * 	Retrieve the channel of an opened channel handle
+ *
+ * 	@param id                   The handle to the opened channel
+ * 	@param lookup               Pointer that is set to the block lookup table of the channel
+ * 	@param context              Pointer that is set to the meflib settings of the channel's session (to read with)
+ * 	@param readahead            Pointer that is set to the readahead of the channel
+ * 	@return                     Pointer to the channel object, or NULL if the handle is not valid
+ */
+CHANNEL *use_channel_handle(ui8 id, BLOCK_LOOKUP **lookup, READ_CONTEXT **context, READAHEAD **readahead) {
+	ui4		i;
+	
+	for (i = 0; i < num_channel_handles; i++) {
+		if (channel_handles[i].id == id) {
+			*lookup = &channel_handles[i].lookup;
+			*context = &channel_handles[i].context;
+			*readahead = channel_handles[i].readahead;
+			return channel_handles[i].channel;
+		}
+	}
+	
+	return NULL;
+	
+}
+
+/**
+ * 	Close an opened channel handle and free the channel object
+ *
+ * 	@param id                   The handle to the opened channel
+ * 	@return                     True if the handle was closed, false if the handle is not valid
+ */
+bool close_channel_handle(ui8 id) {
+	ui4		i, j;
+	
+	for (i = 0; i < num_channel_handles; i++) {
+		if (channel_handles[i].id == id) {
+			CHANNEL *channel = channel_handles[i].channel;
+			
+			// stop reading ahead
+			free_readahead(channel_handles[i].readahead);
+			free (channel_handles[i].readahead);
+			
+			// close the data files when freeing
+			for (j = 0; j < (ui4) channel->number_of_segments; j++)
+				channel->segments[j].time_series_data_fps->directives.close_file = MEF_TRUE;
+			free_channel(channel, MEF_TRUE);
+			free_block_lookup(&channel_handles[i].lookup);
+			
+			// remove from the table
+			for (j = i + 1; j < num_channel_handles; j++)
+				channel_handles[j - 1] = channel_handles[j];
+			num_channel_handles--;
+			return true;
+			
+		}
+	}
+	
+	return false;
+	
+}
+
+/**
+ * 	Close all opened channel handles and release the table
+ *  (registered with mexAtExit, so the channels are freed when the mex module is cleared)
+ */
+void close_all_channel_handles() {
+	
+	while (num_channel_handles > 0)
+		close_channel_handle(channel_handles[num_channel_handles - 1].id);
+	
+	free (channel_handles);
+	channel_handles = NULL;
+	channel_handles_size = 0;
+	
+}
+
+/**
+ * 	Retrieve the number of opened channel handles
+ *
+ * 	@return                     The number of opened channel handles
+ */
+ui4 get_number_of_channel_handles() {
+	return num_channel_handles;
+}
@@ -0,0 +1,46 @@
+#ifndef MATMEF_HANDLES_
+#define MATMEF_HANDLES_
+/**
+ * 	@file - headers
+ * 	Table of opened (parsed) MEF3 channels, which can be kept alive across mex calls and are referred to by a handle
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include "matmef_read.h"
+#include <stdbool.h>
+
+
+// 
+// Structures
+//
+
+// An opened channel
+typedef struct {
+	ui8			id;							// the handle (unique within the lifetime of the mex module, 0 = invalid)
+	CHANNEL		*channel;
+	READ_CONTEXT	context;				// the meflib settings of the channel's session (e.g. the recording time offset), used for each read
+	BLOCK_LOOKUP	lookup;					// the block lookup table of the channel (built once, used for each read)
+	READAHEAD		*readahead;				// the readahead of the channel (allocated separately, a background read refers to it)
+} CHANNEL_HANDLE;
+
+
+//
+// Functions
+//
+
+ui8 open_channel_handle(si1 *channel_path, si1 *password);
+CHANNEL *use_channel_handle(ui8 id, BLOCK_LOOKUP **lookup, READ_CONTEXT **context, READAHEAD **readahead);
+bool close_channel_handle(ui8 id);
+void close_all_channel_handles();
+ui4 get_number_of_channel_handles();
+
+
+#endif   // MATMEF_HANDLES_
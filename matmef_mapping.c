@@ -495,7 +495,7 @@ mxArray *create_init_matlab_md3() {
  *	struct will be mapped on the given index
  *
  * 	@param segment				Pointer to the MEF segment c-struct
- * 	@param map_indices_flag		Whether to map the time-series and video indices
+ * 	@param map_indices_flag		Whether and how to map the time-series and video indices (MAP_INDICES_NONE, MAP_INDICES_STRUCTS or MAP_INDICES_COMPACT)
  * 	@param mat_segment			Pointer to the existing matlab-struct
  * 	@param mat_index			The index in the existing matlab-struct at which to map the data	
  */
@@ -568,8 +568,11 @@ void map_mef3_segment_tostruct(SEGMENT *segment, si1 map_indices_flag, mxArray *
 					mxSetField(	mat_segment, 
 								mat_index, 
 								"time_series_indices", 
-								map_mef3_ti(	segment->time_series_indices_fps->time_series_indices,
-												segment->time_series_indices_fps->universal_header->number_of_entries));
+								(map_indices_flag == MAP_INDICES_COMPACT) ? 
+									map_mef3_ti_compact(	segment->time_series_indices_fps->time_series_indices,
+															segment->time_series_indices_fps->universal_header->number_of_entries) : 
+									map_mef3_ti(	segment->time_series_indices_fps->time_series_indices,
+													segment->time_series_indices_fps->universal_header->number_of_entries));
 				}
 					
 				break;
@@ -582,8 +585,11 @@ void map_mef3_segment_tostruct(SEGMENT *segment, si1 map_indices_flag, mxArray *
 					mxSetField(	mat_segment, 
 								mat_index, 
 								"video_indices", 
-								map_mef3_vi(	segment->video_indices_fps->video_indices,
-												segment->video_indices_fps->universal_header->number_of_entries));
+								(map_indices_flag == MAP_INDICES_COMPACT) ? 
+									map_mef3_vi_compact(	segment->video_indices_fps->video_indices,
+															segment->video_indices_fps->universal_header->number_of_entries) : 
+									map_mef3_vi(	segment->video_indices_fps->video_indices,
+													segment->video_indices_fps->universal_header->number_of_entries));
 				}
 				
 				break;
@@ -599,7 +605,7 @@ void map_mef3_segment_tostruct(SEGMENT *segment, si1 map_indices_flag, mxArray *
  * 	Map a MEF segment c-struct to a newly created matlab-struct
  *
  * 	@param segment				Pointer to the MEF segment c-struct
- * 	@param map_indices_flag		Whether to map the time-series and video indices
+ * 	@param map_indices_flag		Whether and how to map the time-series and video indices (MAP_INDICES_NONE, MAP_INDICES_STRUCTS or MAP_INDICES_COMPACT)
  * 	@return						Pointer to the new matlab-struct
  */
 mxArray *map_mef3_segment(SEGMENT *segment, si1 map_indices_flag) {
@@ -619,7 +625,7 @@ mxArray *map_mef3_segment(SEGMENT *segment, si1 map_indices_flag) {
  *	note: this funtion also loops through segments
  *
  * 	@param channel				A pointer to the MEF channel c-struct
- * 	@param map_indices_flag		Whether to map the time-series and video indices
+ * 	@param map_indices_flag		Whether and how to map the time-series and video indices (MAP_INDICES_NONE, MAP_INDICES_STRUCTS or MAP_INDICES_COMPACT)
  * 	@param mat_channel			A pointer to the existing matlab-struct
  * 	@param mat_index			The index in the existing matlab-struct at which to map the data	
  */
@@ -699,7 +705,7 @@ void map_mef3_channel_tostruct(CHANNEL *channel, si1 map_indices_flag, mxArray *
  *	note: this funtion also loops through segments
  *
  * 	@param channel				A pointer to the MEF channel c-struct
- * 	@param map_indices_flag		Whether to map the time-series and video indices
+ * 	@param map_indices_flag		Whether and how to map the time-series and video indices (MAP_INDICES_NONE, MAP_INDICES_STRUCTS or MAP_INDICES_COMPACT)
  * 	@return						A pointer to the new matlab-struct
  */
 mxArray *map_mef3_channel(CHANNEL *channel, si1 map_indices_flag) {
@@ -712,7 +718,7 @@ mxArray *map_mef3_channel(CHANNEL *channel, si1 map_indices_flag) {
  * 	Map a MEF session c-struct to a newly created matlab-struct
  *
  * 	@param session				A pointer to the MEF session c-struct
- * 	@param map_indices_flag		Whether to map the time-series and video indices
+ * 	@param map_indices_flag		Whether and how to map the time-series and video indices (MAP_INDICES_NONE, MAP_INDICES_STRUCTS or MAP_INDICES_COMPACT)
  * 	@return						A pointer to the new matlab-struct
  */
 mxArray *map_mef3_session(SESSION *session, si1 map_indices_flag) {
@@ -993,6 +999,103 @@ mxArray *map_mef3_vi(VIDEO_INDEX *vi, si8 number_of_entries) {
 }
 
 
+/**
+ * 	Create a numeric column (matrix) for a field of a compact index matlab-struct
+ *
+ * 	@param mat_struct			Pointer to the (1x1) matlab-struct
+ * 	@param field				The name of the field
+ * 	@param rows					The number of rows (the number of index entries)
+ * 	@param cols					The number of columns (1 for a column vector)
+ * 	@param class_id				The matlab class of the column
+ * 	@return						A pointer to the (column-major) data of the column
+ */
+static void *create_index_column(mxArray *mat_struct, const char *field, mwSize rows, mwSize cols, mxClassID class_id) {
+	mxArray *mat_column = mxCreateNumericMatrix(rows, cols, class_id, mxREAL);
+	mxSetField(mat_struct, 0, field, mat_column);
+	return mxGetData(mat_column);
+}
+
+/**
+ * 	Map MEF time-series indices to a newly created compact (struct-of-arrays) matlab-struct
+ *
+ *	Instead of a struct array with an element (and a matlab array for each field) per index entry, a single struct is
+ *	created of which each field is a typed column vector (or a <entries> x <bytes> matrix for the discretionary region)
+ *	that holds the values of all entries
+ *
+ * 	@param ti					A pointer to the MEF time-series indices
+ * 	@param number_of_entries	The number of time-series indices
+ * 	@return						A pointer to the new matlab-struct
+ */
+mxArray *map_mef3_ti_compact(TIME_SERIES_INDEX *ti, si8 number_of_entries) {
+	si8		i;
+	si4		j;
+	mwSize	n = (mwSize) number_of_entries;
+
+	// create the a matlab 'time_series_index' struct with a column for each field
+    mxArray *mat_ti = mxCreateStructMatrix(1, 1, TIME_SERIES_INDEX_NUMFIELDS, TIME_SERIES_INDEX_FIELDNAMES);
+	si8 *file_offset 			= (si8 *) create_index_column(mat_ti, "file_offset", n, 1, mxINT64_CLASS);
+	si8 *start_time 			= (si8 *) create_index_column(mat_ti, "start_time", n, 1, mxINT64_CLASS);
+	si8 *start_sample 			= (si8 *) create_index_column(mat_ti, "start_sample", n, 1, mxINT64_CLASS);
+	ui4 *number_of_samples		= (ui4 *) create_index_column(mat_ti, "number_of_samples", n, 1, mxUINT32_CLASS);
+	ui4 *block_bytes 			= (ui4 *) create_index_column(mat_ti, "block_bytes", n, 1, mxUINT32_CLASS);
+	si4 *maximum_sample_value	= (si4 *) create_index_column(mat_ti, "maximum_sample_value", n, 1, mxINT32_CLASS);
+	si4 *minimum_sample_value	= (si4 *) create_index_column(mat_ti, "minimum_sample_value", n, 1, mxINT32_CLASS);
+	ui1 *RED_block_flags 		= (ui1 *) create_index_column(mat_ti, "RED_block_flags", n, 1, mxUINT8_CLASS);
+	ui1 *discretionary_region 	= (ui1 *) create_index_column(mat_ti, "RED_block_discretionary_region", n, RED_BLOCK_DISCRETIONARY_REGION_BYTES, mxUINT8_CLASS);
+	
+	// fill the columns, one field at a time
+	for (i = 0; i < number_of_entries; ++i)		file_offset[i] = ti[i].file_offset;
+	for (i = 0; i < number_of_entries; ++i)		start_time[i] = ti[i].start_time;
+	for (i = 0; i < number_of_entries; ++i)		start_sample[i] = ti[i].start_sample;
+	for (i = 0; i < number_of_entries; ++i)		number_of_samples[i] = ti[i].number_of_samples;
+	for (i = 0; i < number_of_entries; ++i)		block_bytes[i] = ti[i].block_bytes;
+	for (i = 0; i < number_of_entries; ++i)		maximum_sample_value[i] = ti[i].maximum_sample_value;
+	for (i = 0; i < number_of_entries; ++i)		minimum_sample_value[i] = ti[i].minimum_sample_value;
+	for (i = 0; i < number_of_entries; ++i)		RED_block_flags[i] = ti[i].RED_block_flags;
+	for (j = 0; j < RED_BLOCK_DISCRETIONARY_REGION_BYTES; ++j)
+		for (i = 0; i < number_of_entries; ++i)	discretionary_region[j * number_of_entries + i] = ti[i].RED_block_discretionary_region[j];
+	
+	// return the struct
+	return mat_ti;
+}
+
+/**
+ * 	Map MEF video indices to a newly created compact (struct-of-arrays) matlab-struct (see map_mef3_ti_compact)
+ *
+ * 	@param vi					A pointer to the MEF video indices
+ * 	@param number_of_entries	The number of video indices
+ * 	@return						A pointer to the new matlab-struct
+ */
+mxArray *map_mef3_vi_compact(VIDEO_INDEX *vi, si8 number_of_entries) {
+	si8		i;
+	si4		j;
+	mwSize	n = (mwSize) number_of_entries;
+
+	// create the a matlab 'video_index' struct with a column for each field
+    mxArray *mat_vi = mxCreateStructMatrix(1, 1, VIDEO_INDEX_NUMFIELDS, VIDEO_INDEX_FIELDNAMES);
+	si8 *start_time 			= (si8 *) create_index_column(mat_vi, "start_time", n, 1, mxINT64_CLASS);
+	si8 *end_time 				= (si8 *) create_index_column(mat_vi, "end_time", n, 1, mxINT64_CLASS);
+	ui4 *start_frame 			= (ui4 *) create_index_column(mat_vi, "start_frame", n, 1, mxUINT32_CLASS);
+	ui4 *end_frame 				= (ui4 *) create_index_column(mat_vi, "end_frame", n, 1, mxUINT32_CLASS);
+	si8 *file_offset 			= (si8 *) create_index_column(mat_vi, "file_offset", n, 1, mxINT64_CLASS);
+	si8 *clip_bytes 			= (si8 *) create_index_column(mat_vi, "clip_bytes", n, 1, mxINT64_CLASS);
+	ui1 *discretionary_region 	= (ui1 *) create_index_column(mat_vi, "discretionary_region", n, VIDEO_INDEX_DISCRETIONARY_REGION_BYTES, mxUINT8_CLASS);
+	
+	// fill the columns, one field at a time
+	for (i = 0; i < number_of_entries; ++i)		start_time[i] = vi[i].start_time;
+	for (i = 0; i < number_of_entries; ++i)		end_time[i] = vi[i].end_time;
+	for (i = 0; i < number_of_entries; ++i)		start_frame[i] = vi[i].start_frame;
+	for (i = 0; i < number_of_entries; ++i)		end_frame[i] = vi[i].end_frame;
+	for (i = 0; i < number_of_entries; ++i)		file_offset[i] = vi[i].file_offset;
+	for (i = 0; i < number_of_entries; ++i)		clip_bytes[i] = vi[i].clip_bytes;
+	for (j = 0; j < VIDEO_INDEX_DISCRETIONARY_REGION_BYTES; ++j)
+		for (i = 0; i < number_of_entries; ++i)	discretionary_region[j * number_of_entries + i] = vi[i].discretionary_region[j];
+	
+	// return the struct
+	return mat_vi;
+}
+
+
 /**
  * 	Map the MEF records to a matlab-struct
  *
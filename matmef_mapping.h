@@ -17,6 +17,11 @@
 #include "mex.h"
 #include "meflib/meflib/meflib.h"
 
+// How the time-series and video indices are mapped
+#define MAP_INDICES_NONE		0		// not mapped
+#define MAP_INDICES_STRUCTS		1		// a struct array, with an element per index entry
+#define MAP_INDICES_COMPACT		2		// a single struct, with a (typed) column vector of all entries per field
+
 mxArray *create_init_matlab_uh();
 mxArray *create_init_matlab_tmd2();
 mxArray *create_init_matlab_vmd2();
@@ -35,6 +40,8 @@ mxArray *map_mef3_md3(METADATA_SECTION_3 *md3);
 
 mxArray *map_mef3_ti(TIME_SERIES_INDEX *ti, si8 number_of_entries);
 mxArray *map_mef3_vi(VIDEO_INDEX *vi, si8 number_of_entries);
+mxArray *map_mef3_ti_compact(TIME_SERIES_INDEX *ti, si8 number_of_entries);
+mxArray *map_mef3_vi_compact(VIDEO_INDEX *vi, si8 number_of_entries);
 mxArray *map_mef3_records(FILE_PROCESSING_STRUCT *ri_fps, FILE_PROCESSING_STRUCT *rd_fps);
 
 mxArray *map_mef3_note(RECORD_HEADER *rh);
@@ -0,0 +1,321 @@
+/**
+ * 	@file
+ * 	Build multi-resolution pyramid sidecars (decimated mean, minimum and maximum levels) of time-series segments
+ *
+ *	A pyramid holds levels in which each point is decimated from 4, 16, 64, ... samples of the segment. For each
+ *	point the mean, minimum and maximum of its samples are stored, RED encoded in blocks (and encrypted with the 
+ *	same level as the data of the segment). The pyramid is written to a sidecar file next to the data file of the
+ *	segment, from which read_channel_pyramid_from_object serves zoomed-out reads without decoding the full-rate data.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_pyramid.h"
+#include "matmef_crc.h"
+
+// the meflib globals (defined in meflib.c, which is included by matmef_read.c)
+extern MEF_GLOBALS	*MEF_globals;
+
+
+/**
+ * 	Build the pyramid sidecars of all segments of a time-series channel (existing pyramids are replaced)
+ *
+ * 	@param channel_path         The path to the channel directory
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ * 	@param num_levels           The number of levels to build (0 = determined by the number of samples in each segment)
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ * 	@return                     True if successful, false on failure
+ */
+bool build_channel_pyramid(si1 *channel_path, si1 *password, si4 num_levels, si4 num_threads) {
+	ui4		i;
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	initialize_crc_tables();
+	
+	// read the channel metadata
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	CHANNEL *channel = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, NULL, MEF_FALSE, MEF_FALSE);
+	
+	// check the number of segments
+	if (channel->number_of_segments == 0) {
+		mexPrintf("Error: no segments in channel, most likely due to an invalid channel folder, exiting...\n");
+		free_channel(channel, MEF_TRUE);
+        return false;
+	}
+	
+	// check if the data is encrypted and/or the correctness of password
+	if (channel->metadata.section_1->section_2_encryption > 0) {
+		if (password == NULL)
+			mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+		else
+			mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+		channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
+		free_channel(channel, MEF_TRUE);
+		return false;
+	}
+	
+	// build the lookup table of the blocks (with the settings of the channel's session)
+	READ_CONTEXT context;
+	capture_read_context(&context);
+	BLOCK_LOOKUP lookup;
+	bool success = build_block_lookup(channel, &context, &lookup);
+	if (!success)
+		mexPrintf("Error: could not build the block lookup table, exiting...\n");
+	
+	// build the pyramid of each segment
+	for (i = 0; success && i < (ui4) channel->number_of_segments; i++)
+		success = build_segment_pyramid(channel, &lookup, &context, i, num_levels, num_threads);
+	
+	// free the channel object memory
+	free_block_lookup(&lookup);
+	channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
+	free_channel(channel, MEF_TRUE);
+	
+	return success;
+	
+}
+
+/**
+ * 	Build the pyramid sidecar of a segment
+ *
+ *	The samples of the segment are read (and decimated into the points of all levels) a chunk at a time. Whenever the 
+ *	block of a level fills up, the block is encoded and written to the sidecar; the indices of the blocks and the
+ *	header are written once all samples are processed. The header is written last, so an incomplete pyramid is never
+ *	considered valid.
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ * 	@param segment              The index of the segment
+ * 	@param num_levels           The number of levels to build (0 = levels are added as long as they hold PYRAMID_AUTO_MIN_POINTS points)
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ * 	@return                     True if successful (or skipped, when the segment holds too few samples), false on failure
+ */
+bool build_segment_pyramid(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui4 segment, si4 num_levels, si4 num_threads) {
+	si4		l;
+	si8		p, pos;
+	si1		path[MEF_FULL_FILE_NAME_BYTES];
+	
+	SEGMENT *seg = &channel->segments[segment];
+	si8 seg_start_sample = lookup->segment_start_sample[segment];
+	si8 seg_samples = lookup->segment_end_sample[segment] - seg_start_sample;
+	
+	// determine the number of levels (levels should hold at least two points)
+	si8 min_points = (num_levels > 0) ? 2 : PYRAMID_AUTO_MIN_POINTS;
+	si4 max_levels = (num_levels > 0 && num_levels < PYRAMID_MAX_LEVELS) ? num_levels : PYRAMID_MAX_LEVELS;
+	si8 factor = PYRAMID_DECIMATION;
+	for (num_levels = 0; num_levels < max_levels && (seg_samples + factor - 1) / factor >= min_points; num_levels++)
+		factor *= PYRAMID_DECIMATION;
+	if (num_levels == 0) {
+		mexPrintf("Warning: segment '%s' holds too few samples to build a pyramid, skipped\n", seg->name);
+		return true;
+	}
+	factor /= PYRAMID_DECIMATION;
+	
+	// the number of samples to process at a time (whole points of the coarsest level)
+	si8 chunk_samples = ((PYRAMID_BUILD_SAMPLES + factor - 1) / factor) * factor;
+	
+	// the pyramid is encrypted with the same level as the data
+	si1 encryption_level = NO_ENCRYPTION;
+	ui1 flags = seg->time_series_indices_fps->time_series_indices[0].RED_block_flags;
+	if (flags & RED_LEVEL_2_ENCRYPTION_MASK)		encryption_level = LEVEL_2_ENCRYPTION;
+	else if (flags & RED_LEVEL_1_ENCRYPTION_MASK)	encryption_level = LEVEL_1_ENCRYPTION;
+	
+	// prepare the header and the levels
+	PYRAMID_HEADER header;
+	memset(&header, 0, sizeof(PYRAMID_HEADER));
+	header.version = PYRAMID_VERSION;
+	header.decimation = PYRAMID_DECIMATION;
+	header.number_of_levels = (ui4) num_levels;
+	header.block_points = PYRAMID_BLOCK_POINTS;
+	header.number_of_samples = seg_samples;
+	header.source_body_CRC = seg->time_series_data_fps->universal_header->body_CRC;
+	
+	PYRAMID_BUILD_LEVEL levels[PYRAMID_MAX_LEVELS];
+	memset(levels, 0, sizeof(levels));
+	bool success = true;
+	for (l = 0, factor = PYRAMID_DECIMATION; l < num_levels; l++, factor *= PYRAMID_DECIMATION) {
+		si8 chunk_points = chunk_samples / factor;
+		si8 level_points = (seg_samples + factor - 1) / factor;
+		levels[l].factor = header.levels[l].factor = factor;
+		levels[l].sums = (si8 *) malloc((size_t) chunk_points * sizeof(si8));
+		levels[l].counts = (si8 *) malloc((size_t) chunk_points * sizeof(si8));
+		levels[l].mins = (si4 *) malloc((size_t) chunk_points * sizeof(si4));
+		levels[l].maxs = (si4 *) malloc((size_t) chunk_points * sizeof(si4));
+		levels[l].block_points = (si4 *) malloc((size_t) (PYRAMID_BLOCK_POINTS * PYRAMID_STREAMS) * sizeof(si4));
+		levels[l].indices = (PYRAMID_INDEX *) malloc((size_t) ((level_points + PYRAMID_BLOCK_POINTS - 1) / PYRAMID_BLOCK_POINTS) * sizeof(PYRAMID_INDEX));
+		if (levels[l].sums == NULL || levels[l].counts == NULL || levels[l].mins == NULL || levels[l].maxs == NULL || levels[l].block_points == NULL || levels[l].indices == NULL)
+			success = false;
+	}
+	
+	// allocate the sample buffer, the encoding buffer (for the RED blocks of all streams of a block) and a RED processing struct
+	si4 *samples = (si4 *) malloc((size_t) chunk_samples * sizeof(si4));
+	ui1 *buffer = (ui1 *) malloc((size_t) (RED_MAX_COMPRESSED_BYTES(PYRAMID_BLOCK_POINTS, 1) * PYRAMID_STREAMS));
+	RED_PROCESSING_STRUCT *rps = RED_allocate_processing_struct(0, 0, 0, RED_MAX_DIFFERENCE_BYTES(PYRAMID_BLOCK_POINTS), 0, 0, seg->metadata_fps->password_data);
+	if (samples == NULL || buffer == NULL || rps == NULL)
+		success = false;
+	if (!success)
+		mexPrintf("Error: could not allocate enough memory to build the pyramid, exiting...\n");
+	
+	// create the sidecar, starting with an empty header (which is only completed at the end)
+	FILE *fp = NULL;
+	pyramid_file_path(seg, path);
+	if (success) {
+		fp = fopen(path, "wb");
+		if (fp == NULL || fwrite(&header, sizeof(PYRAMID_HEADER), 1, fp) != 1) {
+			mexPrintf("Error: could not create the pyramid file '%s', exiting...\n", path);
+			success = false;
+		}
+	}
+	si8 file_offset = sizeof(PYRAMID_HEADER);
+	
+	// read, decimate and write the samples a chunk at a time
+	for (pos = 0; success && pos < seg_samples; pos += chunk_samples) {
+		si8 num_samps = (seg_samples - pos < chunk_samples) ? seg_samples - pos : chunk_samples;
+		
+		// read the samples
+		CHANNEL_READ read;
+		success = prepare_channel_read(channel, lookup, context, RANGE_BY_SAMPLES, seg_start_sample + pos, seg_start_sample + pos + num_samps, &read);
+		if (success) {
+			read.validate_crc = true;
+			success = read_channel_samples(channel, &read, samples, num_threads);
+			if (read.message[0] != '\0')
+				mexPrintf("%s", read.message);
+		}
+		if (!success)	break;
+		
+		// decimate into the points of each level
+		decimate_pyramid_chunk(levels, num_levels, samples, num_samps);
+		
+		// add the points to the blocks of each level, and write each block that is full (or the last block of a level)
+		for (l = 0; success && l < num_levels; l++) {
+			PYRAMID_BUILD_LEVEL *level = &levels[l];
+			for (p = 0; success && p < level->chunk_points; p++) {
+				
+				level->block_points[(PYRAMID_STREAM_MEAN * PYRAMID_BLOCK_POINTS) + level->num_block_points] = pyramid_point_mean(level->sums[p], level->counts[p]);
+				level->block_points[(PYRAMID_STREAM_MIN * PYRAMID_BLOCK_POINTS) + level->num_block_points] = level->mins[p];
+				level->block_points[(PYRAMID_STREAM_MAX * PYRAMID_BLOCK_POINTS) + level->num_block_points] = level->maxs[p];
+				level->num_block_points++;
+				
+				bool last_point = (pos + num_samps == seg_samples && p == level->chunk_points - 1);
+				if (level->num_block_points == PYRAMID_BLOCK_POINTS || last_point) {
+					success = write_pyramid_block(fp, rps, buffer, encryption_level, level, &header.levels[l], &file_offset);
+					if (!success)
+						mexPrintf("Error: could not write to the pyramid file '%s', exiting...\n", path);
+				}
+				
+			}
+		}
+		
+	}
+	
+	// write the indices of the blocks of each level
+	for (l = 0; success && l < num_levels; l++) {
+		header.levels[l].index_offset = file_offset;
+		if (fwrite(levels[l].indices, sizeof(PYRAMID_INDEX), (size_t) levels[l].num_blocks, fp) != (size_t) levels[l].num_blocks) {
+			mexPrintf("Error: could not write to the pyramid file '%s', exiting...\n", path);
+			success = false;
+		}
+		file_offset += levels[l].num_blocks * (si8) sizeof(PYRAMID_INDEX);
+	}
+	
+	// complete and re-write the header
+	if (success) {
+		memcpy(header.magic, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC));
+		if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(PYRAMID_HEADER), 1, fp) != 1) {
+			mexPrintf("Error: could not write to the pyramid file '%s', exiting...\n", path);
+			success = false;
+		}
+	}
+	
+	// close the sidecar (and remove it on failure)
+	if (fp != NULL) {
+		if (fclose(fp) != 0)	success = false;
+		if (!success)			remove(path);
+	}
+	
+	// clean up
+	for (l = 0; l < num_levels; l++) {
+		free (levels[l].sums);
+		free (levels[l].counts);
+		free (levels[l].mins);
+		free (levels[l].maxs);
+		free (levels[l].block_points);
+		free (levels[l].indices);
+	}
+	free (samples);
+	free (buffer);
+	if (rps != NULL) {
+		rps->block_header = NULL;
+		rps->compressed_data = NULL;
+		rps->original_data = NULL;
+		rps->original_ptr = NULL;
+		rps->password_data = NULL;
+		RED_free_processing_struct(rps);
+	}
+	
+	return success;
+	
+}
+
+/**
+ * 	Encode the (filled) block of a level, as a RED block for each stream, and write it to the end of the pyramid file
+ *
+ * 	@param fp                   The pyramid file
+ * 	@param rps                  The RED processing struct to encode with
+ * 	@param buffer               The buffer to encode the RED blocks into (should hold PYRAMID_STREAMS blocks of PYRAMID_BLOCK_POINTS)
+ * 	@param encryption_level     The level to encrypt the RED blocks with
+ * 	@param level                The level, the points of its block are encoded (after which the block is empty again) and 
+ *								the index of the block is added
+ * 	@param header_level         The level in the header, of which the number of points, blocks and maximum block bytes are updated
+ * 	@param file_offset          Pointer to the offset in the file where the block is written, is updated to the end of the block
+ * 	@return                     True if successful, false on failure
+ */
+bool write_pyramid_block(FILE *fp, RED_PROCESSING_STRUCT *rps, ui1 *buffer, si1 encryption_level, PYRAMID_BUILD_LEVEL *level, PYRAMID_LEVEL *header_level, si8 *file_offset) {
+	si4		s;
+	
+	// encode the points of each stream
+	ui4 block_bytes = 0;
+	for (s = 0; s < PYRAMID_STREAMS; s++) {
+		rps->block_header = (RED_BLOCK_HEADER *) (rps->compressed_data = buffer + block_bytes);
+		memset(rps->block_header, 0, RED_BLOCK_HEADER_BYTES);
+		rps->block_header->number_of_samples = level->num_block_points;
+		rps->block_header->start_time = UUTC_NO_ENTRY;		// the times of the points follow from the segment
+		rps->directives.discontinuity = MEF_FALSE;
+		rps->directives.encryption_level = encryption_level;
+		rps->original_data = rps->original_ptr = level->block_points + (s * PYRAMID_BLOCK_POINTS);
+		RED_encode(rps);
+		block_bytes += rps->block_header->block_bytes;
+	}
+	
+	// write the block
+	if (fwrite(buffer, sizeof(ui1), block_bytes, fp) != block_bytes)
+		return false;
+	
+	// add the index
+	PYRAMID_INDEX *index = &level->indices[level->num_blocks++];
+	index->file_offset = *file_offset;
+	index->block_bytes = block_bytes;
+	index->number_of_points = level->num_block_points;
+	*file_offset += block_bytes;
+	
+	// update the level
+	header_level->number_of_points += level->num_block_points;
+	header_level->number_of_blocks = level->num_blocks;
+	if (header_level->maximum_block_bytes < block_bytes)
+		header_level->maximum_block_bytes = block_bytes;
+	level->num_block_points = 0;
+	
+	return true;
+	
+}
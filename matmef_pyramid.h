@@ -0,0 +1,34 @@
+#ifndef MATMEF_PYRAMID_
+#define MATMEF_PYRAMID_
+/**
+ * 	@file - headers
+ * 	Build multi-resolution pyramid sidecars (decimated mean, minimum and maximum levels) of time-series segments
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "meflib/meflib/meflib.h"
+#include "matmef_read.h"
+#include <stdbool.h>
+
+// When the number of levels is determined automatically, levels are added as long as they hold at least this number of points
+#define PYRAMID_AUTO_MIN_POINTS		64
+
+
+// 
+// Functions
+//
+
+bool build_channel_pyramid(si1 *channel_path, si1 *password, si4 num_levels, si4 num_threads);
+bool build_segment_pyramid(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui4 segment, si4 num_levels, si4 num_threads);
+bool write_pyramid_block(FILE *fp, RED_PROCESSING_STRUCT *rps, ui1 *buffer, si1 encryption_level, PYRAMID_BUILD_LEVEL *level, PYRAMID_LEVEL *header_level, si8 *file_offset);
+
+
+#endif   // MATMEF_PYRAMID_
@@ -16,6 +16,8 @@
 #include "matmef_read.h"
 #include "mex.h"
 #include "mex_utils.h"
+#include "matmef_threads.h"
+#include "matmef_crc.h"
 
 #include "meflib/meflib/meflib.c"
 #include "meflib/meflib/mefrec.c"
@@ -32,15 +34,19 @@
  *	@param range_start          Start-point for the reading of data (either as an epoch/unix timestamp or samplenumber; -1 for first)
  *	@param range_end            End-point to stop the of reading data (either as an epoch/unix timestamp or samplenumber; -1 for last)
  *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
- * 	@return                     Pointer to a matlab double matrix object (mxArray) containing the data, or NULL on failure
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ *  @param output_type          The type of the matlab output array (OUTPUT_DOUBLE, OUTPUT_SINGLE or OUTPUT_INT32)
+ *  @param validate_crc         Whether to validate the CRC of each block (false = trusted read, only the structure of the blocks is checked)
+ * 	@return                     Pointer to a matlab matrix object (mxArray) containing the data, or NULL on failure
  */
-mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor) {
+mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc) {
 
 	// if the password is just the null character, then correct to a null pointer
 	if (password != NULL && password[0] == '\0')	password = NULL;
 	
 	// initialize MEF library
 	(void) initialize_meflib();
+	initialize_crc_tables();
 	
 	// read the channel metadata
 	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
@@ -67,8 +73,10 @@ mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool rang
 		return NULL;
 	}
 	
-	// read the data by the channel object
-	mxArray *samples_read = read_channel_data_from_object(channel, range_type, range_start, range_end, apply_conv_factor);
+	// read the data by the channel object (with the settings of the channel's session)
+	READ_CONTEXT context;
+	capture_read_context(&context);
+	mxArray *samples_read = read_channel_data_from_object(channel, NULL, &context, NULL, range_type, range_start, range_end, apply_conv_factor, num_threads, output_type, validate_crc);
 	
 	// free the channel object memory
 	if (channel->number_of_segments > 0)	channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
@@ -86,32 +94,605 @@ mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool rang
  *	Note: this function does not free the memory of the given channel object (that is up to the function's caller)
  *
  * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel, or NULL to build one for this read only
+ * 	@param context              Pointer to the meflib settings of the channel's session (see capture_read_context)
+ * 	@param readahead            Pointer to the readahead of the channel, or NULL to not read ahead (see update_readahead)
  *	@param range_type           Modality that is used to define the data-range to read [either 'time' or 'samples']
  *	@param range_start          Start-point for the reading of data (either as an epoch/unix timestamp or samplenumber; -1 for first)
  *	@param range_end            End-point to stop the of reading data (either as an epoch/unix timestamp or samplenumber; -1 for last)
  *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
- * 	@return                     Pointer to a matlab double matrix object (mxArray) containing the data, or NULL on failure
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ *  @param output_type          The type of the matlab output array (OUTPUT_DOUBLE, OUTPUT_SINGLE or OUTPUT_INT32). The int32 output is only
+ *                              available for ranges in samples (there are no gaps to fill with NaNs) and without conversion factor.
+ *  @param validate_crc         Whether to validate the CRC of each block (false = trusted read, only the structure of the blocks is checked)
+ * 	@return                     Pointer to a matlab matrix object (mxArray) containing the data, or NULL on failure
  */
-mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor) {
-	ui8     i, j;
-	ui8		num_blocks;
-	ui8		num_block_in_segment;
+mxArray *read_channel_data_from_object(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, READAHEAD *readahead, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc) {
+	
+	// check the output type
+	if (output_type == OUTPUT_INT32) {
+		if (range_type != RANGE_BY_SAMPLES) {
+			mexPrintf("Error: int32 output is only available when the range is given in samples (time ranges can contain gaps that are filled with NaNs), exiting...\n");
+			return NULL;
+		}
+		if (apply_conv_factor) {
+			mexPrintf("Error: the conversion factor cannot be applied to int32 output, exiting...\n");
+			return NULL;
+		}
+	}
 	
     // check/warning whether the conversion factor should be applied
     if (channel->metadata.time_series_section_2->units_conversion_factor != 1 && !apply_conv_factor) {
         mxForceWarning("matmef:read_channel_data_from_object", "the conversion factor of %f is not being applied to the raw data.\nMake sure to check and manually apply, or set apply_conv_factor to apply the conversion while loading.", channel->metadata.time_series_section_2->units_conversion_factor);
     }
     
+	// determine the range to read
+	CHANNEL_READ read;
+	if (!prepare_channel_read(channel, lookup, context, range_type, range_start, range_end, &read))
+		return NULL;
+	read.validate_crc = validate_crc;
+	read.cache = get_block_cache();
+	read.readahead = readahead;
+	
+	// check if the range has no samples
+	if (read.num_samps == 0) {
+		
+		// message
+		mexPrintf("Warning: a range of 0 samples was given, returning empty array\n");
+		
+		// return an empty array (1x1, as before, but of the requested type)
+		if (output_type == OUTPUT_INT32)
+			return mxCreateNumericMatrix(1, 1, mxINT32_CLASS, mxREAL);
+		if (output_type == OUTPUT_SINGLE)
+			return mxCreateNumericMatrix(1, 1, mxSINGLE_CLASS, mxREAL);
+		return mxCreateDoubleMatrix(1, 1, mxREAL);
+		
+	}
+	ui8 num_samps = read.num_samps;
+	
+	// int32 output: decode straight into the (zero-initialized) matlab array
+	// (for sample ranges there are no NaN gaps, so no conversion is needed)
+	if (output_type == OUTPUT_INT32) {
+		mxArray *mat_array = mxCreateNumericMatrix(1, num_samps, mxINT32_CLASS, mxREAL);
+		read.output_initialized = true;
+		bool success = read_channel_samples(channel, &read, (si4 *) mxGetData(mat_array), num_threads);
+		if (read.message[0] != '\0')
+			mexPrintf("%s", read.message);
+		if (!success) {
+			mxDestroyArray(mat_array);
+			return NULL;
+		}
+		
+		// read ahead what follows (when sequential)
+		if (readahead != NULL)
+			update_readahead(readahead, channel, read.start_segment, read.start_idx, read.end_segment, read.end_idx, read.num_blocks);
+		
+		return mat_array;
+	}
+	
+	// 
+    // Decompressed data are integers (si4) and represent the "real" data; Integers technically do not have a NaN value as it exists for float datatypes.
+    // Internally a si4 emulated NaN value ('RED_NAN') is used, however this value is not standard for Matlab (or Python)
+    //
+    // When range is indicated in time, then gaps/discontinuities in the data need to be filled with NaNs. Therefore, we return
+    // the data as doubles (or singles). Integer to float cannot by byte-copied, therefore it needs to be cast per element.
+    //
+    // Note: when the range is indicated in samples, no nans exist, so the int32 output type (above) allocates a matlab
+    //       int array at the start and reads the data directly into that
+    //
+	
+	// allocate the matlab array (double or single)
+    // using floating point types so we can use NaN values for discontinuities (when range is indicated in time)
+	mxArray *mat_array;
+	if (output_type == OUTPUT_SINGLE)
+		mat_array = mxCreateNumericMatrix(1, num_samps, mxSINGLE_CLASS, mxREAL);
+	else
+		mat_array = mxCreateDoubleMatrix(1, num_samps, mxREAL);
+	
+	// decode the samples into the matlab array itself, so no separate sample buffer is needed
+	// (for singles at the start, for doubles in the second half of the array; the samples are copied out chunk by
+	//  chunk when they are converted, see convert_samples_in_output)
+	si4 *decomp_data = (si4 *) mxGetData(mat_array);
+	if (output_type != OUTPUT_SINGLE)
+		decomp_data += num_samps;
+	read.output_initialized = true;
+	
+	// read and decode the samples
+	bool success = read_channel_samples(channel, &read, decomp_data, num_threads);
+	if (read.message[0] != '\0')
+		mexPrintf("%s", read.message);
+	if (!success) {
+		mxDestroyArray(mat_array);
+		return NULL;
+	}
+	
+	// read ahead what follows (when sequential), while the samples are converted
+	if (readahead != NULL)
+		update_readahead(readahead, channel, read.start_segment, read.start_idx, read.end_segment, read.end_idx, read.num_blocks);
+	
+	// convert/cast the data in the matlab array, applying the conversion factor in the same pass
+	sf8 fac = (apply_conv_factor) ? channel->metadata.time_series_section_2->units_conversion_factor : 1.0;
+	convert_samples_in_output(decomp_data, num_samps, mxGetData(mat_array), output_type, fac, mxGetNaN());
+    
+	// return the data
+	return mat_array;
+	
+}
+
+/**
+ * 	Read the data of multiple time-series channels in a session, given a range of data to read.
+ *  The range is defined as a type (RANGE_BY_SAMPLES or RANGE_BY_TIME), a startpoint and an endpoint.
+ * 	
+ *	The channels are opened (and their ranges determined) one by one, after which the data of the channels is
+ *	read and decoded by a pool of threads, each thread reading whole channels directly into the output matrix.
+ *
+ * 	@param session_path         The path to the session directory
+ * 	@param channel_names        Array of (num_channels) channel names (without the .timd extension)
+ * 	@param num_channels         The number of channels to read
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ *	@param range_type           Modality that is used to define the data-range to read [either 'time' or 'samples']
+ *	@param range_start          Start-point for the reading of data (either as an epoch/unix timestamp or samplenumber; -1 for first)
+ *	@param range_end            End-point to stop the of reading data (either as an epoch/unix timestamp or samplenumber; -1 for last)
+ *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
+ *  @param num_threads          The number of threads used to read the channels (1 = single-threaded; 0 = one per processor)
+ *  @param output_type          The type of the matlab output matrix (OUTPUT_DOUBLE or OUTPUT_SINGLE)
+ * 	@return                     Pointer to a matlab double/single matrix object (mxArray) containing the data as <channels> x <samples> 
+ *								(shorter channels are padded with NaNs), or NULL on failure
+ */
+mxArray *read_session_channels_data(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc) {
+	si4		i;
+	ui8		j;
+	si1		channel_path[MEF_FULL_FILE_NAME_BYTES];
+	bool	success = true;
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// allocate the channel objects and ranges
+	CHANNEL **channels = (CHANNEL **) calloc((size_t) num_channels, sizeof(CHANNEL *));
+	CHANNEL_READ *reads = (CHANNEL_READ *) calloc((size_t) num_channels, sizeof(CHANNEL_READ));
+	if (channels == NULL || reads == NULL) {
+		free (channels);
+		free (reads);
+		mexPrintf("Error: could not allocated enough memory for the channels, exiting....\n");
+		return NULL;
+	}
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	initialize_crc_tables();
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	
+	// open the channels and determine the range to read from each
+	// note: the password data is processed once and shared between the channels (as read_MEF_session does)
+	PASSWORD_DATA *password_data = NULL;
+	ui8 max_samps = 0;
+	for (i = 0; i < num_channels; i++) {
+		
+		// read the channel metadata
+		MEF_snprintf(channel_path, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", session_path, channel_names[i], TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING);
+		channels[i] = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, password_data, MEF_FALSE, MEF_FALSE);
+		
+		// check the number of segments
+		// (without segments, password data that was processed for this channel is held by the channel record indices,
+		// it is kept as the shared password data so that it is freed with it)
+		if (channels[i]->number_of_segments == 0) {
+			mexPrintf("Error: no segments in channel '%s', most likely due to an invalid channel folder, exiting...\n", channel_names[i]);
+			if (password_data == NULL && channels[i]->record_indices_fps != NULL)
+				password_data = channels[i]->record_indices_fps->password_data;
+			success = false;
+			break;
+		}
+		if (password_data == NULL)
+			password_data = channels[i]->segments[0].metadata_fps->password_data;
+		
+		// check if the data is encrypted and/or the correctness of password
+		if (channels[i]->metadata.section_1->section_2_encryption > 0) {
+			if (password == NULL)
+				mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+			else
+				mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+			success = false;
+			break;
+		}
+		
+		// check/warning whether the conversion factor should be applied
+		if (channels[i]->metadata.time_series_section_2->units_conversion_factor != 1 && !apply_conv_factor) {
+			mxForceWarning("matmef:read_session_channels_data", "the conversion factor of %f (channel '%s') is not being applied to the raw data.\nMake sure to check and manually apply, or set apply_conv_factor to apply the conversion while loading.", channels[i]->metadata.time_series_section_2->units_conversion_factor, channel_names[i]);
+		}
+		
+		// determine the range to read (with the settings of the channel's session)
+		READ_CONTEXT context;
+		capture_read_context(&context);
+		if (!prepare_channel_read(channels[i], NULL, &context, range_type, range_start, range_end, &reads[i])) {
+			mexPrintf("Error: could not determine the range to read from channel '%s', exiting...\n", channel_names[i]);
+			success = false;
+			break;
+		}
+		reads[i].validate_crc = validate_crc;
+		if (reads[i].num_samps > max_samps)		max_samps = reads[i].num_samps;
+		
+	}
+	
+	// read the compressed data of all channels at once
+	if (success && max_samps > 0)
+		preload_channel_reads(channels, reads, num_channels, num_threads);
+	
+	// allocate matlab double matrix (<channels> x <samples>) and read the data
+	mxArray *mat_array = NULL;
+	if (success) {
+		
+		// check if the range has no samples
+		if (max_samps == 0) {
+			mexPrintf("Warning: a range of 0 samples was given, returning empty array\n");
+			mat_array = mxCreateNumericMatrix(num_channels, 0, (output_type == OUTPUT_SINGLE) ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+			
+		} else {
+			if (output_type == OUTPUT_SINGLE)
+				mat_array = mxCreateNumericMatrix(num_channels, max_samps, mxSINGLE_CLASS, mxREAL);
+			else
+				mat_array = mxCreateDoubleMatrix(num_channels, max_samps, mxREAL);
+			
+			// divide the channels over the workers (interleaved, so channels from the same region of the session spread over workers)
+			si4 num_workers = resolve_number_of_threads(num_threads, num_channels);
+			CHANNELS_WORKER *workers = (CHANNELS_WORKER *) calloc((size_t) num_workers, sizeof(CHANNELS_WORKER));
+			if (workers == NULL) {
+				mexPrintf("Error: could not allocated enough memory for the workers, exiting....\n");
+				success = false;
+				
+			} else {
+				for (i = 0; i < num_workers; i++) {
+					workers[i].channels = channels;
+					workers[i].reads = reads;
+					workers[i].first_channel = i;
+					workers[i].channel_step = num_workers;
+					workers[i].num_channels = num_channels;
+					workers[i].output = mxGetData(mat_array);
+					workers[i].output_type = output_type;
+					workers[i].output_samps = max_samps;
+					workers[i].apply_conv_factor = apply_conv_factor;
+					workers[i].nan_value = mxGetNaN();
+					workers[i].success = true;
+				}
+				
+				// read the channels
+				run_threads(num_workers, read_channels_worker, workers, sizeof(CHANNELS_WORKER));
+				for (i = 0; i < num_workers; i++)
+					if (!workers[i].success)	success = false;
+				free (workers);
+				
+				// output the messages of the channels (in order)
+				for (i = 0; i < num_channels; i++)
+					if (reads[i].message[0] != '\0')
+						mexPrintf("%s", reads[i].message);
+				
+			}
+			
+			// pad the rest of the rows of channels that were shorter than the longest channel
+			if (success) {
+				mxDouble mxNaN = mxGetNaN();
+				for (i = 0; i < num_channels; i++) {
+					for (j = reads[i].num_samps; j < max_samps; j++) {
+						if (output_type == OUTPUT_SINGLE)
+							*((mxSingle *) mxGetData(mat_array) + (j * num_channels) + i) = (mxSingle) mxNaN;
+						else
+							*(mxGetPr(mat_array) + (j * num_channels) + i) = mxNaN;
+					}
+				}
+			} else {
+				mxDestroyArray(mat_array);
+				mat_array = NULL;
+			}
+			
+		}
+	}
+	
+	// free the channel objects memory (the shared password data is freed once, at the end)
+	for (i = 0; i < num_channels; i++) {
+		if (channels[i] != NULL)
+			free_channel(channels[i], MEF_TRUE);
+		free (reads[i].preloaded);
+	}
+	free (password_data);
+	free (channels);
+	free (reads);
+	
+	// return the data
+	return mat_array;
+	
+}
+
+/**
+ * 	Read the data of multiple time-series channels in a session, given multiple ranges (epochs) of data to read.
+ *  The ranges are defined as a type (RANGE_BY_SAMPLES or RANGE_BY_TIME), and a startpoint and endpoint for each range.
+ * 	
+ *	Instead of reading each range separately, the ranges of a channel are sorted by the blocks they start in, and ranges
+ *	that share (or border on) blocks are merged into a single read. Each block that is needed is therefore read and decoded
+ *	only once, after which its samples are copied into every range that it overlaps with. The data of the channels is
+ *	read by a pool of threads, each thread reading whole channels directly into the output matrix.
+ *
+ * 	@param session_path         The path to the session directory
+ * 	@param channel_names        Array of (num_channels) channel names (without the .timd extension)
+ * 	@param num_channels         The number of channels to read
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ *	@param range_type           Modality that is used to define the data-ranges to read [either 'time' or 'samples']
+ *	@param ranges_start         Array of (num_ranges) start-points of the ranges (either as an epoch/unix timestamp or samplenumber; -1 for first)
+ *	@param ranges_end           Array of (num_ranges) end-points of the ranges (either as an epoch/unix timestamp or samplenumber; -1 for last)
+ *	@param num_ranges           The number of ranges to read
+ *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
+ *  @param num_threads          The number of threads used to read the channels (1 = single-threaded; 0 = one per processor)
+ *  @param output_type          The type of the matlab output matrix (OUTPUT_DOUBLE or OUTPUT_SINGLE)
+ *  @param validate_crc         Whether to validate the CRC of each block (false = trusted read, only the structure of the blocks is checked)
+ * 	@return                     Pointer to a matlab double/single matrix object (mxArray) containing the data as <channels> x <samples> x <ranges>
+ *								(shorter ranges are padded with NaNs), or NULL on failure
+ */
+mxArray *read_session_channels_epochs(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, bool range_type, si8 *ranges_start, si8 *ranges_end, si4 num_ranges, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc) {
+	si4		i, r;
+	si1		channel_path[MEF_FULL_FILE_NAME_BYTES];
+	bool	success = true;
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// allocate the channel objects, lookup tables, epochs (a range of a channel) and groups of epochs
+	// (a channel has at most as many groups as ranges)
+	CHANNEL **channels = (CHANNEL **) calloc((size_t) num_channels, sizeof(CHANNEL *));
+	BLOCK_LOOKUP *lookups = (BLOCK_LOOKUP *) calloc((size_t) num_channels, sizeof(BLOCK_LOOKUP));
+	READ_CONTEXT *contexts = (READ_CONTEXT *) calloc((size_t) num_channels, sizeof(READ_CONTEXT));
+	EPOCH *epochs = (EPOCH *) calloc((size_t) num_channels * num_ranges, sizeof(EPOCH));
+	EPOCHS_GROUP *groups = (EPOCHS_GROUP *) calloc((size_t) num_channels * num_ranges, sizeof(EPOCHS_GROUP));
+	ui8 *channel_first_group = (ui8 *) calloc((size_t) num_channels + 1, sizeof(ui8));
+	if (channels == NULL || lookups == NULL || contexts == NULL || epochs == NULL || groups == NULL || channel_first_group == NULL) {
+		free (channels);
+		free (lookups);
+		free (contexts);
+		free (epochs);
+		free (groups);
+		free (channel_first_group);
+		mexPrintf("Error: could not allocated enough memory for the channels, exiting....\n");
+		return NULL;
+	}
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	initialize_crc_tables();
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	
+	// open the channels and determine the ranges to read from each
+	// note: the password data is processed once and shared between the channels (as read_MEF_session does)
+	PASSWORD_DATA *password_data = NULL;
+	CHANNEL_READ read;
+	ui8 max_samps = 0;
+	ui8 num_groups = 0;
+	for (i = 0; i < num_channels; i++) {
+		
+		// read the channel metadata
+		MEF_snprintf(channel_path, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", session_path, channel_names[i], TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING);
+		channels[i] = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, password_data, MEF_FALSE, MEF_FALSE);
+		
+		// check the number of segments
+		// (without segments, password data that was processed for this channel is held by the channel record indices,
+		// it is kept as the shared password data so that it is freed with it)
+		if (channels[i]->number_of_segments == 0) {
+			mexPrintf("Error: no segments in channel '%s', most likely due to an invalid channel folder, exiting...\n", channel_names[i]);
+			if (password_data == NULL && channels[i]->record_indices_fps != NULL)
+				password_data = channels[i]->record_indices_fps->password_data;
+			success = false;
+			break;
+		}
+		if (password_data == NULL)
+			password_data = channels[i]->segments[0].metadata_fps->password_data;
+		
+		// check if the data is encrypted and/or the correctness of password
+		if (channels[i]->metadata.section_1->section_2_encryption > 0) {
+			if (password == NULL)
+				mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+			else
+				mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+			success = false;
+			break;
+		}
+		
+		// check/warning whether the conversion factor should be applied
+		if (channels[i]->metadata.time_series_section_2->units_conversion_factor != 1 && !apply_conv_factor) {
+			mxForceWarning("matmef:read_session_channels_epochs", "the conversion factor of %f (channel '%s') is not being applied to the raw data.\nMake sure to check and manually apply, or set apply_conv_factor to apply the conversion while loading.", channels[i]->metadata.time_series_section_2->units_conversion_factor, channel_names[i]);
+		}
+		
+		// build the lookup table of the blocks (with the settings of the channel's session)
+		capture_read_context(&contexts[i]);
+		if (!build_block_lookup(channels[i], &contexts[i], &lookups[i])) {
+			mexPrintf("Error: could not build the block lookup table of channel '%s', exiting...\n", channel_names[i]);
+			success = false;
+			break;
+		}
+		
+		// determine the range to read for each epoch, and the (first and last) blocks that it needs
+		EPOCH *channel_epochs = &epochs[(ui8) i * num_ranges];
+		for (r = 0; r < num_ranges; r++) {
+			if (!prepare_channel_read(channels[i], &lookups[i], &contexts[i], range_type, ranges_start[r], ranges_end[r], &read)) {
+				mexPrintf("Error: could not determine range %i to read from channel '%s', exiting...\n", r + 1, channel_names[i]);
+				success = false;
+				break;
+			}
+			
+			EPOCH *epoch = &channel_epochs[r];
+			epoch->range = (ui4) r;
+			epoch->num_samps = read.num_samps;
+			if (read.num_samps == 0)	continue;
+			epoch->start_samp = read.start_samp;
+			epoch->start_time = read.start_time;
+			epoch->first_block = lookups[i].segment_first_block[read.start_segment] + read.start_idx;
+			epoch->last_block = lookups[i].segment_first_block[read.end_segment] + read.end_idx;
+			if (read.num_samps > max_samps)		max_samps = read.num_samps;
+		}
+		if (!success)	break;
+		
+		// sort the epochs of the channel by the blocks they start in, and merge the epochs that overlap
+		// or border on each other (in blocks) into groups that are read at once
+		qsort(channel_epochs, (size_t) num_ranges, sizeof(EPOCH), compare_epochs);
+		channel_first_group[i] = num_groups;
+		for (r = 0; r < num_ranges; r++) {
+			EPOCH *epoch = &channel_epochs[r];
+			if (epoch->num_samps == 0)	break;
+			
+			if (num_groups > channel_first_group[i] && epoch->first_block <= groups[num_groups - 1].last_block + 1) {
+				EPOCHS_GROUP *group = &groups[num_groups - 1];
+				if (epoch->last_block > group->last_block)	group->last_block = epoch->last_block;
+				group->num_epochs++;
+			} else {
+				EPOCHS_GROUP *group = &groups[num_groups++];
+				group->first_block = epoch->first_block;
+				group->last_block = epoch->last_block;
+				group->first_epoch = (ui8) i * num_ranges + r;
+				group->num_epochs = 1;
+			}
+		}
+		
+	}
+	channel_first_group[num_channels] = num_groups;
+	
+	// allocate matlab double matrix (<channels> x <samples> x <ranges>) and read the data
+	mxArray *mat_array = NULL;
+	if (success) {
+		
+		// check if the ranges have no samples
+		if (max_samps == 0) {
+			mexPrintf("Warning: ranges of 0 samples were given, returning empty array\n");
+			mwSize dims[3] = {(mwSize) num_channels, 0, (mwSize) num_ranges};
+			mat_array = mxCreateNumericArray(3, dims, (output_type == OUTPUT_SINGLE) ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+			
+		} else {
+			mwSize dims[3] = {(mwSize) num_channels, (mwSize) max_samps, (mwSize) num_ranges};
+			mat_array = mxCreateNumericArray(3, dims, (output_type == OUTPUT_SINGLE) ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+			
+			// read the compressed data of all groups (of all channels) at once
+			preload_epochs_groups(channels, lookups, contexts, groups, channel_first_group, num_channels, num_threads);
+			
+			// divide the channels over the workers (interleaved, so channels from the same region of the session spread over workers)
+			si4 num_workers = resolve_number_of_threads(num_threads, num_channels);
+			EPOCHS_WORKER *workers = (EPOCHS_WORKER *) calloc((size_t) num_workers, sizeof(EPOCHS_WORKER));
+			if (workers == NULL) {
+				mexPrintf("Error: could not allocated enough memory for the workers, exiting....\n");
+				success = false;
+				
+			} else {
+				for (i = 0; i < num_workers; i++) {
+					workers[i].channels = channels;
+					workers[i].lookups = lookups;
+					workers[i].contexts = contexts;
+					workers[i].epochs = epochs;
+					workers[i].groups = groups;
+					workers[i].channel_first_group = channel_first_group;
+					workers[i].first_channel = i;
+					workers[i].channel_step = num_workers;
+					workers[i].num_channels = num_channels;
+					workers[i].num_ranges = num_ranges;
+					workers[i].range_type = range_type;
+					workers[i].output = mxGetData(mat_array);
+					workers[i].output_type = output_type;
+					workers[i].output_samps = max_samps;
+					workers[i].apply_conv_factor = apply_conv_factor;
+					workers[i].validate_crc = validate_crc;
+					workers[i].nan_value = mxGetNaN();
+					workers[i].success = true;
+				}
+				
+				// read the channels
+				run_threads(num_workers, read_epochs_worker, workers, sizeof(EPOCHS_WORKER));
+				for (i = 0; i < num_workers; i++) {
+					if (workers[i].message[0] != '\0')
+						mexPrintf("%s", workers[i].message);
+					if (!workers[i].success)	success = false;
+				}
+				free (workers);
+				
+			}
+			
+			if (!success) {
+				mxDestroyArray(mat_array);
+				mat_array = NULL;
+			}
+			
+		}
+	}
+	
+	// free the channel objects memory (the shared password data is freed once, at the end)
+	for (i = 0; i < num_channels; i++) {
+		free_block_lookup(&lookups[i]);
+		if (channels[i] != NULL)
+			free_channel(channels[i], MEF_TRUE);
+	}
+	free (password_data);
+	for (ui8 g = 0; g < num_groups; g++)
+		free (groups[g].preloaded);
+	free (channels);
+	free (lookups);
+	free (contexts);
+	free (epochs);
+	free (groups);
+	free (channel_first_group);
+	
+	// return the data
+	return mat_array;
+	
+}
+
+/**
+ * 	Compare two epochs by the block they start in (epochs without samples are sorted last), for qsort
+ *
+ * 	@param a                    Pointer to the first epoch
+ * 	@param b                    Pointer to the second epoch
+ * 	@return                     A negative value if the first epoch comes first, positive if the second comes first
+ */
+int compare_epochs(const void *a, const void *b) {
+	const EPOCH *epoch_a = (const EPOCH *) a;
+	const EPOCH *epoch_b = (const EPOCH *) b;
+	if ((epoch_a->num_samps == 0) != (epoch_b->num_samps == 0))
+		return (epoch_a->num_samps == 0) ? 1 : -1;
+	if (epoch_a->first_block != epoch_b->first_block)
+		return (epoch_a->first_block < epoch_b->first_block) ? -1 : 1;
+	return (epoch_a->range < epoch_b->range) ? -1 : (epoch_a->range > epoch_b->range);
+}
+
+/**
+ * 	Determine (and validate) the range of samples and blocks to read from a channel, given a range of data to read.
+ *  The range is defined as a type (RANGE_BY_SAMPLES or RANGE_BY_TIME), a startpoint and an endpoint.
+ * 	
+ *	Note: this function outputs messages to matlab, so it should only be called from the main (matlab) thread
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel, or NULL to build one for this call only
+ * 	@param context              Pointer to the meflib settings of the channel's session (copied into the read)
+ *	@param range_type           Modality that is used to define the data-range to read [either 'time' or 'samples']
+ *	@param range_start          Start-point for the reading of data (either as an epoch/unix timestamp or samplenumber; -1 for first)
+ *	@param range_end            End-point to stop the of reading data (either as an epoch/unix timestamp or samplenumber; -1 for last)
+ *	@param read                 Pointer to the struct that will hold the range to read
+ * 	@return                     True if a valid range was determined (which can contain 0 samples), false on failure
+ */
+bool prepare_channel_read(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, bool range_type, si8 range_start, si8 range_end, CHANNEL_READ *read) {
+	ui8     i;
+	ui8		num_blocks;
+	ui8		num_block_in_segment;
+	
+	// start without messages
+	read->message[0] = '\0';
+	read->output_initialized = false;
+	read->validate_crc = true;
+	read->context = *context;
+	read->cache = NULL;
+	read->readahead = NULL;
+	read->preloaded = NULL;
+	
 	// check if the channel is indeed of a time-series channel
 	if (channel->channel_type != TIME_SERIES_CHANNEL_TYPE) {
 		mexPrintf("Error: not a time series channel, exiting...\n"); 
-        return NULL;
+        return false;
     }
 	
 	// check the number of segments
 	if (channel->number_of_segments == 0) {
 		mexPrintf("Error: no segments in channel, exiting...\n"); 
-        return NULL;
+        return false;
 	}
 	
 	// set the default ranges for the samples and time to all
@@ -127,11 +708,11 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 	// check if valid data range
     if (range_type == RANGE_BY_TIME && start_time >= end_time) {
 		mexPrintf("Error: start-time (%lld) later than end-time (%lld), exiting...\n", start_time, end_time);
-        return NULL;
+        return false;
     }
     if (range_type == RANGE_BY_SAMPLES && start_samp >= end_samp) {
         mexPrintf("Error: start-sample (%lld) larger than end-sample (%lld), exiting...\n", start_samp, end_samp);
-        return NULL;
+        return false;
     }
 	
     // fire warnings if start or stop or both are out of file
@@ -140,7 +721,7 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
         if (((start_time < channel->earliest_start_time) & (end_time < channel->earliest_start_time)) |
             ((start_time > channel->latest_end_time) & (end_time > channel->latest_end_time))) {
             mexPrintf("Error: start and stop times are out of file.\n");
-            return NULL;
+            return false;
         }
 		
         if (end_time > channel->latest_end_time)			mxForceWarning("matmef:read_channel_data_from_object", "stop uutc later than latest end time. Will insert NaNs");
@@ -151,15 +732,15 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
         if (((start_samp < 0) & (end_samp < 0)) |
             ((start_samp > channel->metadata.time_series_section_2->number_of_samples) & (end_samp > channel->metadata.time_series_section_2->number_of_samples))) {
             mexPrintf("Error: start and stop samples are out of file\n");
-            return NULL;
+            return false;
         }
         if (end_samp > channel->metadata.time_series_section_2->number_of_samples) {
             mexPrintf("Error: stop sample larger than number of samples. Setting end sample to number of samples in channel\n");
-			return NULL;
+			return false;
         }
         if (start_samp < 0) {
             mexPrintf("Error: start sample smaller than 0. Setting start sample to 0\n");
-			return NULL;
+			return false;
         }
 		
     }
@@ -171,64 +752,81 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
     else
         num_samps = (ui4) (end_samp - start_samp);
 	
-	// check if the range has no samples
-	if (num_samps == 0) {
-		
-		// message
-		mexPrintf("Warning: a range of 0 samples was given, returning empty array\n");
-		
-		// return an empty array
-		return mxCreateDoubleMatrix(1, 1, mxREAL);
-		
+	// check if the range has no samples (nothing more to determine)
+	read->range_type = range_type;
+	read->num_samps = num_samps;
+	if (num_samps == 0)
+		return true;
+	
+	// build a lookup table of the blocks for this call if none was given
+	BLOCK_LOOKUP local_lookup;
+	if (lookup == NULL) {
+		if (!build_block_lookup(channel, context, &local_lookup)) {
+			mexPrintf("Error: could not build the block lookup table, exiting...\n");
+			return false;
+		}
+		lookup = &local_lookup;
 	}
 	
-    // iterate through segments, looking for data that matches our criteria
-    ui4 n_segments = (ui4) channel->number_of_segments;
+    ui4 n_segments = lookup->num_segments;
     ui4 start_segment = -1;
 	ui4 end_segment = -1;
     
 	// convert the range in samples to time or vise versa
     if (range_type == RANGE_BY_TIME) {
-        start_samp = sample_for_uutc_c(start_time, channel);
-        end_samp = sample_for_uutc_c(end_time, channel);
+        start_samp = sample_for_uutc_c(start_time, lookup);
+        end_samp = sample_for_uutc_c(end_time, lookup);
     } else {
-        start_time = uutc_for_sample_c(start_samp, channel);
-        end_time = uutc_for_sample_c(end_samp, channel);
+        start_time = uutc_for_sample_c(start_samp, lookup);
+        end_time = uutc_for_sample_c(end_samp, lookup);
     }
 	
-
-    // find start and stop segments by uutc time
-    // find start segment by finding first segment whose ending is past the start time.
-    // then find stop segment by using the previous segment of the (first segment whose start is past the end time)
-    for (i = 0; i < n_segments; ++i) {
-        
-        if (range_type == RANGE_BY_TIME) {
-			
-            si8 segment_start_time = channel->segments[i].time_series_data_fps->universal_header->start_time;
-            si8 segment_end_time   = channel->segments[i].time_series_data_fps->universal_header->end_time;
-            remove_recording_time_offset( &segment_start_time);
-            remove_recording_time_offset( &segment_end_time);
+    // find start and stop segments (binary search on the segments in the lookup table)
+    ui4 lo, hi, mid;
+    if (range_type == RANGE_BY_TIME) {
+		
+        // find start segment by finding first segment whose ending is past the start time
+        lo = 0; hi = n_segments;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (lookup->segment_end_time[mid] >= start_time)	hi = mid;
+            else												lo = mid + 1;
+        }
+        if (lo < n_segments) {
+            start_segment = lo;
 			
-            if ((segment_end_time >= start_time) && (start_segment == -1)){
-                start_segment = i;
-                end_segment = i;
+            // find stop segment as the last segment (from the start segment on) that starts before the end time
+            lo = start_segment + 1; hi = n_segments;
+            while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+                if (lookup->segment_start_time[mid] <= end_time)	lo = mid + 1;
+                else												hi = mid;
             }
-            if ((end_segment != -1) && (segment_start_time <= end_time))
-                end_segment = i;
+            end_segment = lo - 1;
 			
-        } else {
-				
-            si8 segment_start_sample = channel->segments[i].metadata_fps->metadata.time_series_section_2->start_sample;
-            si8 segment_end_sample   = channel->segments[i].metadata_fps->metadata.time_series_section_2->start_sample +
-										channel->segments[i].metadata_fps->metadata.time_series_section_2->number_of_samples;
-			
-            if ((start_samp >= segment_start_sample) && (start_samp <= segment_end_sample))
-                start_segment = i;
-            if ((end_samp >= segment_start_sample) && (end_samp <= segment_end_sample))
-                end_segment = i;
-            
         }
 		
+    } else {
+		
+        // find the last segments that start at or before the start and end sample, and check if the sample falls within
+        lo = 0; hi = n_segments;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (lookup->segment_start_sample[mid] <= start_samp)	lo = mid + 1;
+            else													hi = mid;
+        }
+        if (lo > 0 && start_samp <= lookup->segment_end_sample[lo - 1])
+            start_segment = lo - 1;
+		
+        lo = 0; hi = n_segments;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (lookup->segment_start_sample[mid] <= end_samp)		lo = mid + 1;
+            else													hi = mid;
+        }
+        if (lo > 0 && end_samp <= lookup->segment_end_sample[lo - 1])
+            end_segment = lo - 1;
+		
     }
 
 	// check if both the start- and endsegment were found
@@ -236,39 +834,15 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 
 		// message
 		mexPrintf("Error: unable to find the start segment (%i) or end segment (%i), existing...\n", start_segment, end_segment);
-		return NULL;
+		if (lookup == &local_lookup)	free_block_lookup(&local_lookup);
+		return false;
 		
 	}
 
-    // find start block in start segment
-    ui8 start_idx = 0;
-	ui8 end_idx = 0;
-    for (j = 1; j < channel->segments[start_segment].metadata_fps->metadata.time_series_section_2->number_of_blocks; j++) {
-		
-        si8 block_start_time = channel->segments[start_segment].time_series_indices_fps->time_series_indices[j].start_time;
-        remove_recording_time_offset( &block_start_time);
-        
-        if (block_start_time > start_time) {
-            start_idx = j - 1;
-            break;
-        }
-        // starting point is in last block in segment
-        start_idx = j;
-    }
-    
-    // find stop block in stop segment
-    for (j = 1; j < channel->segments[end_segment].metadata_fps->metadata.time_series_section_2->number_of_blocks; j++) {
-        
-        si8 block_start_time = channel->segments[end_segment].time_series_indices_fps->time_series_indices[j].start_time;
-        remove_recording_time_offset( &block_start_time);
-        
-        if (block_start_time > end_time) {
-            end_idx = j - 1;
-            break;
-        }
-        // ending point is in last block in segment
-        end_idx = j;
-    }
+    // find start block in start segment and stop block in stop segment
+    ui8 start_idx = find_segment_block(lookup, start_segment, start_time);
+	ui8 end_idx = find_segment_block(lookup, end_segment, end_time);
+	if (lookup == &local_lookup)	free_block_lookup(&local_lookup);
     
     // find total_samps and total_data_bytes, so we can allocate buffers
     si8 total_samps = 0;
@@ -305,7 +879,7 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 
         if (channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset < 1024){
             mexPrintf("Error: Invalid index file offset, exiting....\n");
-            return NULL;
+            return false;
         }
         
         // this loop will only run if there are segments in between the start and stop segments
@@ -318,7 +892,7 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 
             if (channel->segments[i].time_series_indices_fps->time_series_indices[0].file_offset < 1024){
                 mexPrintf("Error: Invalid index file offset, exiting....\n");
-                return NULL;
+                return false;
             }
         }
         
@@ -341,159 +915,106 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 
         if (channel->segments[end_segment].time_series_indices_fps->time_series_indices[end_idx].file_offset < 1024){
 			mexPrintf("Error: Invalid index file offset, exiting....\n");
-            return NULL;
+            return false;
         }
 		
 	}
 	
-    // allocate a buffer for the compressed data
-    ui1 *compressed_data_buffer = (ui1*) malloc((size_t) total_data_bytes);
-	if (compressed_data_buffer == NULL) {
-		mexPrintf("Error: could not allocated enough memory for the compressed data, exiting....\n");
-		return NULL;
-	}
-    ui1 *cdp = compressed_data_buffer;
+	// store the range
+	read->start_samp = start_samp;
+	read->end_samp = end_samp;
+	read->start_time = start_time;
+	read->end_time = end_time;
+	read->start_segment = start_segment;
+	read->end_segment = end_segment;
+	read->start_idx = start_idx;
+	read->end_idx = end_idx;
+	read->num_blocks = num_blocks;
+	read->total_data_bytes = total_data_bytes;
 	
-	// allocate the samples buffer
-    si4 *decomp_data = (si4*) malloc((size_t) (num_samps * sizeof(si4)));
-	if (decomp_data == NULL) {
-		free (compressed_data_buffer);
-		mexPrintf("Error: could not allocated enough memory for the sample buffer, exiting....\n");
-		return NULL;
+	return true;
+	
+}
+
+/**
+ * 	Read and decode the samples of a (prepared) range from a channel into a sample buffer
+ * 	
+ *	When a cache of decoded blocks is set on the read, blocks that are in the cache are copied from the cache (without
+ *	checking and decoding them again), and the blocks that are decoded are added to the cache.
+ *
+ *	Note: this function does not output any messages to matlab (these are added to the message field of the 
+ *        read struct instead) and can therefore also be called from other threads than the main (matlab) thread,
+ *        as long as no cache is set on the read (the cache is not thread-safe)
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ *	@param read                 Pointer to the struct that holds the range to read (as prepared by prepare_channel_read)
+ *	@param decomp_data          The sample buffer to decode into, should hold at least the number of samples in the range
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ * 	@return                     True if successful, false on failure
+ */
+bool read_channel_samples(CHANNEL *channel, CHANNEL_READ *read, si4 *decomp_data, si4 num_threads) {
+	ui8     i;
+	
+	// transfer the range to read
+	bool range_type			= read->range_type;
+	si8 start_samp			= read->start_samp;
+	si8 start_time			= read->start_time;
+	si8 end_time			= read->end_time;
+	ui8 num_samps			= read->num_samps;
+	ui4 start_segment		= read->start_segment;
+	ui8 start_idx			= read->start_idx;
+	ui8 num_blocks			= read->num_blocks;
+	ui4 max_samps			= channel->metadata.time_series_section_2->maximum_block_samples;
+	
+	// open the stream of compressed data
+	// (reads the first window of compressed data, and starts reading the next window in the background)
+	READ_STREAM stream;
+	if (!open_read_stream(&stream, channel, read, max_samps)) {
+		add_read_message(read, "Error: could not allocated enough memory for the compressed data, exiting....\n");
+		return false;
 	}
+    ui1 *cdp = stream.window_data;
 	
 	// initialize the entire sample buffer to nan
-	memset_int(decomp_data, RED_NAN, num_samps);
-	
-    // read in RED data
-    if (start_segment == end_segment) {
-		// normal case - everything is in one segment
-		
-        if (channel->segments[start_segment].time_series_data_fps->fp == NULL){
-            channel->segments[start_segment].time_series_data_fps->fp = fopen(channel->segments[start_segment].time_series_data_fps->full_file_name, "rb");
-			#ifdef _WIN32
-				channel->segments[start_segment].time_series_data_fps->fd = _fileno(channel->segments[start_segment].time_series_data_fps->fp);
-			#else
-				channel->segments[start_segment].time_series_data_fps->fd = fileno(channel->segments[start_segment].time_series_data_fps->fp);
-			#endif
-        }
-        FILE *fp = channel->segments[start_segment].time_series_data_fps->fp;
-        
-        #ifdef _WIN32
-            _fseeki64(fp, channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset, SEEK_SET);
-        #else
-            fseek(fp, channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset, SEEK_SET);
-        #endif
-        ui8 n_read = fread(cdp, sizeof(si1), (size_t) total_data_bytes, fp);
-        if (n_read != total_data_bytes) {
-			mexPrintf("Warning: read in fewer than expected bytes from data file in segment %d.\n", start_segment);
-		}
-        if (channel->segments[start_segment].time_series_data_fps->directives.close_file == MEF_TRUE)
-            fps_close(channel->segments[start_segment].time_series_data_fps);
-		
-    } else {
-		// spans across segments
-		
-		// start with first segment
-        if (channel->segments[start_segment].time_series_data_fps->fp == NULL){
-            channel->segments[start_segment].time_series_data_fps->fp = fopen(channel->segments[start_segment].time_series_data_fps->full_file_name, "rb");
-			#ifdef _WIN32
-				channel->segments[start_segment].time_series_data_fps->fd = _fileno(channel->segments[start_segment].time_series_data_fps->fp);
-			#else
-				channel->segments[start_segment].time_series_data_fps->fd = fileno(channel->segments[start_segment].time_series_data_fps->fp);
-			#endif
-        }
-        FILE *fp = channel->segments[start_segment].time_series_data_fps->fp;
-        #ifdef _WIN32
-             _fseeki64(fp, channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset, SEEK_SET);
-        #else
-            fseek(fp, channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset, SEEK_SET);
-        #endif
-        ui8 bytes_to_read = channel->segments[start_segment].time_series_data_fps->file_length -
-        channel->segments[start_segment].time_series_indices_fps->time_series_indices[start_idx].file_offset;
-        ui8 n_read = fread(cdp, sizeof(si1), (size_t) bytes_to_read, fp);
-        if (n_read != bytes_to_read) {
-			mexPrintf("Warning: read in fewer than expected bytes from data file in segment %d.\n", start_segment);
-        }
-        cdp += n_read;
-        if (channel->segments[start_segment].time_series_data_fps->directives.close_file == MEF_TRUE)
-            fps_close(channel->segments[start_segment].time_series_data_fps);
-        
-        // this loop will only run if there are segments in between the start and stop segments
-        for (i = (start_segment + 1); i <= (end_segment - 1); i++) {
-            if (channel->segments[i].time_series_data_fps->fp == NULL){
-                channel->segments[i].time_series_data_fps->fp = fopen(channel->segments[i].time_series_data_fps->full_file_name, "rb");
-				#ifdef _WIN32
-					channel->segments[i].time_series_data_fps->fd = _fileno(channel->segments[i].time_series_data_fps->fp);
-				#else
-					channel->segments[i].time_series_data_fps->fd = fileno(channel->segments[i].time_series_data_fps->fp);
-				#endif
-            }
-            fp = channel->segments[i].time_series_data_fps->fp;
-            fseek(fp, UNIVERSAL_HEADER_BYTES, SEEK_SET);
-            bytes_to_read = channel->segments[i].time_series_data_fps->file_length - 
-            channel->segments[i].time_series_indices_fps->time_series_indices[0].file_offset;
-            n_read = fread(cdp, sizeof(si1), (size_t) bytes_to_read, fp);
-            if (n_read != bytes_to_read) {
-				mexPrintf("Warning: read in fewer than expected bytes from data file in segment %d.\n", i);
-            }
-            cdp += n_read;
-            if (channel->segments[i].time_series_data_fps->directives.close_file == MEF_TRUE)
-                fps_close(channel->segments[i].time_series_data_fps);
-        }
-        
-        // then last segment
-        if (channel->segments[end_segment].time_series_data_fps->fp == NULL){
-            channel->segments[end_segment].time_series_data_fps->fp = fopen(channel->segments[end_segment].time_series_data_fps->full_file_name, "rb");
-			#ifdef _WIN32
-				channel->segments[end_segment].time_series_data_fps->fd = _fileno(channel->segments[end_segment].time_series_data_fps->fp);
-			#else
-				channel->segments[end_segment].time_series_data_fps->fd = fileno(channel->segments[end_segment].time_series_data_fps->fp);
-			#endif
-        }
-        num_block_in_segment = channel->segments[end_segment].metadata_fps->metadata.time_series_section_2->number_of_blocks;
-        if (end_idx < (ui8) (channel->segments[end_segment].metadata_fps->metadata.time_series_section_2->number_of_blocks - 1)) {
-            fp = channel->segments[end_segment].time_series_data_fps->fp;
-            fseek(fp, UNIVERSAL_HEADER_BYTES, SEEK_SET);
-            bytes_to_read = channel->segments[end_segment].time_series_indices_fps->time_series_indices[end_idx+1].file_offset -
-            channel->segments[end_segment].time_series_indices_fps->time_series_indices[0].file_offset;
-            n_read = fread(cdp, sizeof(si1), (size_t) bytes_to_read, fp);
-            if (n_read != bytes_to_read) {
-				mexPrintf("Warning: read in fewer than expected bytes from data file in segment %d.\n", end_segment);
-            }
-            cdp += n_read;
-        } else {
-            // case where end_idx is last block in segment
-            fp = channel->segments[end_segment].time_series_data_fps->fp;
-            fseek(fp, UNIVERSAL_HEADER_BYTES, SEEK_SET);
-            bytes_to_read = channel->segments[end_segment].time_series_data_fps->file_length -
-            channel->segments[end_segment].time_series_indices_fps->time_series_indices[0].file_offset;
-            n_read = fread(cdp, sizeof(si1), (size_t) bytes_to_read, fp);
-            if (n_read != bytes_to_read) {
-				mexPrintf("Warning: read in fewer than expected bytes from data file in segment %d.\n", end_segment);
-            }
-            cdp += n_read;
-        }
-
-        if (channel->segments[end_segment].time_series_data_fps->directives.close_file == MEF_TRUE)
-            fps_close(channel->segments[end_segment].time_series_data_fps);
-
-
-	}
-	
-    // set up RED processing struct
-    cdp = compressed_data_buffer;
-	ui4 max_samps = channel->metadata.time_series_section_2->maximum_block_samples;
+	// (not needed for sample ranges into an initialized buffer, a sample range does not have gaps)
+	if (range_type == RANGE_BY_TIME || !read->output_initialized)
+		memset_int(decomp_data, RED_NAN, num_samps);
 	
+    // prepare the keys to decrypt encrypted blocks with (the password data is shared by the segments)
+    BLOCK_DECRYPTION decryption;
+    prepare_block_decryption(&decryption, channel->segments[read->start_segment].metadata_fps->password_data);
+    
+    // the buffers that are freed when the read ends (whether successful or not)
+    bool success = false;
+    si4 *temp_data_buf = NULL;
+    DECODE_BLOCK *planned_blocks = NULL;
+    
     // create RED processing struct
     RED_PROCESSING_STRUCT *rps = (RED_PROCESSING_STRUCT *) calloc((size_t) 1, sizeof(RED_PROCESSING_STRUCT));
+    if (rps == NULL) {
+        add_read_message(read, "Error: could not allocated enough memory for the RED processing struct, exiting....\n");
+        goto cleanup;
+    }
     rps->compression.mode = RED_DECOMPRESSION;
     rps->decompressed_ptr = rps->decompressed_data = decomp_data;
-    rps->difference_buffer = (si1 *) e_calloc((size_t) RED_MAX_DIFFERENCE_BYTES(max_samps) + 1, sizeof(ui1), __FUNCTION__, __LINE__, USE_GLOBAL_BEHAVIOR);
-    
-    // reset the pointer back to the start of the array
-    cdp = compressed_data_buffer;
+    rps->difference_buffer = (si1 *) calloc((size_t) RED_MAX_DIFFERENCE_BYTES(max_samps) + 1, sizeof(ui1));
+    if (rps->difference_buffer == NULL) {
+        add_read_message(read, "Error: could not allocated enough memory for the difference buffer, exiting....\n");
+        goto cleanup;
+    }
     
+	// the cache of decoded blocks (decoded blocks are only added if the range fits well within the cache, so
+	// that long reads do not push out the blocks that are more likely to be revisited)
+	BLOCK_CACHE *cache = read->cache;
+	bool add_to_cache = (cache != NULL && num_samps * sizeof(si4) <= cache->capacity / 2);
+	ui8 channel_id = (cache != NULL) ? block_cache_channel_id(channel) : 0;
+	BLOCK_CACHE_KEY cache_key;
+	si4 *cached = NULL;
+	
+	// the segment and index (in the segment) of the block at the current position in the compressed data
+	ui4 block_segment = start_segment;
+	ui8 block_idx = start_idx;
+	
 	// 
 	si8 sample_counter = 0;
 	si8 offset_into_output_buffer;
@@ -502,33 +1023,45 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 	//
 	// decode the first block
 	// 
-    si4 *temp_data_buf = (int *) malloc((max_samps * 1.1) * sizeof(si4));
+    temp_data_buf = (si4 *) malloc((max_samps * 1.1) * sizeof(si4));
     if (temp_data_buf == NULL) {
-        free (compressed_data_buffer);
-        free (decomp_data);
-        mexPrintf("Error: could not allocated enough memory for the block buffer, exiting....\n");
-        return NULL;
+        add_read_message(read, "Error: could not allocated enough memory for the block buffer, exiting....\n");
+        goto cleanup;
     }
     rps->decompressed_ptr = rps->decompressed_data = temp_data_buf;
     rps->compressed_data = cdp;
     rps->block_header = (RED_BLOCK_HEADER *) rps->compressed_data;
-    if (!check_block_crc((ui1 *)(rps->block_header), max_samps, compressed_data_buffer, total_data_bytes)) {
+	if (cache != NULL && check_block_bounds(cdp, max_samps, stream.window_data, stream.window_bytes)) {
+		set_block_cache_key(&cache_key, channel_id, channel, block_segment, (ui4) block_idx, decryption.access_level);
+		cached = find_cached_block(cache, &cache_key, read->validate_crc, rps->block_header->number_of_samples, add_to_cache);
+	}
+    if (!check_block((ui1 *)(rps->block_header), max_samps, stream.window_data, stream.window_bytes, read->validate_crc && cached == NULL)) {
 		// incorrect crc
 		
 		// message
-		mexPrintf("Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", start_idx);
+		add_read_message(read, "Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", start_idx);
 
 		//
-        free (compressed_data_buffer);
-        free (decomp_data);
-        free (temp_data_buf);
-        return NULL;
+        goto cleanup;
 		
     }
 
-	// 
-	RED_decode(rps);
+	// decode the block (or copy it from the cache)
+	if (cached != NULL) {
+		copy_cached_block(rps, &read->context, cached);
+	} else {
+		if (!decode_red_block(rps, &read->context, &decryption)) {
+			if (rps->directives.encryption_level > NO_ENCRYPTION)
+				add_read_message(read, "Error: no access to the encrypted data of RED block %lu, exiting...\n", start_idx);
+			else
+				add_read_message(read, "Error: RED block %lu has invalid statistics, data likely corrupt...\n", start_idx);
+			goto cleanup;
+		}
+		if (add_to_cache)
+			cache_block(cache, &cache_key, rps->decompressed_ptr, rps->block_header->number_of_samples, read->validate_crc);
+	}
 	cdp += rps->block_header->block_bytes;
+	next_segment_block(channel, &block_segment, &block_idx);
 	
 	// 
 	if (range_type == RANGE_BY_TIME) {
@@ -564,103 +1097,196 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
 	//
     // decode blocks in between the first and the last
 	//
+	// The blocks in between are first planned by walking the block headers (sequentially, since the position
+	// of each block depends on the size of the previous), which determines where each block should be decoded
+	// to. The planned blocks are then decoded (optionally in parallel) straight into the output buffer. The plan
+	// is decoded whenever it is full or before the window of compressed data moves on to the next window
+	//
+	
+	// allocate the plan
+	ui8 num_planned = 0;
+	ui8 plan_capacity = (num_blocks > 2) ? num_blocks - 2 : 0;
+	if (plan_capacity > READ_PLAN_BLOCKS)	plan_capacity = READ_PLAN_BLOCKS;
+	if (plan_capacity > 0) {
+		planned_blocks = (DECODE_BLOCK *) malloc((size_t) plan_capacity * sizeof(DECODE_BLOCK));
+		if (planned_blocks == NULL) {
+			add_read_message(read, "Error: could not allocated enough memory for the block plan, exiting....\n");
+			goto cleanup;
+		}
+	}
+	
+	// plan the blocks
+	bool planned_in_order = true;
+	bool decoded = true;
+	si8 failed_block = -1;
+	bool no_access = false;
+	si4 *prev_block_end = NULL;
 	for (i = 1; i < num_blocks - 1; i++) {
 		
+		// decode the plan when it is full, or when the block is not (entirely) in the window of compressed data
+		// (in which case the window is moved, after decoding, so that the block is)
+		bool block_in_window = read_window_contains_block(&stream, cdp);
+		if (num_planned == plan_capacity || !block_in_window) {
+			decoded = decode_blocks(planned_blocks, num_planned, max_samps, stream.window_data, stream.window_bytes, read->validate_crc, &read->context, &decryption, (planned_in_order ? num_threads : 1), &failed_block, &no_access);
+			if (!decoded)	break;
+			if (add_to_cache && planned_in_order)
+				cache_decoded_blocks(cache, planned_blocks, num_planned, channel, channel_id, decryption.access_level, read->validate_crc);
+			num_planned = 0;
+			planned_in_order = true;
+			
+			if (!block_in_window)
+				cdp = advance_read_window(&stream, cdp);
+			
+		}
+		
 		// 
-        rps->compressed_data = cdp;
-        rps->block_header = (RED_BLOCK_HEADER *) rps->compressed_data;
-        // check that block fits fully within output array
-        // this should be true, but it's possible a stray block exists out-of-order, or with a bad timestamp
-        
-        // we need to manually remove offset, since we are using the time value of the block before decoding the block
-        // (normally the offset is removed during the decoding process)
-        if ((rps->block_header->block_bytes == 0) || !check_block_crc((ui1*)(rps->block_header), max_samps, compressed_data_buffer, total_data_bytes)) {
-			// incorrect crc
-						
+		RED_BLOCK_HEADER *block_header = (RED_BLOCK_HEADER *) cdp;
+		
+		// check that the block fits within the compressed data (the CRC is checked upon decoding)
+		if ((block_header->block_bytes == 0) || !check_block_bounds(cdp, max_samps, stream.window_data, stream.window_bytes)) {
+			// invalid block
+			
 			// message
-			mexPrintf("Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", start_idx + i);
+			add_read_message(read, "Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", block_idx);
 
 			//
-			free (compressed_data_buffer);
-			free (decomp_data);
-			free (temp_data_buf);
-			return NULL;
+			goto cleanup;
 			
-        }
+		}
 		
+		// add the block to the plan (without output, so by default the block is only checked)
+		DECODE_BLOCK *planned_block = &planned_blocks[num_planned++];
+		planned_block->block = cdp;
+		planned_block->output = NULL;
+		planned_block->cached = NULL;
+		planned_block->segment = block_segment;
+		planned_block->block_index = block_idx;
+		
+		// check that block fits fully within output array
+		// this should be true, but it's possible a stray block exists out-of-order, or with a bad timestamp
 		if (range_type == RANGE_BY_TIME) {
-			block_start_time_offset = rps->block_header->start_time;
-			remove_recording_time_offset(&block_start_time_offset);
+			
+			// we need to manually remove offset, since we are using the time value of the block before decoding the block
+			// (normally the offset is removed during the decoding process)
+			block_start_time_offset = block_header->start_time;
+			remove_context_time_offset(&read->context, &block_start_time_offset);
 			
 			// The next two checks see if the block contains out-of-bounds samples.
 			// In that case, skip the block and move on
 			if (block_start_time_offset < start_time) {
-				cdp += rps->block_header->block_bytes;
+				cdp += block_header->block_bytes;
+				next_segment_block(channel, &block_segment, &block_idx);
 				continue;
 			}
-			if (block_start_time_offset + ((rps->block_header->number_of_samples / channel->metadata.time_series_section_2->sampling_frequency) * 1e6) >= end_time) {
+			if (block_start_time_offset + ((block_header->number_of_samples / channel->metadata.time_series_section_2->sampling_frequency) * 1e6) >= end_time) {
+				// the pointer is not moved to the next block, so the remaining blocks in between will not be decoded
+				// and this block will be handled as the last block
 				// Comment this out for now, it creates a strange boundary condition
-				// cdp += rps->block_header->block_bytes;
-				continue;
+				// cdp += block_header->block_bytes;
+				break;
 			}
 			
-			rps->decompressed_ptr = rps->decompressed_data = decomp_data + (int)((((block_start_time_offset - start_time) / 1000000.0) * channel->metadata.time_series_section_2->sampling_frequency) + 0.5);
+			planned_block->output = decomp_data + (int)((((block_start_time_offset - start_time) / 1000000.0) * channel->metadata.time_series_section_2->sampling_frequency) + 0.5);
 			
 		} else {
 			
 			// buffer overflow check
-			if ((sample_counter + rps->block_header->number_of_samples) > num_samps) {
+			if ((sample_counter + block_header->number_of_samples) > num_samps) {
 	
 				// message
 				// TODO: better fix for buffer overflow, should not happen
-				mexPrintf("Error: buffer overflow prevented, this should be fixed in the code\n");
+				add_read_message(read, "Error: buffer overflow prevented, this should be fixed in the code\n");
 
 				//
-				free (compressed_data_buffer);
-				free (decomp_data);
-				free (temp_data_buf);
-				return NULL;				
+				goto cleanup;
 			
 			}
 			
 			// 
-			rps->decompressed_ptr = rps->decompressed_data = decomp_data + sample_counter;
+			planned_block->output = decomp_data + sample_counter;
+		}
+		
+		// blocks that overlap (e.g. because of bad timestamps) depend on the order in which they are decoded
+		if (prev_block_end != NULL && planned_block->output < prev_block_end)
+			planned_in_order = false;
+		prev_block_end = planned_block->output + block_header->number_of_samples;
+		
+		// copy the block from the cache if it is there
+		if (cache != NULL) {
+			set_block_cache_key(&cache_key, channel_id, channel, block_segment, (ui4) block_idx, decryption.access_level);
+			planned_block->cached = find_cached_block(cache, &cache_key, read->validate_crc, block_header->number_of_samples, add_to_cache);
 		}
 		
 		// 
-		RED_decode(rps);
-		sample_counter += rps->block_header->number_of_samples;
+		sample_counter += block_header->number_of_samples;
+        cdp += block_header->block_bytes;
+		next_segment_block(channel, &block_segment, &block_idx);
+		
+    }
+	
+	// decode the remaining planned blocks (sequentially when the order of decoding matters)
+	if (decoded)
+		decoded = decode_blocks(planned_blocks, num_planned, max_samps, stream.window_data, stream.window_bytes, read->validate_crc, &read->context, &decryption, (planned_in_order ? num_threads : 1), &failed_block, &no_access);
+	if (decoded && add_to_cache && planned_in_order)
+		cache_decoded_blocks(cache, planned_blocks, num_planned, channel, channel_id, decryption.access_level, read->validate_crc);
+	if (!decoded) {
+		
+		// message
+		if (failed_block >= 0 && no_access)
+			add_read_message(read, "Error: no access to the encrypted data of RED block %lu, exiting...\n", failed_block);
+		else if (failed_block >= 0)
+			add_read_message(read, "Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", failed_block);
+		else
+			add_read_message(read, "Error: could not allocated enough memory for decoding, exiting....\n");
 
 		//
-        cdp += rps->block_header->block_bytes;
+		goto cleanup;
 		
-    }	
+	}
 	
 	// 
 	// decode last block to temp array
 	// 	
     if (num_blocks > 1) {
 		
+		// make sure the block is in the window of compressed data
+		if (!read_window_contains_block(&stream, cdp))
+			cdp = advance_read_window(&stream, cdp);
+		
 		//
         rps->compressed_data = cdp;
         rps->block_header = (RED_BLOCK_HEADER *) rps->compressed_data;
         rps->decompressed_ptr = rps->decompressed_data = temp_data_buf;
-        if (!check_block_crc((ui1*)(rps->block_header), max_samps, compressed_data_buffer, total_data_bytes)) {
+		cached = NULL;
+		if (cache != NULL && check_block_bounds(cdp, max_samps, stream.window_data, stream.window_bytes)) {
+			set_block_cache_key(&cache_key, channel_id, channel, block_segment, (ui4) block_idx, decryption.access_level);
+			cached = find_cached_block(cache, &cache_key, read->validate_crc, rps->block_header->number_of_samples, add_to_cache);
+		}
+        if (!check_block((ui1*)(rps->block_header), max_samps, stream.window_data, stream.window_bytes, read->validate_crc && cached == NULL)) {
 			// incorrect crc
 			
 			// message
-			mexPrintf("Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", start_idx + i);
+			add_read_message(read, "Error: RED block %lu has 0 bytes, or CRC failed, data likely corrupt...\n", block_idx);
 
 			//
-			free(compressed_data_buffer);
-			free(decomp_data);
-			free(temp_data_buf);
-			return NULL;
+			goto cleanup;
 			
         }
 		
-		// 
-        RED_decode(rps);
+		// decode the block (or copy it from the cache)
+		if (cached != NULL) {
+			copy_cached_block(rps, &read->context, cached);
+		} else {
+			if (!decode_red_block(rps, &read->context, &decryption)) {
+				if (rps->directives.encryption_level > NO_ENCRYPTION)
+					add_read_message(read, "Error: no access to the encrypted data of RED block %lu, exiting...\n", block_idx);
+				else
+					add_read_message(read, "Error: RED block %lu has invalid statistics, data likely corrupt...\n", block_idx);
+				goto cleanup;
+			}
+			if (add_to_cache)
+				cache_block(cache, &cache_key, rps->decompressed_ptr, rps->block_header->number_of_samples, read->validate_crc);
+		}
         
 		// 
         if (range_type == RANGE_BY_TIME) {
@@ -689,165 +1315,2382 @@ mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 ra
         }
 		
     }
-    
+	
 	// 
-    // Decompressed data are integers (si4) and represent the "real" data; Integers technically do not have a NaN value as it exists for float datatypes.
-    // Internally a si4 emulated NaN value ('RED_NAN') is used, however this value is not standard for Matlab (or Python)
-    //
-    // When range is indicated in time, then gaps/discontinuities in the data need to be filled with NaNs. Therefore, we return
-    // the data as doubles. Integer to float cannot by byte-copied, therefore it needs to be cast per element, which is slow.
-    //
-    // TODO: could be speed up by directly casting or copying the values in the above loops to the matlab array; or
-    //       when the range is indicated in samples, no nans exist, so we could allocate a matlab int array at the
-    //       start and read data directly into that (above loops)
-    //
-    
-	// allocate matlab double array
-    // using doubles so we can use NaN values for discontinuities (when range is indicated in time)
-	mxArray *mat_array = mxCreateDoubleMatrix(1, num_samps, mxREAL);
-	mxDouble *ptr_mat_array = mxGetPr(mat_array);
-    
-    // copy/cast the data to the matlab array
-	mxDouble mxNaN = mxGetNaN();
-    for (i = 0; i < num_samps; i++) {
-        if (*(decomp_data + i) == RED_NAN)
-			*(ptr_mat_array + i) = mxNaN;
-        else
-            *(ptr_mat_array + i) = (sf8) *(decomp_data + i);
-    }
-    
-    // free the memory holding the compressed data
-    free (decomp_data);
+	success = true;
+	
+cleanup:
+	
+    // close the stream and free the memory holding the compressed data and the buffers
+    close_read_stream(&stream, read);
     free (temp_data_buf);
-    free (compressed_data_buffer);
-    free (rps->difference_buffer);
-    free (rps);
-	
-    // apply conversion factor
-    // TODO: might apply above, so data is only moved/manipulated once. But
-    //       this conversion hardly takes any time, so it is good for now
-    if (apply_conv_factor) {
-        double fac = channel->metadata.time_series_section_2->units_conversion_factor;
-        double *pData = mxGetPr(mat_array);
-        double *pEndData = pData + mxGetNumberOfElements(mat_array);
-        for(; pData < pEndData ; pData++) {
-            *pData = fac * *pData;
-        }
+    free (planned_blocks);
+    if (rps != NULL) {
+        free (rps->difference_buffer);
+        free (rps);
     }
-    
-	// return the data
-	return mat_array;
+	
+	// return whether successful
+	return success;
 	
 }
 
+/**
+ * 	Advance to the next block in the segments of a channel (the first block of the next segment after the last block of a segment)
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param segment              Pointer to the index of the segment, updated to the segment of the next block
+ * 	@param block                Pointer to the index of the block in the segment, updated to the index of the next block
+ */
+void next_segment_block(CHANNEL *channel, ui4 *segment, ui8 *block) {
+	(*block)++;
+	if (*block >= (ui8) channel->segments[*segment].metadata_fps->metadata.time_series_section_2->number_of_blocks && 
+		*segment + 1 < (ui4) channel->number_of_segments) {
+		(*segment)++;
+		*block = 0;
+	}
+}
 
-si8 sample_for_uutc_c(si8 uutc, CHANNEL *channel) {
-    ui8 i, j, sample;
-    sf8 native_samp_freq;
-    ui8 prev_sample_number;
-    si8 prev_time, seg_start_sample;
-	si8 next_sample_number;
-    
-    native_samp_freq = channel->metadata.time_series_section_2->sampling_frequency;
-    prev_sample_number = channel->segments[0].metadata_fps->metadata.time_series_section_2->start_sample;
-    prev_time = channel->segments[0].time_series_indices_fps->time_series_indices[0].start_time;
-    
-    for (j = 0; j < channel->number_of_segments; j++) {
-        seg_start_sample = channel->segments[j].metadata_fps->metadata.time_series_section_2->start_sample;
-		
-		// initialize next_sample_number to end of current segment, in case we're on the last segment and we
-        // go all the way to the end of the segment. Otherwise this value will get overridden later on
-        next_sample_number = seg_start_sample + channel->segments[j].metadata_fps->metadata.time_series_section_2->number_of_samples;
-		
-        for (i = 0; i < channel->segments[j].metadata_fps->metadata.time_series_section_2->number_of_blocks; ++i) {
-            if (channel->segments[j].time_series_indices_fps->time_series_indices[i].start_time > uutc) {
-				next_sample_number = channel->segments[j].time_series_indices_fps->time_series_indices[i].start_sample + seg_start_sample;
-                goto done;
-			}
-            prev_sample_number = channel->segments[j].time_series_indices_fps->time_series_indices[i].start_sample + seg_start_sample;
-            prev_time = channel->segments[j].time_series_indices_fps->time_series_indices[i].start_time;
-        }
-    }
-    
-done:
-    sample = prev_sample_number + (ui8) (((((sf8) (uutc - prev_time)) / 1000000.0) * native_samp_freq) + 0.5);
-    if (sample > next_sample_number)
-        sample = next_sample_number;  // prevent it from going too far
+/**
+ * 	Add the (decoded) planned blocks that were not copied from the cache to the cache of decoded blocks
+ *
+ *	Note: the outputs of the blocks should not overlap (the blocks were decoded in order), otherwise the
+ *	      output of a block could have been (partially) overwritten by another block
+ *
+ * 	@param cache                Pointer to the cache
+ * 	@param blocks               The planned (and decoded) blocks
+ * 	@param num_blocks           The number of planned blocks
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param channel_id           The identifier of the channel in the cache
+ * 	@param access_level         The access level of the password that the blocks were decoded with
+ * 	@param validated            Whether the CRCs of the blocks were validated
+ */
+void cache_decoded_blocks(BLOCK_CACHE *cache, DECODE_BLOCK *blocks, ui8 num_blocks, CHANNEL *channel, ui8 channel_id, si1 access_level, bool validated) {
+	ui8					i;
+	BLOCK_CACHE_KEY		key;
+	
+	for (i = 0; i < num_blocks; i++) {
+		if (blocks[i].output == NULL || blocks[i].cached != NULL)	continue;
+		set_block_cache_key(&key, channel_id, channel, blocks[i].segment, (ui4) blocks[i].block_index, access_level);
+		cache_block(cache, &key, blocks[i].output, ((RED_BLOCK_HEADER *) blocks[i].block)->number_of_samples, validated);
+	}
 	
-    return(sample);
 }
 
+/**
+ * 	Open a stream of the compressed data in the range to read. The stream is read in windows of (at most) 
+ *	READ_WINDOW_BYTES, using two buffers: while the blocks in one window are decoded, the next window is
+ *	read in the background into the other buffer. The memory that is needed for the compressed data is
+ *	therefore bounded, regardless of the length of the range.
+ *
+ *	The data of the segments is streamed as if it were concatenated; the first window is read upon opening.
+ *	Where available (Linux), the data files are memory-mapped instead, and each segment is a window that
+ *	points straight into the mapping (so that repeated reads are served from the page cache without copying).
+ *	When the data of the range was read beforehand (see preload_channel_reads), the stream is a single window of that data.
+ *
+ * 	@param stream               Pointer to the stream struct to initialize
+ * 	@param channel              Pointer to the MEF channel object
+ *	@param read                 Pointer to the struct that holds the range to read (as prepared by prepare_channel_read)
+ * 	@param max_samps            The maximum number of samples in a block of the channel
+ * 	@return                     True if successful, false on failure (memory allocation)
+ */
+bool open_read_stream(READ_STREAM *stream, CHANNEL *channel, CHANNEL_READ *read, ui4 max_samps) {
+	
+	memset(stream, 0, sizeof(READ_STREAM));
+	stream->channel = channel;
+	stream->readahead = read->readahead;
+	stream->max_block_bytes = RED_MAX_COMPRESSED_BYTES(max_samps, 1);
+	
+	// the pieces of the segment data files that make up the stream
+	if (!set_read_stream_pieces(stream, channel, read))
+		return false;
+	
+	// the data was read beforehand, the stream is a single window of it
+	if (read->preloaded != NULL) {
+		stream->window_data = read->preloaded;
+		stream->window_bytes = stream->total_bytes;
+		stream->next_pos = stream->total_bytes;
+		return true;
+	}
+	
+	// wait for the data that is read ahead (if it holds the start of the stream, the data is read in windows so
+	// that the data that was read ahead is copied instead of being read)
+	bool read_ahead = false;
+	if (stream->readahead != NULL) {
+		wait_for_readahead(stream->readahead);
+		read_ahead = readahead_holds(stream->readahead, stream->pieces[0].segment, stream->pieces[0].file_offset);
+	}
+	
+	// try to memory-map the data files
+	#ifdef MATMEF_MMAP
+		if (!read_ahead && map_read_stream(stream)) {
+			stream->mapped = true;
+			stream->current_piece = 0;
+			stream->window_data = stream->pieces[0].data;
+			stream->window_bytes = stream->pieces[0].bytes;
+			stream->next_pos = stream->window_bytes;
+			stream->prefetch_pending = (stream->num_pieces > 1);
+			return true;
+		}
+	#endif
+	
+	// determine the size of the windows (each window should at least be able to hold a few blocks)
+	stream->window_size = READ_WINDOW_BYTES;
+	if (stream->window_size < 4 * stream->max_block_bytes)		stream->window_size = 4 * stream->max_block_bytes;
+	if (stream->window_size > stream->total_bytes)				stream->window_size = stream->total_bytes;
+	
+	// allocate the buffers, with room in front for a block that is carried over from the previous window
+	// (a second buffer is only needed if the data does not fit in a single window)
+	ui8 buffer_bytes = stream->max_block_bytes + stream->window_size;
+	stream->buffers[0] = (ui1 *) malloc((size_t) buffer_bytes);
+	if (stream->total_bytes > stream->window_size)
+		stream->buffers[1] = (ui1 *) malloc((size_t) buffer_bytes);
+	if (stream->buffers[0] == NULL || (stream->total_bytes > stream->window_size && stream->buffers[1] == NULL)) {
+		free (stream->buffers[0]);
+		free (stream->buffers[1]);
+		free (stream->pieces);
+		return false;
+	}
+	
+	// read the first window
+	stream->window_data = stream->buffers[0] + stream->max_block_bytes;
+	stream->window_bytes = stream->window_size;
+	read_stream_data(stream, 0, stream->window_data, stream->window_bytes);
+	stream->next_pos = stream->window_bytes;
+	
+	// start reading the next window
+	start_read_window(stream);
+	
+	return true;
+	
+}
 
-si8 uutc_for_sample_c(si8 sample, CHANNEL *channel) {
-    ui8 i, j, uutc;
-    sf8 native_samp_freq;
-    ui8 prev_sample_number;
-    si8 prev_time, seg_start_sample;
-    
-    
-    native_samp_freq = channel->metadata.time_series_section_2->sampling_frequency;
-    prev_sample_number = channel->segments[0].metadata_fps->metadata.time_series_section_2->start_sample;
-    prev_time = channel->segments[0].time_series_indices_fps->time_series_indices[0].start_time;
-    
-    for (j = 0; j < channel->number_of_segments; j++) {
-        seg_start_sample = channel->segments[j].metadata_fps->metadata.time_series_section_2->start_sample;
-        for (i = 0; i < channel->segments[j].metadata_fps->metadata.time_series_section_2->number_of_blocks; ++i){
-            if (channel->segments[j].time_series_indices_fps->time_series_indices[i].start_sample + seg_start_sample > sample)
-                goto done;
-            prev_sample_number = channel->segments[j].time_series_indices_fps->time_series_indices[i].start_sample + seg_start_sample;
-            prev_time = channel->segments[j].time_series_indices_fps->time_series_indices[i].start_time;
-        }
-    }
-    
-done:
-    uutc = prev_time + (ui8) ((((sf8) (sample - prev_sample_number) / native_samp_freq) * 1000000.0) + 0.5);
-    
-    return(uutc);
+/**
+ * 	Determine the pieces of the segment data files that make up the stream of a range to read (the first segment from
+ *	the start block, segments in between whole, and the last segment up to the end block)
+ *
+ * 	@param stream               Pointer to the stream struct, of which the pieces and the total number of bytes are set
+ * 	@param channel              Pointer to the MEF channel object
+ *	@param read                 Pointer to the struct that holds the range to read (as prepared by prepare_channel_read)
+ * 	@return                     True if successful, false on failure (memory allocation)
+ */
+bool set_read_stream_pieces(READ_STREAM *stream, CHANNEL *channel, CHANNEL_READ *read) {
+	ui4		i;
+	
+	stream->total_bytes = 0;
+	stream->num_pieces = read->end_segment - read->start_segment + 1;
+	stream->pieces = (READ_STREAM_PIECE *) calloc((size_t) stream->num_pieces, sizeof(READ_STREAM_PIECE));
+	if (stream->pieces == NULL)
+		return false;
+	for (i = 0; i < stream->num_pieces; i++) {
+		READ_STREAM_PIECE *piece = &stream->pieces[i];
+		SEGMENT *segment = &channel->segments[read->start_segment + i];
+		TIME_SERIES_INDEX *indices = segment->time_series_indices_fps->time_series_indices;
+		ui8 number_of_blocks = (ui8) segment->metadata_fps->metadata.time_series_section_2->number_of_blocks;
+		
+		piece->segment = read->start_segment + i;
+		piece->file_offset = (i == 0) ? (ui8) indices[read->start_idx].file_offset : UNIVERSAL_HEADER_BYTES;
+		if (i == stream->num_pieces - 1 && read->end_idx < number_of_blocks - 1)
+			piece->bytes = (ui8) indices[read->end_idx + 1].file_offset - ((i == 0) ? (ui8) indices[read->start_idx].file_offset : (ui8) indices[0].file_offset);
+		else
+			piece->bytes = (ui8) segment->time_series_data_fps->file_length - ((i == 0) ? (ui8) indices[read->start_idx].file_offset : (ui8) indices[0].file_offset);
+		piece->stream_offset = stream->total_bytes;
+		stream->total_bytes += piece->bytes;
+		
+	}
+	
+	return true;
+	
 }
 
-void memset_int(si4 *ptr, si4 value, size_t num) {
-    si4 *temp_ptr;
-    
-    if (num < 1)
-        return;
-    
-	si4 *limit = ptr + num;
-    for (temp_ptr = ptr; temp_ptr < limit; ++temp_ptr)
-		*temp_ptr = value;
+/**
+ * 	Read the compressed data of the ranges of multiple channels beforehand, in a single batch
+ *
+ *	All byte ranges of all channels (and segments) are read by a pool of threads at once (see preload_read_streams), so
+ *	that many reads are in flight, instead of each channel streaming its own data files one read at a time. The data of
+ *	each read is set as its preloaded data. If the data of all channels together is larger than READ_BATCH_MAX_BYTES,
+ *	when reading single-threaded, or on failure, nothing is preloaded and the channels stream their data as usual.
+ *
+ *	Note: the preloaded data of the reads should be freed by the caller
+ *
+ * 	@param channels             Array of (num_channels) pointers to the MEF channel objects
+ * 	@param reads                Array of (num_channels) ranges to read (as prepared by prepare_channel_read)
+ * 	@param num_channels         The number of channels
+ * 	@param num_threads          The number of threads to read the batch with (1 = no preload; 0 = one per processor)
+ */
+void preload_channel_reads(CHANNEL **channels, CHANNEL_READ *reads, si4 num_channels, si4 num_threads) {
+	si4				i;
+	ui4				p;
+	bool			success = true;
+	
+	// determine the pieces of the data files of each channel
+	READ_STREAM *streams = (READ_STREAM *) calloc((size_t) num_channels, sizeof(READ_STREAM));
+	ui1 **preloaded = (ui1 **) calloc((size_t) num_channels, sizeof(ui1 *));
+	if (streams == NULL || preloaded == NULL) {
+		free (streams);
+		free (preloaded);
+		return;
+	}
+	for (i = 0; i < num_channels && success; i++) {
+		if (reads[i].num_samps == 0)	continue;
+		success = set_read_stream_pieces(&streams[i], channels[i], &reads[i]);
+	}
+	
+	// read the data of all channels
+	if (success && preload_read_streams(channels, streams, preloaded, (ui8) num_channels, num_threads)) {
+		for (i = 0; i < num_channels; i++) {
+			reads[i].preloaded = preloaded[i];
+			for (p = 0; p < streams[i].num_pieces; p++)
+				if (streams[i].pieces[p].short_read)
+					add_read_message(&reads[i], "Warning: read in fewer than expected bytes from data file in segment %d.\n", streams[i].pieces[p].segment);
+		}
+	}
+	
+	// 
+	for (i = 0; i < num_channels; i++)
+		free (streams[i].pieces);
+	free (streams);
+	free (preloaded);
 	
 }
 
-si4 check_block_crc(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes) {
-    ui8 offset_into_data, remaining_buf_size;
-    si1 CRC_valid;
-    RED_BLOCK_HEADER *block_header;
-    
-    offset_into_data = block_hdr_ptr - total_data_ptr;
-    remaining_buf_size = total_data_bytes - offset_into_data;
-    
-    // check if remaining buffer at least contains the RED block header
-    if (remaining_buf_size < RED_BLOCK_HEADER_BYTES)
-        return 0;
-    
-    block_header = (RED_BLOCK_HEADER*) block_hdr_ptr;
-    
-    // check if entire block, based on size specified in header, can possibly fit in the remaining buffer
-    if (block_header->block_bytes > remaining_buf_size)
-        return 0;
-    
-    // check if size specified in header is absurdly large
-    if (block_header->block_bytes > RED_MAX_COMPRESSED_BYTES(max_samps, 1))
-        return 0;
-    
-    // at this point we know we have enough data to actually run the CRC calculation, so do it
-    CRC_valid = CRC_validate((ui1*) block_header + CRC_BYTES, block_header->block_bytes - CRC_BYTES, block_header->block_CRC);
-    
-    // return output of CRC heck
-    if (CRC_valid == MEF_TRUE)
-        return 1;
-    else
-        return 0;
+/**
+ * 	Read the compressed data of the groups of epochs of multiple channels beforehand, in a single batch (see 
+ *	preload_channel_reads). The data of each group is set as the group's preloaded data. If the data of all groups
+ *	together is larger than READ_BATCH_MAX_BYTES, when reading single-threaded, or on failure, nothing is preloaded and
+ *	the groups stream their data.
+ *
+ *	Note: the preloaded data of the groups should be freed by the caller
+ *
+ * 	@param channels             Array of (num_channels) pointers to the MEF channel objects
+ * 	@param lookups              Array of (num_channels) block lookup tables of the channels
+ * 	@param contexts             Array of (num_channels) meflib settings of the channels' sessions
+ * 	@param groups               The groups of epochs of all channels
+ * 	@param channel_first_group  The index of the first group of each channel (num_channels + 1 entries)
+ * 	@param num_channels         The number of channels
+ * 	@param num_threads          The number of threads to read the batch with (1 = no preload; 0 = one per processor)
+ */
+void preload_epochs_groups(CHANNEL **channels, BLOCK_LOOKUP *lookups, READ_CONTEXT *contexts, EPOCHS_GROUP *groups, ui8 *channel_first_group, si4 num_channels, si4 num_threads) {
+	si4				i;
+	ui4				p;
+	ui8				g;
+	bool			success = true;
+	CHANNEL_READ	read;
+	
+	// determine the pieces of the data files of each group
+	ui8 num_groups = channel_first_group[num_channels];
+	READ_STREAM *streams = (READ_STREAM *) calloc((size_t) num_groups, sizeof(READ_STREAM));
+	CHANNEL **stream_channels = (CHANNEL **) calloc((size_t) num_groups, sizeof(CHANNEL *));
+	ui1 **preloaded = (ui1 **) calloc((size_t) num_groups, sizeof(ui1 *));
+	if (streams == NULL || stream_channels == NULL || preloaded == NULL) {
+		free (streams);
+		free (stream_channels);
+		free (preloaded);
+		return;
+	}
+	for (i = 0; i < num_channels && success; i++) {
+		for (g = channel_first_group[i]; g < channel_first_group[i + 1] && success; g++) {
+			set_block_range_read(channels[i], &lookups[i], &contexts[i], groups[g].first_block, groups[g].last_block, &read);
+			success = set_read_stream_pieces(&streams[g], channels[i], &read);
+			stream_channels[g] = channels[i];
+		}
+	}
+	
+	// read the data of all groups
+	if (success && preload_read_streams(stream_channels, streams, preloaded, num_groups, num_threads)) {
+		for (g = 0; g < num_groups; g++) {
+			groups[g].preloaded = preloaded[g];
+			for (p = 0; p < streams[g].num_pieces; p++)
+				if (streams[g].pieces[p].short_read)	groups[g].short_read = true;
+		}
+	}
+	
+	// 
+	for (g = 0; g < num_groups; g++)
+		free (streams[g].pieces);
+	free (streams);
+	free (stream_channels);
+	free (preloaded);
 	
 }
 
+/**
+ * 	Read the pieces of the data files of multiple streams in a single batch, by a pool of threads at once (see read_batch)
+ *
+ *	Bytes that could not be read are set to zero (which fails the checks of the blocks), and the pieces that were not
+ *	read completely are marked as short reads.
+ *
+ * 	@param channels             Array of (num_streams) pointers to the MEF channel object of each stream
+ * 	@param streams              Array of (num_streams) streams of which the pieces are set (see set_read_stream_pieces),
+ *								streams without pieces are skipped
+ * 	@param preloaded            Array of (num_streams) pointers that will hold the (allocated) data of each stream (NULL for skipped streams)
+ * 	@param num_streams          The number of streams
+ * 	@param num_threads          The number of threads to read the batch with (the number of reads in flight; 0 = one per 
+ *								processor). A single thread gains nothing over streaming, so nothing is preloaded then
+ * 	@return                     True if the data was preloaded, false if the data of the streams together is larger than 
+ *								READ_BATCH_MAX_BYTES, when reading single-threaded, or on failure (nothing is preloaded then)
+ */
+bool preload_read_streams(CHANNEL **channels, READ_STREAM *streams, ui1 **preloaded, ui8 num_streams, si4 num_threads) {
+	ui8				i, j;
+	ui4				p;
+	BATCH_READ		*batch = NULL;
+	ui8				batch_reads = 0;
+	ui8				batch_size = 0;
+	bool			success = true;
+	
+	// check the size of the data
+	ui8 total_bytes = 0;
+	for (i = 0; i < num_streams; i++)
+		total_bytes += streams[i].total_bytes;
+	if (total_bytes > READ_BATCH_MAX_BYTES)
+		return false;
+	
+	// allocate the data of each stream and add its pieces to the batch
+	for (i = 0; i < num_streams && success; i++) {
+		if (streams[i].total_bytes == 0)	continue;
+		preloaded[i] = (ui1 *) malloc((size_t) streams[i].total_bytes);
+		if (preloaded[i] == NULL) {
+			success = false;
+			break;
+		}
+		for (p = 0; p < streams[i].num_pieces && success; p++) {
+			READ_STREAM_PIECE *piece = &streams[i].pieces[p];
+			success = add_batch_reads(&batch, &batch_reads, &batch_size, channels[i]->segments[piece->segment].time_series_data_fps->full_file_name, 
+									  piece->file_offset, piece->bytes, preloaded[i] + piece->stream_offset);
+		}
+	}
+	
+	// a batch that is read by a single thread is not read any faster than the streams
+	if (success && resolve_number_of_threads(num_threads, (si8) batch_reads) < 2)
+		success = false;
+	
+	// read the batch
+	if (success && !read_batch(batch, batch_reads, num_threads)) {
+		
+		// set the bytes that could not be read to zero
+		j = 0;
+		for (i = 0; i < num_streams; i++) {
+			if (preloaded[i] == NULL)		continue;
+			for (p = 0; p < streams[i].num_pieces; p++) {
+				READ_STREAM_PIECE *piece = &streams[i].pieces[p];
+				for (; j < batch_reads && batch[j].data >= preloaded[i] + piece->stream_offset && 
+					   batch[j].data < preloaded[i] + piece->stream_offset + piece->bytes; j++) {
+					if (batch[j].bytes_read != batch[j].bytes) {
+						memset(batch[j].data + batch[j].bytes_read, 0, (size_t) (batch[j].bytes - batch[j].bytes_read));
+						piece->short_read = true;
+					}
+				}
+			}
+		}
+		
+	}
+	free (batch);
+	
+	// on failure, nothing is preloaded
+	if (!success) {
+		for (i = 0; i < num_streams; i++) {
+			free (preloaded[i]);
+			preloaded[i] = NULL;
+		}
+	}
+	
+	return success;
+	
+}
 
+/**
+ * 	Start reading the next window of a stream (in the background) into the buffer that is not in use
+ *
+ * 	@param stream               Pointer to the stream
+ */
+void start_read_window(READ_STREAM *stream) {
+	
+	// check if there is any data left
+	if (stream->next_pos >= stream->total_bytes)
+		return;
+	
+	// set the window to read
+	stream->prefetch_data = stream->buffers[1 - stream->current_buffer] + stream->max_block_bytes;
+	stream->prefetch_bytes = stream->total_bytes - stream->next_pos;
+	if (stream->prefetch_bytes > stream->window_size)	stream->prefetch_bytes = stream->window_size;
+	
+	// read on a separate thread (or now, if the thread could not be started)
+	stream->prefetching = thread_create(&stream->prefetch_thread, read_window_worker, stream);
+	if (!stream->prefetching)
+		read_window_worker(stream);
+	stream->prefetch_pending = true;
+	
+}
+
+/**
+ * 	Worker function that reads the next window of a stream
+ *
+ * 	@param arg                  Pointer to the (READ_STREAM) stream
+ */
+void read_window_worker(void *arg) {
+	READ_STREAM *stream = (READ_STREAM *) arg;
+	read_stream_data(stream, stream->next_pos, stream->prefetch_data, stream->prefetch_bytes);
+}
+
+/**
+ * 	Check whether a block (that starts in the current window) is entirely in the current window of a stream
+ *
+ * 	@param stream               Pointer to the stream
+ * 	@param block                Pointer to the start of the block (header) in the current window
+ * 	@return                     True if the block is in the window, or if there is no more data to read (the block 
+ *								is then checked and rejected by check_block_bounds); false if the window should be advanced
+ */
+bool read_window_contains_block(READ_STREAM *stream, ui1 *block) {
+	
+	// all data has been read, this is what there is
+	if (!stream->prefetch_pending)
+		return true;
+	
+	ui8 available = (ui8) ((stream->window_data + stream->window_bytes) - block);
+	if (available < RED_BLOCK_HEADER_BYTES)
+		return false;
+	
+	// blocks that are too large are invalid (and rejected by check_block_bounds)
+	ui4 block_bytes = ((RED_BLOCK_HEADER *) block)->block_bytes;
+	if (block_bytes > stream->max_block_bytes)
+		return true;
+	
+	return block_bytes <= available;
+	
+}
+
+/**
+ * 	Advance the stream to the next window. The (partial) block at the end of the current window is carried over
+ *	to just in front of the next window, after which reading of the window after that is started.
+ *
+ *	Note: any pointers into the current window (other than the given block) are invalid afterwards
+ *
+ * 	@param stream               Pointer to the stream
+ * 	@param block                Pointer to the start of the block (header) in the current window that should be carried over
+ * 	@return                     Pointer to the start of the block in the new window
+ */
+ui1 *advance_read_window(READ_STREAM *stream, ui1 *block) {
+	
+	// check if there is a next window
+	if (!stream->prefetch_pending)
+		return block;
+	
+	// mapped, switch to the next segment
+	// (blocks do not cross data files, any remainder of the current window is not carried over)
+	if (stream->mapped) {
+		stream->current_piece++;
+		stream->window_data = stream->pieces[stream->current_piece].data;
+		stream->window_bytes = stream->pieces[stream->current_piece].bytes;
+		stream->next_pos += stream->window_bytes;
+		stream->prefetch_pending = (stream->current_piece < stream->num_pieces - 1);
+		return stream->window_data;
+	}
+	
+	// wait for the next window to be read
+	if (stream->prefetching)
+		thread_join(&stream->prefetch_thread);
+	stream->prefetching = false;
+	stream->prefetch_pending = false;
+	
+	// carry over the remainder of the current window
+	ui8 carry_bytes = (ui8) ((stream->window_data + stream->window_bytes) - block);
+	memcpy(stream->prefetch_data - carry_bytes, block, (size_t) carry_bytes);
+	
+	// switch to the new window
+	stream->window_data = stream->prefetch_data - carry_bytes;
+	stream->window_bytes = carry_bytes + stream->prefetch_bytes;
+	stream->next_pos += stream->prefetch_bytes;
+	stream->current_buffer = 1 - stream->current_buffer;
+	
+	// start reading the next window
+	start_read_window(stream);
+	
+	return stream->window_data;
+	
+}
+
+/**
+ * 	Close a stream, waiting for any background read to finish and freeing the buffers.
+ *	Warnings on data files that could not be read entirely are added to the read messages.
+ *
+ * 	@param stream               Pointer to the stream
+ *	@param read                 Pointer to the struct that holds the range to read (for the messages)
+ */
+void close_read_stream(READ_STREAM *stream, CHANNEL_READ *read) {
+	ui4		i;
+	
+	// wait for a background read to finish
+	if (stream->prefetching)
+		thread_join(&stream->prefetch_thread);
+	stream->prefetching = false;
+	stream->prefetch_pending = false;
+	
+	// 
+	for (i = 0; i < stream->num_pieces; i++)
+		if (stream->pieces[i].short_read)
+			add_read_message(read, "Warning: read in fewer than expected bytes from data file in segment %d.\n", stream->pieces[i].segment);
+	
+	// release the mappings
+	#ifdef MATMEF_MMAP
+		if (stream->mapped)
+			unmap_read_stream(stream);
+	#endif
+	
+	free (stream->buffers[0]);
+	free (stream->buffers[1]);
+	free (stream->pieces);
+	
+}
+
+/**
+ * 	Read a range of bytes from a stream (from the data files of one or more segments). Data that was read
+ *	ahead (see update_readahead) is copied instead. Bytes that could not be read are set to zero (which fails the checks of the blocks)
+ *
+ * 	@param stream               Pointer to the stream
+ * 	@param pos                  The position in the stream to start reading from
+ * 	@param data                 The buffer to read into
+ * 	@param num_bytes            The number of bytes to read
+ */
+void read_stream_data(READ_STREAM *stream, ui8 pos, ui1 *data, ui8 num_bytes) {
+	ui4		i;
+	
+	for (i = 0; i < stream->num_pieces && num_bytes > 0; i++) {
+		READ_STREAM_PIECE *piece = &stream->pieces[i];
+		if (pos >= piece->stream_offset + piece->bytes)
+			continue;
+		
+		// determine what to read from this piece
+		ui8 offset_in_piece = pos - piece->stream_offset;
+		ui8 bytes_to_read = piece->bytes - offset_in_piece;
+		if (bytes_to_read > num_bytes)	bytes_to_read = num_bytes;
+		
+		// open the data file if needed
+		FILE_PROCESSING_STRUCT *fps = stream->channel->segments[piece->segment].time_series_data_fps;
+        if (fps->fp == NULL){
+            fps->fp = fopen(fps->full_file_name, "rb");
+			if (fps->fp != NULL) {
+				#ifdef _WIN32
+					fps->fd = _fileno(fps->fp);
+				#else
+					fps->fd = fileno(fps->fp);
+				#endif
+			}
+        }
+		
+		// copy what was read ahead, and read the rest
+		ui8 n_read = 0;
+		if (stream->readahead != NULL)
+			n_read = copy_readahead_data(stream->readahead, piece->segment, piece->file_offset + offset_in_piece, data, bytes_to_read);
+		if (fps->fp != NULL && n_read < bytes_to_read) {
+			#ifdef _WIN32
+				_fseeki64(fps->fp, piece->file_offset + offset_in_piece + n_read, SEEK_SET);
+			#else
+				fseeko(fps->fp, (off_t) (piece->file_offset + offset_in_piece + n_read), SEEK_SET);
+			#endif
+			n_read += fread(data + n_read, sizeof(si1), (size_t) (bytes_to_read - n_read), fps->fp);
+		}
+		if (n_read != bytes_to_read) {
+			memset(data + n_read, 0, (size_t) (bytes_to_read - n_read));
+			piece->short_read = true;
+		}
+		
+		// close the data file once the piece has been read
+		if (offset_in_piece + bytes_to_read == piece->bytes && fps->directives.close_file == MEF_TRUE)
+			fps_close(fps);
+		
+		data += bytes_to_read;
+		pos += bytes_to_read;
+		num_bytes -= bytes_to_read;
+		
+	}
+	
+}
+
+#ifdef MATMEF_MMAP
+
+/**
+ * 	Memory-map the pieces of the data files of a stream (read-only access to the files).
+ *
+ *	The mappings are private and writable, since decoding alters the block headers in place (the changes
+ *	are copy-on-write, they never reach the file and are discarded when unmapping)
+ *
+ * 	@param stream               Pointer to the stream
+ * 	@return                     True if all pieces were mapped, false on failure (nothing is mapped then)
+ */
+bool map_read_stream(READ_STREAM *stream) {
+	ui4			i;
+	struct stat	file_stat;
+	
+	ui8 page_size = (ui8) sysconf(_SC_PAGESIZE);
+	for (i = 0; i < stream->num_pieces; i++) {
+		READ_STREAM_PIECE *piece = &stream->pieces[i];
+		if (piece->bytes == 0)	continue;
+		
+		// open the data file if needed
+		FILE_PROCESSING_STRUCT *fps = stream->channel->segments[piece->segment].time_series_data_fps;
+		if (fps->fp == NULL) {
+			fps->fp = fopen(fps->full_file_name, "rb");
+			if (fps->fp != NULL)	fps->fd = fileno(fps->fp);
+		}
+		if (fps->fp == NULL)
+			break;
+		
+		// map the piece (the offset of a mapping needs to be aligned to the page size), but only if the file
+		// actually holds the piece (accessing a mapping beyond the end of a file is fatal)
+		void *map = MAP_FAILED;
+		ui8 map_offset = piece->file_offset - (piece->file_offset % page_size);
+		size_t map_bytes = (size_t) (piece->bytes + (piece->file_offset - map_offset));
+		if (fstat(fileno(fps->fp), &file_stat) == 0 && (ui8) file_stat.st_size >= piece->file_offset + piece->bytes)
+			map = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fps->fp), (off_t) map_offset);
+		
+		// the mapping remains valid after the file is closed
+		if (fps->directives.close_file == MEF_TRUE)
+			fps_close(fps);
+		
+		if (map == MAP_FAILED)
+			break;
+		(void) madvise(map, map_bytes, MADV_WILLNEED);
+		
+		piece->map = (ui1 *) map;
+		piece->map_bytes = map_bytes;
+		piece->data = piece->map + (piece->file_offset - map_offset);
+		
+	}
+	
+	// undo on failure
+	if (i < stream->num_pieces) {
+		unmap_read_stream(stream);
+		return false;
+	}
+	
+	return true;
+	
+}
+
+/**
+ * 	Release the memory mappings of a stream
+ *
+ * 	@param stream               Pointer to the stream
+ */
+void unmap_read_stream(READ_STREAM *stream) {
+	ui4		i;
+	
+	for (i = 0; i < stream->num_pieces; i++) {
+		if (stream->pieces[i].map != NULL)
+			munmap(stream->pieces[i].map, stream->pieces[i].map_bytes);
+		stream->pieces[i].map = NULL;
+		stream->pieces[i].data = NULL;
+	}
+	
+}
+
+#endif
+
+/**
+ * 	Worker function that reads whole channels into a (column-major) <channels> x <samples> output matrix
+ *
+ *	Note: runs on other threads than the main (matlab) thread, so no matlab API functions are called here
+ *
+ * 	@param arg                  Pointer to the (CHANNELS_WORKER) worker
+ */
+void read_channels_worker(void *arg) {
+	CHANNELS_WORKER *worker = (CHANNELS_WORKER *) arg;
+	si4		i;
+	si4		*samples = NULL;
+	ui8		samples_size = 0;
+	
+	for (i = worker->first_channel; i < worker->num_channels; i += worker->channel_step) {
+		CHANNEL_READ *read = &worker->reads[i];
+		if (read->num_samps == 0)	continue;
+		
+		// (re-)allocate the samples buffer
+		if (read->num_samps > samples_size) {
+			free (samples);
+			samples_size = read->num_samps;
+			samples = (si4 *) malloc((size_t) (samples_size * sizeof(si4)));
+			if (samples == NULL) {
+				add_read_message(read, "Error: could not allocated enough memory for the sample buffer, exiting....\n");
+				worker->success = false;
+				return;
+			}
+		}
+		
+		// read and decode the samples (the channels are already spread over the threads)
+		if (!read_channel_samples(worker->channels[i], read, samples, 1)) {
+			worker->success = false;
+			break;
+		}
+		
+		// copy/cast the data to the channel's row in the output matrix, applying the conversion factor in the same pass
+		sf8 fac = (worker->apply_conv_factor) ? worker->channels[i]->metadata.time_series_section_2->units_conversion_factor : 1.0;
+		if (worker->output_type == OUTPUT_SINGLE)
+			convert_samples_to_single(samples, read->num_samps, (sf4 *) worker->output + i, (ui8) worker->num_channels, fac, (sf4) worker->nan_value);
+		else
+			convert_samples_to_double(samples, read->num_samps, (sf8 *) worker->output + i, (ui8) worker->num_channels, fac, worker->nan_value);
+		
+	}
+	
+	free (samples);
+	
+}
+
+/**
+ * 	Worker function that reads the epochs of whole channels into a (column-major) <channels> x <samples> x <ranges> output matrix
+ *
+ *	Each group of epochs is read and decoded at once into a sample buffer, from which the samples are copied into the epochs
+ *	of the group. Epochs given in samples are copied straight from the buffer; for epochs given in time, each block is placed
+ *	at its start time (like read_channel_samples does), leaving NaNs in the gaps.
+ *
+ *	Note: runs on other threads than the main (matlab) thread, so no matlab API functions are called here
+ *
+ * 	@param arg                  Pointer to the (EPOCHS_WORKER) worker
+ */
+void read_epochs_worker(void *arg) {
+	EPOCHS_WORKER *worker = (EPOCHS_WORKER *) arg;
+	si4		i;
+	ui8		j, k;
+	si4		*samples = NULL;
+	ui8		samples_size = 0;
+	ui8		*block_offsets = NULL;
+	ui8		block_offsets_size = 0;
+	CHANNEL_READ read;
+	
+	worker->message[0] = '\0';
+	for (i = worker->first_channel; i < worker->num_channels && worker->success; i += worker->channel_step) {
+		CHANNEL *channel = worker->channels[i];
+		BLOCK_LOOKUP *lookup = &worker->lookups[i];
+		sf8 fs = channel->metadata.time_series_section_2->sampling_frequency;
+		sf8 fac = (worker->apply_conv_factor) ? channel->metadata.time_series_section_2->units_conversion_factor : 1.0;
+		
+		// fill the ranges of the channel with NaNs
+		// (only needed for the samples that are not copied from the blocks, but which these are is only known afterwards)
+		for (j = 0; j < (ui8) worker->num_ranges * worker->output_samps; j++) {
+			if (worker->output_type == OUTPUT_SINGLE)
+				((sf4 *) worker->output)[j * worker->num_channels + i] = (sf4) worker->nan_value;
+			else
+				((sf8 *) worker->output)[j * worker->num_channels + i] = worker->nan_value;
+		}
+		
+		for (ui8 g = worker->channel_first_group[i]; g < worker->channel_first_group[i + 1]; g++) {
+			EPOCHS_GROUP *group = &worker->groups[g];
+			
+			// determine the range of (whole) blocks to read
+			set_block_range_read(channel, lookup, &worker->contexts[i], group->first_block, group->last_block, &read);
+			read.validate_crc = worker->validate_crc;
+			read.preloaded = group->preloaded;
+			if (group->short_read)
+				add_read_message(&read, "Warning: read in fewer than expected bytes from the data files of channel '%s'.\n", channel->name);
+			
+			// (re-)allocate the samples buffer and the offsets of the blocks in the buffer
+			ui8 num_blocks = group->last_block - group->first_block + 1;
+			if (read.num_samps > samples_size || num_blocks > block_offsets_size) {
+				if (read.num_samps > samples_size) {
+					free (samples);
+					samples_size = read.num_samps;
+					samples = (si4 *) malloc((size_t) (samples_size * sizeof(si4)));
+				}
+				if (num_blocks > block_offsets_size) {
+					free (block_offsets);
+					block_offsets_size = num_blocks;
+					block_offsets = (ui8 *) malloc((size_t) ((block_offsets_size + 1) * sizeof(ui8)));
+				}
+				if (samples == NULL || block_offsets == NULL) {
+					MEF_snprintf(worker->message, READ_MESSAGE_BYTES, "Error: could not allocated enough memory for the sample buffer, exiting....\n");
+					worker->success = false;
+					break;
+				}
+			}
+			
+			// read and decode the samples of the group (the channels are already spread over the threads)
+			if (!read_channel_samples(channel, &read, samples, 1)) {
+				MEF_strncpy(worker->message, read.message, READ_MESSAGE_BYTES);
+				worker->success = false;
+				break;
+			}
+			
+			// the offsets of the blocks in the buffer (the blocks are decoded consecutively)
+			block_offsets[0] = 0;
+			for (k = 0; k < num_blocks; k++) {
+				BLOCK_LOOKUP_ENTRY *block = &lookup->blocks[group->first_block + k];
+				block_offsets[k + 1] = block_offsets[k] + (ui8) channel->segments[block->segment].time_series_indices_fps->time_series_indices[block->block].number_of_samples;
+			}
+			
+			// copy the samples to each epoch in the group
+			for (j = 0; j < group->num_epochs; j++) {
+				EPOCH *epoch = &worker->epochs[group->first_epoch + j];
+				ui8 output_offset = ((ui8) epoch->range * worker->output_samps * worker->num_channels) + i;
+				
+				if (worker->range_type == RANGE_BY_SAMPLES) {
+					
+					// the epoch is a consecutive run of samples in the buffer
+					ui8 buffer_offset = block_offsets[epoch->first_block - group->first_block] + (ui8) (epoch->start_samp - lookup->blocks[epoch->first_block].start_sample);
+					ui8 num_samps = epoch->num_samps;
+					if (buffer_offset + num_samps > read.num_samps)
+						num_samps = (buffer_offset < read.num_samps) ? read.num_samps - buffer_offset : 0;
+					copy_epoch_samples(worker, samples + buffer_offset, num_samps, output_offset, fac);
+					
+				} else {
+					
+					// place each block of the epoch at its start time (rounded to the nearest sample)
+					for (k = epoch->first_block; k <= epoch->last_block; k++) {
+						sf8 time_offset = ((lookup->blocks[k].start_time - epoch->start_time) / 1000000.0) * fs;
+						si8 offset = (si8) ((time_offset >= 0) ? time_offset + 0.5 : time_offset - 0.5);
+						si8 first = (offset < 0) ? -offset : 0;
+						si8 last = (si8) (block_offsets[k - group->first_block + 1] - block_offsets[k - group->first_block]);
+						if (offset + last > (si8) epoch->num_samps)
+							last = (si8) epoch->num_samps - offset;
+						if (last <= first)	continue;
+						
+						copy_epoch_samples(worker, samples + block_offsets[k - group->first_block] + first, (ui8) (last - first), output_offset + (ui8) (offset + first) * worker->num_channels, fac);
+					}
+					
+				}
+			}
+			
+		}
+		
+	}
+	
+	free (samples);
+	free (block_offsets);
+	
+}
+
+/**
+ * 	Copy/cast (decoded) samples to a position in the output matrix of an epochs worker, applying the conversion factor in the same pass
+ *
+ * 	@param worker               Pointer to the worker
+ * 	@param samples              The samples to copy
+ * 	@param num_samps            The number of samples to copy
+ * 	@param output_offset        The (element) offset in the output matrix to copy the first sample to (the next samples follow in the same row)
+ * 	@param fac                  The factor to multiply the samples with (1.0 = no conversion)
+ */
+void copy_epoch_samples(EPOCHS_WORKER *worker, si4 *samples, ui8 num_samps, ui8 output_offset, sf8 fac) {
+	if (worker->output_type == OUTPUT_SINGLE)
+		convert_samples_to_single(samples, num_samps, (sf4 *) worker->output + output_offset, (ui8) worker->num_channels, fac, (sf4) worker->nan_value);
+	else
+		convert_samples_to_double(samples, num_samps, (sf8 *) worker->output + output_offset, (ui8) worker->num_channels, fac, worker->nan_value);
+}
+
+/**
+ * 	Set up the read of a range of whole blocks (as samples) from a channel, without any further checks
+ *	(the blocks should exist in the lookup table, as the blocks of ranges that were determined by prepare_channel_read)
+ *
+ *	Note: this function does not output any messages to matlab and can therefore also be called from other threads
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param context              Pointer to the meflib settings of the channel's session (copied into the read)
+ * 	@param first_block          The index of the first block to read in the lookup table
+ * 	@param last_block           The index of the last block to read in the lookup table
+ *	@param read                 Pointer to the struct that will hold the range to read
+ */
+void set_block_range_read(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui8 first_block, ui8 last_block, CHANNEL_READ *read) {
+	ui8		i;
+	
+	read->message[0] = '\0';
+	read->output_initialized = false;
+	read->validate_crc = true;
+	read->context = *context;
+	read->cache = NULL;
+	read->readahead = NULL;
+	read->preloaded = NULL;
+	read->range_type = RANGE_BY_SAMPLES;
+	
+	// count the samples and bytes in the blocks
+	read->num_samps = 0;
+	read->total_data_bytes = 0;
+	for (i = first_block; i <= last_block; i++) {
+		TIME_SERIES_INDEX *index = &channel->segments[lookup->blocks[i].segment].time_series_indices_fps->time_series_indices[lookup->blocks[i].block];
+		read->num_samps += (ui8) index->number_of_samples;
+		read->total_data_bytes += (ui8) index->block_bytes;
+	}
+	
+	//
+	read->start_samp = lookup->blocks[first_block].start_sample;
+	read->end_samp = read->start_samp + (si8) read->num_samps;
+	read->start_time = lookup->blocks[first_block].start_time;
+	read->end_time = lookup->blocks[last_block].start_time;
+	read->start_segment = lookup->blocks[first_block].segment;
+	read->end_segment = lookup->blocks[last_block].segment;
+	read->start_idx = lookup->blocks[first_block].block;
+	read->end_idx = lookup->blocks[last_block].block;
+	read->num_blocks = last_block - first_block + 1;
+	
+}
+
+/**
+ * 	Convert (decoded) samples to doubles, replacing RED_NAN samples by NaN and applying a conversion factor in the same pass
+ *
+ *	Note: the samples and the output should not overlap (see convert_samples_in_output to convert within an output array)
+ *
+ * 	@param samples              The samples to convert
+ * 	@param num_samps            The number of samples to convert
+ * 	@param output               The output to write the doubles to
+ * 	@param stride               The step between consecutive samples in the output (1 = contiguous; e.g. the number of rows when writing a matrix row)
+ * 	@param fac                  The factor to multiply the samples with (1.0 = no conversion)
+ * 	@param nan_value            The NaN value to write for RED_NAN samples
+ */
+void convert_samples_to_double(si4 *samples, ui8 num_samps, sf8 *output, ui8 stride, sf8 fac, sf8 nan_value) {
+	ui8		i;
+	
+	// contiguous output as a separate (branch-free) loop, so the compiler can vectorize it
+	if (stride == 1) {
+		for (i = 0; i < num_samps; i++)
+			output[i] = (samples[i] == RED_NAN) ? nan_value : fac * (sf8) samples[i];
+	} else {
+		for (i = 0; i < num_samps; i++)
+			output[i * stride] = (samples[i] == RED_NAN) ? nan_value : fac * (sf8) samples[i];
+	}
+	
+}
+
+/**
+ * 	Convert (decoded) samples to singles, replacing RED_NAN samples by NaN and applying a conversion factor in the same pass
+ *  (the conversion factor is applied in double precision, so each sample is rounded only once)
+ *
+ *	Note: the samples and the output should not overlap (see convert_samples_in_output to convert within an output array)
+ *
+ * 	@param samples              The samples to convert
+ * 	@param num_samps            The number of samples to convert
+ * 	@param output               The output to write the singles to
+ * 	@param stride               The step between consecutive samples in the output (1 = contiguous; e.g. the number of rows when writing a matrix row)
+ * 	@param fac                  The factor to multiply the samples with (1.0 = no conversion)
+ * 	@param nan_value            The NaN value to write for RED_NAN samples
+ */
+void convert_samples_to_single(si4 *samples, ui8 num_samps, sf4 *output, ui8 stride, sf8 fac, sf4 nan_value) {
+	ui8		i;
+	
+	// contiguous output as a separate (branch-free) loop, so the compiler can vectorize it
+	if (stride == 1) {
+		for (i = 0; i < num_samps; i++)
+			output[i] = (samples[i] == RED_NAN) ? nan_value : (sf4) (fac * (sf8) samples[i]);
+	} else {
+		for (i = 0; i < num_samps; i++)
+			output[i * stride] = (samples[i] == RED_NAN) ? nan_value : (sf4) (fac * (sf8) samples[i]);
+	}
+	
+}
+
+/**
+ * 	Convert (decoded) samples that are stored in the output array itself to doubles or singles, replacing RED_NAN samples
+ *	by NaN and applying a conversion factor in the same pass
+ *
+ *	The samples should be stored at the start of the output (singles) or in the second half of the output (doubles). The
+ *	samples are copied out chunk by chunk into a separate buffer before they are converted, so that the samples and the
+ *	converted values never alias. Since the chunks are converted in a forward pass, the output of each chunk only overlaps
+ *	samples that were already copied out.
+ *
+ * 	@param samples              The samples to convert (within the output)
+ * 	@param num_samps            The number of samples to convert
+ * 	@param output               The output array to write the doubles or singles to
+ *  @param output_type          The type of the output (OUTPUT_DOUBLE or OUTPUT_SINGLE)
+ * 	@param fac                  The factor to multiply the samples with (1.0 = no conversion)
+ * 	@param nan_value            The NaN value to write for RED_NAN samples
+ */
+void convert_samples_in_output(si4 *samples, ui8 num_samps, void *output, si4 output_type, sf8 fac, sf8 nan_value) {
+	si4		chunk[CONVERT_CHUNK_SAMPLES];
+	ui8		i, n;
+	
+	for (i = 0; i < num_samps; i += n) {
+		n = num_samps - i;
+		if (n > CONVERT_CHUNK_SAMPLES)	n = CONVERT_CHUNK_SAMPLES;
+		memcpy(chunk, samples + i, (size_t) n * sizeof(si4));
+		if (output_type == OUTPUT_SINGLE)
+			convert_samples_to_single(chunk, n, (sf4 *) output + i, 1, fac, (sf4) nan_value);
+		else
+			convert_samples_to_double(chunk, n, (sf8 *) output + i, 1, fac, nan_value);
+	}
+	
+}
+
+/**
+ * 	Add a (formatted) message to the message field of a read struct
+ *  (the messages are output by the caller, so that reading can also take place in other threads)
+ *
+ * 	@param read                 Pointer to the read struct
+ * 	@param format               The message (format)
+ */
+void add_read_message(CHANNEL_READ *read, const char *format, ...) {
+	size_t len = strlen(read->message);
+	if (len >= READ_MESSAGE_BYTES - 1)	return;
+	
+    va_list args;
+    va_start(args, format);
+    vsnprintf(read->message + len, READ_MESSAGE_BYTES - len, format, args);
+    va_end(args);
+	
+}
+
+/**
+ * 	Capture the meflib settings that are used while reading from the meflib globals, which
+ *  should be called right after opening a channel (when the globals hold the settings of the channel's session)
+ *
+ * 	@param context              Pointer to the context struct that will hold the settings
+ */
+void capture_read_context(READ_CONTEXT *context) {
+	context->recording_time_offset = MEF_globals->recording_time_offset;
+	context->recording_time_offset_mode = MEF_globals->recording_time_offset_mode;
+}
+
+/**
+ * 	Apply the recording time offset of a context to a time (the equivalent of meflib's apply_recording_time_offset)
+ *
+ * 	@param context              Pointer to the context with the recording time offset
+ * 	@param time                 Pointer to the time (negative after applying, times that are already negative are left unchanged)
+ */
+void apply_context_time_offset(READ_CONTEXT *context, si8 *time) {
+	if (*time == UUTC_NO_ENTRY || *time < 0)
+		return;
+	
+	if (context->recording_time_offset == METADATA_RECORDING_TIME_OFFSET_NO_ENTRY)
+		*time = -(*time);
+	else
+		*time = -(*time - context->recording_time_offset);
+}
+
+/**
+ * 	Remove the recording time offset of a context from a time (the equivalent of meflib's remove_recording_time_offset)
+ *
+ * 	@param context              Pointer to the context with the recording time offset
+ * 	@param time                 Pointer to the time (positive after removing, times that are already positive are left unchanged)
+ */
+void remove_context_time_offset(READ_CONTEXT *context, si8 *time) {
+	if (*time == UUTC_NO_ENTRY || *time >= 0)
+		return;
+	
+	if (context->recording_time_offset == METADATA_RECORDING_TIME_OFFSET_NO_ENTRY)
+		*time = -(*time);
+	else
+		*time = (-*time) + context->recording_time_offset;
+}
+
+/**
+ * 	Build a lookup table of the blocks of all segments of a channel
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param context              Pointer to the meflib settings of the channel's session (for the recording time offset)
+ * 	@param lookup               Pointer to the lookup table struct to build (to be released using free_block_lookup)
+ * 	@return                     True if successful, false on failure
+ */
+bool build_block_lookup(CHANNEL *channel, READ_CONTEXT *context, BLOCK_LOOKUP *lookup) {
+	ui4		i;
+	ui8		j;
+	
+	memset(lookup, 0, sizeof(BLOCK_LOOKUP));
+	if (channel->number_of_segments < 1)
+		return false;
+	
+	// count the blocks
+	lookup->num_segments = (ui4) channel->number_of_segments;
+	for (i = 0; i < lookup->num_segments; i++)
+		lookup->num_blocks += (ui8) channel->segments[i].metadata_fps->metadata.time_series_section_2->number_of_blocks;
+	
+	// allocate the table
+	lookup->blocks = (BLOCK_LOOKUP_ENTRY *) malloc((size_t) (lookup->num_blocks > 0 ? lookup->num_blocks : 1) * sizeof(BLOCK_LOOKUP_ENTRY));
+	lookup->segment_first_block = (ui8 *) malloc((size_t) (lookup->num_segments + 1) * sizeof(ui8));
+	lookup->segment_start_time = (si8 *) malloc((size_t) lookup->num_segments * 4 * sizeof(si8));
+	if (lookup->blocks == NULL || lookup->segment_first_block == NULL || lookup->segment_start_time == NULL) {
+		free_block_lookup(lookup);
+		return false;
+	}
+	lookup->segment_end_time = lookup->segment_start_time + lookup->num_segments;
+	lookup->segment_start_sample = lookup->segment_end_time + lookup->num_segments;
+	lookup->segment_end_sample = lookup->segment_start_sample + lookup->num_segments;
+	
+	// fill the table
+	ui8 k = 0;
+	for (i = 0; i < lookup->num_segments; i++) {
+		SEGMENT *segment = &channel->segments[i];
+		TIME_SERIES_METADATA_SECTION_2 *tmd2 = segment->metadata_fps->metadata.time_series_section_2;
+		TIME_SERIES_INDEX *indices = segment->time_series_indices_fps->time_series_indices;
+		
+		lookup->segment_start_time[i] = segment->time_series_data_fps->universal_header->start_time;
+		lookup->segment_end_time[i] = segment->time_series_data_fps->universal_header->end_time;
+		remove_context_time_offset(context, &lookup->segment_start_time[i]);
+		remove_context_time_offset(context, &lookup->segment_end_time[i]);
+		lookup->segment_start_sample[i] = tmd2->start_sample;
+		lookup->segment_end_sample[i] = tmd2->start_sample + tmd2->number_of_samples;
+		
+		lookup->segment_first_block[i] = k;
+		for (j = 0; j < (ui8) tmd2->number_of_blocks; j++, k++) {
+			lookup->blocks[k].start_sample = tmd2->start_sample + indices[j].start_sample;
+			lookup->blocks[k].start_time = indices[j].start_time;
+			remove_context_time_offset(context, &lookup->blocks[k].start_time);
+			lookup->blocks[k].segment = i;
+			lookup->blocks[k].block = (ui4) j;
+		}
+		
+	}
+	lookup->segment_first_block[lookup->num_segments] = k;
+	
+	// store the starting point (from which samples and times are extrapolated when before the first block)
+	lookup->first_sample = channel->segments[0].metadata_fps->metadata.time_series_section_2->start_sample;
+	lookup->first_time = channel->segments[0].time_series_indices_fps->time_series_indices[0].start_time;
+	remove_context_time_offset(context, &lookup->first_time);
+	lookup->sampling_frequency = channel->metadata.time_series_section_2->sampling_frequency;
+	
+	return true;
+	
+}
+
+/**
+ * 	Release the memory of a block lookup table
+ *
+ * 	@param lookup               Pointer to the lookup table struct
+ */
+void free_block_lookup(BLOCK_LOOKUP *lookup) {
+	free(lookup->blocks);
+	free(lookup->segment_first_block);
+	free(lookup->segment_start_time);
+	memset(lookup, 0, sizeof(BLOCK_LOOKUP));
+}
+
+/**
+ * 	Find the block in a segment that contains a given time (the last block that starts at or before the time,
+ *  or the first block if the time lies before the segment)
+ *
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param segment              The index of the segment
+ * 	@param time                 The time to find the block for (with the recording time offset removed)
+ * 	@return                     The index of the block in the segment
+ */
+ui8 find_segment_block(BLOCK_LOOKUP *lookup, ui4 segment, si8 time) {
+	ui8 first = lookup->segment_first_block[segment];
+	ui8 lo = first + 1, hi = lookup->segment_first_block[segment + 1], mid;
+	if (lo >= hi)
+		return 0;
+	
+	// find the first block (after the first) that starts past the time
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (lookup->blocks[mid].start_time > time)	hi = mid;
+		else										lo = mid + 1;
+	}
+	return lo - first - 1;
+	
+}
+
+/**
+ * 	Convert a time to a sample number (by the closest block that starts at or before the time)
+ *
+ * 	@param uutc                 The time (with the recording time offset removed)
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@return                     The sample number
+ */
+si8 sample_for_uutc_c(si8 uutc, BLOCK_LOOKUP *lookup) {
+    ui8 sample;
+    ui8 prev_sample_number = lookup->first_sample;
+    si8 prev_time = lookup->first_time;
+	si8 next_sample_number = lookup->segment_end_sample[lookup->num_segments - 1];
+	
+	// find the first block that starts past the time
+    ui8 lo = 0, hi = lookup->num_blocks, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (lookup->blocks[mid].start_time > uutc)	hi = mid;
+		else										lo = mid + 1;
+	}
+	if (lo < lookup->num_blocks)
+		next_sample_number = lookup->blocks[lo].start_sample;
+	if (lo > 0) {
+		prev_sample_number = lookup->blocks[lo - 1].start_sample;
+		prev_time = lookup->blocks[lo - 1].start_time;
+	}
+	
+    sample = prev_sample_number + (ui8) (((((sf8) (uutc - prev_time)) / 1000000.0) * lookup->sampling_frequency) + 0.5);
+    if (sample > next_sample_number)
+        sample = next_sample_number;  // prevent it from going too far
+	
+    return(sample);
+}
+
+/**
+ * 	Convert a sample number to a time (by the closest block that starts at or before the sample)
+ *
+ * 	@param sample               The sample number
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@return                     The time (with the recording time offset removed)
+ */
+si8 uutc_for_sample_c(si8 sample, BLOCK_LOOKUP *lookup) {
+    ui8 uutc;
+    ui8 prev_sample_number = lookup->first_sample;
+    si8 prev_time = lookup->first_time;
+	
+	// find the first block that starts past the sample
+    ui8 lo = 0, hi = lookup->num_blocks, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (lookup->blocks[mid].start_sample > sample)	hi = mid;
+		else											lo = mid + 1;
+	}
+	if (lo > 0) {
+		prev_sample_number = lookup->blocks[lo - 1].start_sample;
+		prev_time = lookup->blocks[lo - 1].start_time;
+	}
+	
+    uutc = prev_time + (ui8) ((((sf8) (sample - prev_sample_number) / lookup->sampling_frequency) * 1000000.0) + 0.5);
+    
+    return(uutc);
+}
+
+void memset_int(si4 *ptr, si4 value, size_t num) {
+    si4 *temp_ptr;
+    
+    if (num < 1)
+        return;
+    
+	si4 *limit = ptr + num;
+    for (temp_ptr = ptr; temp_ptr < limit; ++temp_ptr)
+		*temp_ptr = value;
+	
+}
+
+/**
+ * 	Check whether a RED block (header) fits within the compressed data buffer and whether the size of the block,
+ *  the number of samples and the number of difference bytes are valid (without checking the CRC). The number
+ *  of samples and difference bytes are used to decode the block into buffers that are sized by max_samps, so
+ *  these are checked whether or not the CRC is validated
+ *
+ * 	@param block_hdr_ptr        Pointer to the RED block (header) in the compressed data buffer
+ * 	@param max_samps            The maximum number of samples in a block (for the channel)
+ * 	@param total_data_ptr       Pointer to the start of the compressed data buffer
+ * 	@param total_data_bytes     The size of the compressed data buffer (in bytes)
+ * 	@return                     1 if the block is valid, 0 if not
+ */
+si4 check_block_bounds(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes) {
+    ui8 offset_into_data, remaining_buf_size;
+    RED_BLOCK_HEADER *block_header;
+    
+    offset_into_data = block_hdr_ptr - total_data_ptr;
+    remaining_buf_size = total_data_bytes - offset_into_data;
+    
+    // check if remaining buffer at least contains the RED block header
+    if (remaining_buf_size < RED_BLOCK_HEADER_BYTES)
+        return 0;
+    
+    block_header = (RED_BLOCK_HEADER*) block_hdr_ptr;
+    
+    // check if entire block, based on size specified in header, can possibly fit in the remaining buffer
+    if (block_header->block_bytes > remaining_buf_size)
+        return 0;
+    
+    // check if size specified in header is absurdly large
+    if (block_header->block_bytes > RED_MAX_COMPRESSED_BYTES(max_samps, 1))
+        return 0;
+    
+    // check if the number of samples and the difference bytes fit within the decode buffers
+    if (block_header->number_of_samples > max_samps)
+        return 0;
+    if ((ui8) block_header->difference_bytes > (ui8) RED_MAX_DIFFERENCE_BYTES((ui8) max_samps))
+        return 0;
+	
+	return 1;
+	
+}
+
+si4 check_block_crc(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes) {
+    RED_BLOCK_HEADER *block_header;
+    
+    // check whether the block fits within the buffer
+    if (!check_block_bounds(block_hdr_ptr, max_samps, total_data_ptr, total_data_bytes))
+        return 0;
+    
+    block_header = (RED_BLOCK_HEADER*) block_hdr_ptr;
+    
+    // at this point we know we have enough data to actually run the CRC calculation, so do it
+    // (this is the only place where the CRC of a block is validated when reading)
+    if (crc_validate_sliced((ui1*) block_header + CRC_BYTES, block_header->block_bytes - CRC_BYTES, block_header->block_CRC))
+        return 1;
+    else
+        return 0;
+	
+}
+
+/**
+ * 	Check whether a RED block is valid, which is whether the block has a size, fits within the buffer that holds
+ *  the compressed data, has a valid number of samples and difference bytes (see check_block_bounds), has statistics
+ *  that can be range decoded (for unencrypted blocks; encrypted statistics are checked once decrypted, in 
+ *  decode_red_block) and - unless the read is trusted - whether the block passes the CRC check
+ *
+ * 	@param block_hdr_ptr        Pointer to the RED block (header)
+ * 	@param max_samps            The maximum number of samples in a block (for the channel)
+ * 	@param total_data_ptr       Pointer to the start of the compressed data buffer that holds the block
+ * 	@param total_data_bytes     The size of the compressed data buffer (in bytes)
+ * 	@param validate_crc         Whether to validate the CRC of the block (false = only the structural checks)
+ * 	@return                     True if the block is valid, false otherwise
+ */
+bool check_block(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes, bool validate_crc) {
+	
+	// check whether the block has a size and fits within the buffer
+	if (!check_block_bounds(block_hdr_ptr, max_samps, total_data_ptr, total_data_bytes))
+		return false;
+	RED_BLOCK_HEADER *block_header = (RED_BLOCK_HEADER *) block_hdr_ptr;
+	if (block_header->block_bytes < RED_BLOCK_HEADER_BYTES)
+		return false;
+	
+	// check that the statistics hold counts (the range decoder divides by their total)
+	if (block_header->difference_bytes > 0 && !(block_header->flags & (RED_LEVEL_1_ENCRYPTION_MASK | RED_LEVEL_2_ENCRYPTION_MASK))) {
+		ui4 total_counts = 0;
+		for (ui4 i = 0; i < RED_BLOCK_STATISTICS_BYTES; i++)
+			total_counts += block_header->statistics[i];
+		if (total_counts == 0)
+			return false;
+	}
+	
+	// check the CRC
+	if (validate_crc)
+		return check_block_crc(block_hdr_ptr, max_samps, total_data_ptr, total_data_bytes) == 1;
+	return true;
+	
+}
+
+/**
+ * 	Prepare the keys to decrypt the (encrypted) RED blocks of a channel with, once for all blocks that are decoded
+ *
+ * 	@param decryption           Pointer to the struct that will hold the keys
+ * 	@param password_data        Pointer to the password data of the channel (NULL if there is none)
+ */
+void prepare_block_decryption(BLOCK_DECRYPTION *decryption, PASSWORD_DATA *password_data) {
+	
+	if (password_data == NULL) {
+		decryption->access_level = NO_ENCRYPTION;
+		return;
+	}
+	
+	decryption->access_level = password_data->access_level;
+	if (password_data->access_level >= LEVEL_1_ENCRYPTION)
+		prepare_aes_decrypt_key(&decryption->level_1, password_data->level_1_encryption_key);
+	if (password_data->access_level >= LEVEL_2_ENCRYPTION)
+		prepare_aes_decrypt_key(&decryption->level_2, password_data->level_2_encryption_key);
+	
+}
+
+/**
+ * 	Decode a RED block (the equivalent of meflib's RED_decode)
+ *
+ *  The block is range decoded into the difference buffer as RED_decode does, after which the samples are 
+ *  reconstructed from the differences (vectorized where possible) and - if needed - unscaled and retrended
+ *  in a single pass. The CRC is not checked here, the read pipeline checks it beforehand (check_block).
+ *
+ *  Instead of scanning the cumulative counts for each decoded symbol, the range decoder looks up the symbol 
+ *  in a table that is built from the statistics of the block. The table divides the range of cumulative counts
+ *  into (at most) RED_SYMBOL_LOOKUP_ENTRIES buckets, each holding the first symbol that can occur within the 
+ *  bucket, from which at most a few symbols have to be stepped over.
+ *
+ * 	@param rps                  Pointer to the RED processing struct, with the block header, difference buffer and output set
+ * 	@param context              Pointer to the meflib settings of the channel's session (for the recording time offset)
+ * 	@param decryption           Pointer to the prepared keys to decrypt encrypted blocks with (NULL = no access to encrypted blocks)
+ * 	@return                     True if the block was decoded, false if the block is encrypted and there is no access to
+ *                              its encryption level (the encryption level directive of the rps is then positive), or if
+ *                              the (decrypted) statistics of the block hold no counts, the block is then left undecoded
+ */
+bool decode_red_block(RED_PROCESSING_STRUCT *rps, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption) {
+	ui1					*ui1_p, *ib_p, in_byte, *scaled_counts;
+	AES_DECRYPT_KEY		*key;
+	si1					*diff_buffer_p;
+	si8					i;
+	ui4					cc, *cumulative_counts, low_bound, range, symbol;
+	ui4					scaled_total_counts, temp_ui4, range_per_count, *ui4_p1, *ui4_p2;
+	ui1					symbol_lookup[RED_SYMBOL_LOOKUP_ENTRIES];
+	ui4					lookup_shift, bucket;
+	RED_BLOCK_HEADER	*block_header = rps->block_header;
+	
+	// decrypt
+	if (block_header->flags & RED_LEVEL_1_ENCRYPTION_MASK) {
+		rps->directives.encryption_level = LEVEL_1_ENCRYPTION;
+		key = (decryption == NULL) ? NULL : &decryption->level_1;
+	} else if (block_header->flags & RED_LEVEL_2_ENCRYPTION_MASK) {
+		rps->directives.encryption_level = LEVEL_2_ENCRYPTION;
+		key = (decryption == NULL) ? NULL : &decryption->level_2;
+	} else {
+		rps->directives.encryption_level = NO_ENCRYPTION;
+		key = NULL;
+	}
+	if (rps->directives.encryption_level > NO_ENCRYPTION) {
+		if (key != NULL && decryption->access_level >= rps->directives.encryption_level) {
+			aes_decrypt_block(key, block_header->statistics, block_header->statistics);
+			block_header->flags &= ~RED_LEVEL_1_ENCRYPTION_MASK;
+			block_header->flags &= ~RED_LEVEL_2_ENCRYPTION_MASK;
+			rps->directives.encryption_level = -rps->directives.encryption_level;   // mark as decrypted
+		} else {
+			return false;
+		}
+	}
+	
+	// offset recording time
+	offset_block_start_time(block_header, context);
+	
+	// discontinuity
+	if (block_header->flags & RED_DISCONTINUITY_MASK)
+		rps->directives.discontinuity = MEF_TRUE;
+	else
+		rps->directives.discontinuity = MEF_FALSE;
+	
+	// if no samples, just return
+	if (block_header->number_of_samples == 0)
+		return true;
+	
+	// range decode difference data
+	ui1_p = scaled_counts = block_header->statistics;
+	*(ui4_p1 = cumulative_counts = rps->counts) = 0;
+	ui4_p2 = ui4_p1 + 1;
+	for (i = RED_BLOCK_STATISTICS_BYTES; i--;)
+		*ui4_p2++ = *ui4_p1++ + (ui4) *ui1_p++;
+	scaled_total_counts = *ui4_p1;
+	
+	// statistics without counts cannot be range decoded (corrupt block)
+	if (scaled_total_counts == 0 && block_header->difference_bytes > 0)
+		return false;
+	
+	// build the symbol lookup table, the symbol for a cumulative count (cc) is the last symbol
+	// whose cumulative count is <= cc, the table holds that symbol for the start of each bucket
+	lookup_shift = 0;
+	while (lookup_shift < 31 && ((scaled_total_counts - 1) >> lookup_shift) >= RED_SYMBOL_LOOKUP_ENTRIES)
+		lookup_shift++;
+	symbol = 0;
+	for (bucket = 0; bucket < RED_SYMBOL_LOOKUP_ENTRIES; bucket++) {
+		while (symbol < 255 && cumulative_counts[symbol + 1] <= (bucket << lookup_shift))
+			symbol++;
+		symbol_lookup[bucket] = (ui1) symbol;
+	}
+	
+	diff_buffer_p = rps->difference_buffer;
+	*diff_buffer_p++ = -128; // initial keysample flag not coded in encode
+	
+	ib_p = (ui1 *) rps->block_header + RED_BLOCK_HEADER_BYTES;
+	in_byte = *ib_p++;
+	low_bound = in_byte >> (8 - EXTRA_BITS);
+	range = (ui4) 1 << EXTRA_BITS;
+	for (i = block_header->difference_bytes; i--;) { 
+		while (range <= BOTTOM_VALUE) {
+			low_bound = (low_bound << 8) | ((in_byte << EXTRA_BITS) & 0xff);
+			// check to see if we are still within the bounds of the compressed data (prevents a buffer-overrun)
+			if ((ib_p - ((ui1*)rps->block_header)) <= (block_header->block_bytes - 1))
+				in_byte = *ib_p++;
+			else
+				in_byte = 0; // give it a dummy byte, since there is no more data in the block.
+			low_bound |= in_byte >> (8 - EXTRA_BITS);
+			range <<= 8;
+		}
+		temp_ui4 = low_bound / (range_per_count = range / scaled_total_counts);
+		cc = (temp_ui4 >= scaled_total_counts ? (scaled_total_counts - 1) : temp_ui4);
+		symbol = symbol_lookup[cc >> lookup_shift];
+		while (cumulative_counts[symbol + 1] <= cc)
+			symbol++;
+		low_bound -= (temp_ui4 = range_per_count * cumulative_counts[symbol]);
+		if (symbol < 255)
+			range = range_per_count * scaled_counts[symbol];
+		else
+			range -= temp_ui4;
+		*diff_buffer_p++ = symbol;
+	}
+	
+	// generate output from difference data
+	reconstruct_samples(rps->difference_buffer, block_header->number_of_samples, rps->decompressed_ptr);
+	
+	// unscale and/or retrend the samples (in place)
+	if ((block_header->scale_factor > (sf4) 1.0) || (block_header->detrend_slope != (sf4) 0.0) || (block_header->detrend_intercept != (sf4) 0.0))
+		unscale_retrend_samples(rps->decompressed_ptr, block_header->number_of_samples,
+								(block_header->scale_factor > (sf4) 1.0) ? (sf8) block_header->scale_factor : (sf8) 1.0,
+								(sf8) block_header->detrend_slope, (sf8) block_header->detrend_intercept);
+	
+	return true;
+	
+}
+
+/**
+ * 	Apply or remove the recording time offset to/from the start time of a RED block (in place), as set in the context
+ *
+ * 	@param block_header         Pointer to the RED block header
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ */
+void offset_block_start_time(RED_BLOCK_HEADER *block_header, READ_CONTEXT *context) {
+	if (context->recording_time_offset_mode & (RTO_APPLY | RTO_APPLY_ON_INPUT))
+		apply_context_time_offset(context, &block_header->start_time);
+	else if (context->recording_time_offset_mode & (RTO_REMOVE | RTO_REMOVE_ON_INPUT))
+		remove_context_time_offset(context, &block_header->start_time);
+}
+
+/**
+ * 	Copy the samples of a block from the cache of decoded blocks, instead of decoding the block
+ *  (the header of the block is updated as decode_red_block would, i.e. the recording time offset of the start time)
+ *
+ * 	@param rps                  Pointer to the RED processing struct, which points to the block and the output
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ * 	@param cached               The (decoded) samples of the block in the cache
+ */
+void copy_cached_block(RED_PROCESSING_STRUCT *rps, READ_CONTEXT *context, si4 *cached) {
+	offset_block_start_time(rps->block_header, context);
+	memcpy(rps->decompressed_ptr, cached, (size_t) rps->block_header->number_of_samples * sizeof(si4));
+}
+
+/**
+ * 	Reconstruct the samples of a RED block from its differences
+ *
+ *  The differences are single (signed) bytes that are added to the previous sample, a value of -128 marks a 
+ *  keysample which is followed by the four bytes of the sample itself. Runs of 16 differences without a keysample 
+ *  are summed (prefix sum) with SSE2, the remaining differences and the keysamples are handled one at a time.
+ *
+ * 	@param differences          Pointer to the differences (starting with the keysample flag of the first sample)
+ * 	@param number_of_samples    The number of samples to reconstruct
+ * 	@param output               Pointer to the output buffer (should hold at least number_of_samples samples)
+ */
+void reconstruct_samples(si1 *differences, ui4 number_of_samples, si4 *output) {
+	si1		*diff_p = differences;
+	si4		*out_p = output;
+	si4		current_val = 0;
+	ui4		remaining = number_of_samples;
+	
+#ifdef MATMEF_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i keysample_flag = _mm_set1_epi8(-128);
+#endif
+	
+	while (remaining > 0) {
+		
+#ifdef MATMEF_SSE2
+		// sum runs of 16 differences without keysamples (every remaining sample has at least
+		// one byte of difference data, so the 16 bytes are always within the differences)
+		while (remaining >= 16) {
+			__m128i diffs = _mm_loadu_si128((const __m128i *) diff_p);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(diffs, keysample_flag)) != 0)
+				break;
+			
+			// sign-extend to 16 bits, and prefix sum each half (16 differences always fit in 16 bits)
+			__m128i sign = _mm_cmpgt_epi8(zero, diffs);
+			__m128i lo = _mm_unpacklo_epi8(diffs, sign);
+			__m128i hi = _mm_unpackhi_epi8(diffs, sign);
+			lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 2));
+			hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 2));
+			lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 4));
+			hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 4));
+			lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 8));
+			
+			// carry the sum of the first half into the second
+			__m128i lo_total = _mm_shufflehi_epi16(lo, 0xFF);
+			hi = _mm_add_epi16(hi, _mm_unpackhi_epi64(lo_total, lo_total));
+			
+			// sign-extend to 32 bits and add the previous sample
+			__m128i carry = _mm_set1_epi32(current_val);
+			__m128i out0 = _mm_add_epi32(carry, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16));
+			__m128i out1 = _mm_add_epi32(carry, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16));
+			__m128i out2 = _mm_add_epi32(carry, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16));
+			__m128i out3 = _mm_add_epi32(carry, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16));
+			_mm_storeu_si128((__m128i *) out_p, out0);
+			_mm_storeu_si128((__m128i *) (out_p + 4), out1);
+			_mm_storeu_si128((__m128i *) (out_p + 8), out2);
+			_mm_storeu_si128((__m128i *) (out_p + 12), out3);
+			current_val = out_p[15];
+			
+			diff_p += 16;
+			out_p += 16;
+			remaining -= 16;
+		}
+		if (remaining == 0)
+			break;
+#endif
+		
+		// a single sample, either a keysample or a difference
+		if (*diff_p == -128) {
+			memcpy(&current_val, diff_p + 1, sizeof(si4));
+			diff_p += 5;
+		} else
+			current_val += (si4) *diff_p++;
+		*out_p++ = current_val;
+		remaining--;
+		
+	}
+	
+}
+
+/**
+ * 	Unscale and retrend the samples of a RED block in a single pass (the equivalent of RED_unscale followed by RED_retrend)
+ *
+ * 	@param samples              Pointer to the samples (which are updated in place)
+ * 	@param number_of_samples    The number of samples
+ * 	@param scale_factor         The scale factor of the block (1 = not scaled)
+ * 	@param slope                The detrend slope of the block
+ * 	@param intercept            The detrend intercept of the block
+ */
+void unscale_retrend_samples(si4 *samples, ui4 number_of_samples, sf8 scale_factor, sf8 slope, sf8 intercept) {
+	ui4		i;
+	sf8		c = 0.0;
+	bool	scaled = (scale_factor != 1.0);
+	bool	trended = (slope != 0.0 || intercept != 0.0);
+	
+	for (i = 0; i < number_of_samples; i++) {
+		si4 val = samples[i];
+		if (scaled)
+			val = RED_round((sf8) val * scale_factor);
+		if (trended) {
+			c += (sf8) 1.0;
+			val = RED_round((sf8) val + (slope * c) + intercept);
+		}
+		samples[i] = val;
+	}
+	
+}
+
+/**
+ * 	Worker that checks and decodes a contiguous range of planned blocks
+ *  (with its own RED processing struct and difference buffer)
+ *
+ * 	@param arg                  Pointer to the DECODE_WORKER struct with the range of blocks to decode
+ */
+void decode_blocks_worker(void *arg) {
+	DECODE_WORKER *worker = (DECODE_WORKER *) arg;
+	ui8 i;
+	
+	worker->failed_block = -1;
+	worker->no_access = false;
+	worker->success = true;
+	if (worker->num_blocks == 0)	return;
+	
+    // create a RED processing struct for this worker
+    RED_PROCESSING_STRUCT *rps = (RED_PROCESSING_STRUCT *) calloc((size_t) 1, sizeof(RED_PROCESSING_STRUCT));
+	if (rps == NULL) {
+		worker->success = false;
+		return;
+	}
+    rps->compression.mode = RED_DECOMPRESSION;
+    rps->difference_buffer = (si1 *) calloc((size_t) RED_MAX_DIFFERENCE_BYTES(worker->max_samps) + 1, sizeof(ui1));
+	if (rps->difference_buffer == NULL) {
+		free (rps);
+		worker->success = false;
+		return;
+	}
+	
+	// check and decode each block
+	for (i = 0; i < worker->num_blocks; i++) {
+		DECODE_BLOCK *block = &worker->blocks[i];
+		
+		// copy a block that is in the cache (it was checked when it was decoded)
+		if (block->cached != NULL) {
+			offset_block_start_time((RED_BLOCK_HEADER *) block->block, worker->context);
+			memcpy(block->output, block->cached, (size_t) ((RED_BLOCK_HEADER *) block->block)->number_of_samples * sizeof(si4));
+			continue;
+		}
+		
+		if (!check_block(block->block, worker->max_samps, worker->compressed_data, worker->compressed_bytes, worker->validate_crc)) {
+			worker->failed_block = block->block_index;
+			worker->success = false;
+			break;
+		}
+		
+		// decode the block if it has a destination
+		if (block->output != NULL) {
+			rps->compressed_data = block->block;
+			rps->block_header = (RED_BLOCK_HEADER *) rps->compressed_data;
+			rps->decompressed_ptr = rps->decompressed_data = block->output;
+			if (!decode_red_block(rps, worker->context, worker->decryption)) {
+				worker->failed_block = block->block_index;
+				worker->no_access = (rps->directives.encryption_level > NO_ENCRYPTION);
+				worker->success = false;
+				break;
+			}
+		}
+		
+	}
+	
+	// 
+	free (rps->difference_buffer);
+	free (rps);
+	
+}
+
+/**
+ * 	Check and decode planned RED blocks straight into their output positions
+ *
+ *  The blocks are divided into contiguous ranges, one for each thread. Each thread uses its own RED processing 
+ *  struct and difference buffer, the output is therefore identical to decoding the blocks one by one. Note that 
+ *  the blocks are decoded concurrently, so the output positions of the blocks should not overlap.
+ *
+ * 	@param blocks               The planned blocks (blocks without an output position are only checked)
+ * 	@param num_blocks           The number of planned blocks
+ * 	@param max_samps            The maximum number of samples in a block (for the channel)
+ * 	@param compressed_data      Pointer to the start of the compressed data buffer that holds the blocks
+ * 	@param compressed_bytes     The size of the compressed data buffer (in bytes)
+ * 	@param validate_crc         Whether to validate the CRC of each block (false = only the structure of the blocks is checked)
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ * 	@param decryption           Pointer to the prepared keys to decrypt encrypted blocks with
+ * 	@param num_threads          The number of threads to decode with (0 = one per processor)
+ * 	@param failed_block         Pointer to a variable that will hold the index of the first block that failed the 
+ *                              check or could not be decrypted (or -1 if no block failed, e.g. on a memory allocation error)
+ * 	@param no_access            Pointer to a variable that will hold whether the failed block could not be decrypted
+ *                              (no access to its encryption level)
+ * 	@return                     True if all blocks were checked and decoded, false on failure
+ */
+bool decode_blocks(DECODE_BLOCK *blocks, ui8 num_blocks, ui4 max_samps, ui1 *compressed_data, ui8 compressed_bytes, bool validate_crc, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption, si4 num_threads, si8 *failed_block, bool *no_access) {
+	si4 i;
+	
+	*failed_block = -1;
+	*no_access = false;
+	if (num_blocks == 0)	return true;
+	
+	// determine the number of threads and the number of blocks per thread
+	num_threads = resolve_number_of_threads(num_threads, (si8) num_blocks);
+	ui8 blocks_per_thread = (num_blocks + num_threads - 1) / num_threads;
+	
+	// divide the blocks over the workers
+	DECODE_WORKER *workers = (DECODE_WORKER *) calloc((size_t) num_threads, sizeof(DECODE_WORKER));
+	if (workers == NULL)	return false;
+	for (i = 0; i < num_threads; i++) {
+		ui8 first = i * blocks_per_thread;
+		if (first > num_blocks)		first = num_blocks;
+		ui8 last = first + blocks_per_thread;
+		if (last > num_blocks)		last = num_blocks;
+		
+		workers[i].blocks = blocks + first;
+		workers[i].num_blocks = last - first;
+		workers[i].max_samps = max_samps;
+		workers[i].compressed_data = compressed_data;
+		workers[i].compressed_bytes = compressed_bytes;
+		workers[i].validate_crc = validate_crc;
+		workers[i].context = context;
+		workers[i].decryption = decryption;
+	}
+	
+	// run the workers
+	run_threads(num_threads, decode_blocks_worker, workers, sizeof(DECODE_WORKER));
+	
+	// check the result (report the first block that failed)
+	bool success = true;
+	for (i = 0; i < num_threads; i++) {
+		if (!workers[i].success) {
+			success = false;
+			*failed_block = workers[i].failed_block;
+			*no_access = workers[i].no_access;
+			break;
+		}
+	}
+	
+	free (workers);
+	return success;
+	
+}
+
+
+// 
+// Pyramid reads
+//
+
+// Pyramid read output struct
+const int PYRAMID_NUMFIELDS				= 5;
+const char *PYRAMID_FIELDNAMES[] 		= {	
+	"time",
+	"numSamples",
+	"mean",
+	"min",
+	"max"
+};
+
+// the part of a segment that is read in a pyramid read, and the level it is read from
+typedef struct {
+	ui4				segment;
+	FILE			*fp;				// the pyramid sidecar of the segment (NULL if none, the full-rate data is read then)
+	PYRAMID_HEADER	header;
+	si4				level;				// the level that is read (-1 = the full-rate data, decimated by the factor if above 1)
+	si8				factor;
+	si8				first_point;		// the range of points to read from the level (in the segment)
+	si8				num_points;
+} PYRAMID_READ;
+
+
+/**
+ * 	Read a decimated (mean, minimum and maximum) version of the channel data from a channel filepath, given a time range 
+ *	and a requested number of points (e.g. the number of pixels to draw). See read_channel_pyramid_from_object
+ *
+ * 	@param channel_path         The path to the channel directory
+ * 	@param password             Password for the MEF3 datafiles (no password = NULL)
+ *	@param range_start          Start of the time range (as an epoch/unix timestamp; -1 for first)
+ *	@param range_end            End of the time range (as an epoch/unix timestamp; -1 for last)
+ *	@param num_points           The requested number of points (the output has at least this many points, unless the range holds fewer samples)
+ *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ *  @param validate_crc         Whether to validate the CRC of each block (false = trusted read, only the structure of the blocks is checked)
+ * 	@return                     Pointer to a matlab struct (mxArray) containing the points, or NULL on failure
+ */
+mxArray *read_channel_pyramid_from_path(si1 *channel_path, si1 *password, si8 range_start, si8 range_end, si8 num_points, bool apply_conv_factor, si4 num_threads, bool validate_crc) {
+
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	initialize_crc_tables();
+	
+	// read the channel metadata
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	CHANNEL *channel = read_MEF_channel(NULL, channel_path, TIME_SERIES_CHANNEL_TYPE, password, NULL, MEF_FALSE, MEF_FALSE);
+	
+	// check the number of segments
+	if (channel->number_of_segments == 0) {
+		mexPrintf("Error: no segments in channel, most likely due to an invalid channel folder, exiting...\n");
+		free_channel(channel, MEF_TRUE);
+        return NULL;
+	}
+	
+	// check if the data is encrypted and/or the correctness of password
+	if (channel->metadata.section_1->section_2_encryption > 0) {
+		if (password == NULL)
+			mexPrintf("Error: data is encrypted, but no password is given, exiting...\n");
+		else
+			mexPrintf("Error: wrong password for encrypted data, exiting...\n");
+		channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
+		free_channel(channel, MEF_TRUE);
+		return NULL;
+	}
+	
+	// read the pyramid by the channel object (with the settings of the channel's session)
+	READ_CONTEXT context;
+	capture_read_context(&context);
+	mxArray *points_read = read_channel_pyramid_from_object(channel, NULL, &context, range_start, range_end, num_points, apply_conv_factor, num_threads, validate_crc);
+	
+	// free the channel object memory
+	channel->segments[0].metadata_fps->directives.free_password_data = MEF_TRUE;
+	free_channel(channel, MEF_TRUE);
+	
+	return points_read;
+	
+}
+
+/**
+ * 	Read a decimated (mean, minimum and maximum) version of the channel data based on a channel object, given a time 
+ *	range and a requested number of points (e.g. the number of pixels to draw)
+ *	
+ *	Each segment is read from the coarsest level in its pyramid sidecar (see build_channel_pyramid) that still yields 
+ *	at least the requested number of points over the range; so the output holds between the requested number and 
+ *	PYRAMID_DECIMATION times as many points. Segments without an (up-to-date) pyramid are decimated from the full-rate
+ *	data instead, to the same points as the level would hold (slower, but the output is just as large). Ranges that 
+ *	hold too few samples to decimate are read from the full-rate data (with the mean, minimum and maximum of each point
+ *	being the sample itself). The points cover whole decimation groups, and can therefore extend slightly past the range.
+ *
+ *	Note: this function does not free the memory of the given channel object (that is up to the function's caller)
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel, or NULL to build one for this read only
+ * 	@param context              Pointer to the meflib settings of the channel's session (see capture_read_context)
+ *	@param range_start          Start of the time range (as an epoch/unix timestamp; -1 for first)
+ *	@param range_end            End of the time range (as an epoch/unix timestamp; -1 for last)
+ *	@param num_points           The requested number of points
+ *  @param apply_conv_factor    Whether to apply the unit conversion factor from the channel metadata
+ *  @param num_threads          The number of threads used to decode the data (1 = single-threaded; 0 = one per processor)
+ *  @param validate_crc         Whether to validate the CRC of each block (false = trusted read, only the structure of the blocks is checked)
+ * 	@return                     Pointer to a matlab struct (mxArray) with the start time, number of samples, mean, 
+ *								minimum and maximum of each point, or NULL on failure
+ */
+mxArray *read_channel_pyramid_from_object(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, si8 range_start, si8 range_end, si8 num_points, bool apply_conv_factor, si4 num_threads, bool validate_crc) {
+	ui4		i;
+	si4		l;
+	si8		p;
+	bool	success = true;
+	
+	// build a lookup table of the blocks for this call if none was given
+	BLOCK_LOOKUP local_lookup;
+	BLOCK_LOOKUP *own_lookup = NULL;
+	if (lookup == NULL) {
+		if (!build_block_lookup(channel, context, &local_lookup)) {
+			mexPrintf("Error: could not build the block lookup table, exiting...\n");
+			return NULL;
+		}
+		lookup = own_lookup = &local_lookup;
+	}
+	
+	// determine the range in samples
+	si8 start_samp = (range_start < 0) ? lookup->segment_start_sample[0] : sample_for_uutc_c(range_start, lookup);
+	si8 end_samp = (range_end < 0) ? lookup->segment_end_sample[lookup->num_segments - 1] : sample_for_uutc_c(range_end, lookup);
+	if (end_samp < start_samp)		end_samp = start_samp;
+	if (num_points < 1)				num_points = 1;
+	si8 samples_per_point = (end_samp - start_samp) / num_points;
+	
+	// plan the read of each segment that overlaps with the range
+	PYRAMID_READ *reads = (PYRAMID_READ *) calloc((size_t) lookup->num_segments, sizeof(PYRAMID_READ));
+	if (reads == NULL) {
+		mexPrintf("Error: could not allocated enough memory, exiting....\n");
+		if (own_lookup != NULL)		free_block_lookup(own_lookup);
+		return NULL;
+	}
+	ui4 num_reads = 0;
+	si8 total_points = 0;
+	for (i = 0; i < lookup->num_segments; i++) {
+		si8 seg_start = (start_samp > lookup->segment_start_sample[i]) ? start_samp : lookup->segment_start_sample[i];
+		si8 seg_end = (end_samp < lookup->segment_end_sample[i]) ? end_samp : lookup->segment_end_sample[i];
+		if (seg_end <= seg_start)	continue;
+		seg_start -= lookup->segment_start_sample[i];
+		seg_end -= lookup->segment_start_sample[i];
+		
+		// select the level (the pyramid is only opened when a level can be used)
+		PYRAMID_READ *read = &reads[num_reads++];
+		read->segment = i;
+		read->level = -1;
+		read->factor = 1;
+		if (samples_per_point >= PYRAMID_DECIMATION) {
+			read->fp = open_segment_pyramid(&channel->segments[i], &read->header);
+			if (read->fp != NULL)
+				read->level = select_pyramid_level(&read->header, samples_per_point);
+			if (read->level >= 0) {
+				read->factor = read->header.levels[read->level].factor;
+			} else {
+				
+				// decimate the full-rate data by the factor of the level that would have been read
+				mexPrintf("Warning: no (up-to-date) pyramid for segment '%s', decimating the full-rate data instead (build the pyramid for faster reads)\n", channel->segments[i].name);
+				read->factor = PYRAMID_DECIMATION;
+				for (l = 1; l < PYRAMID_MAX_LEVELS && read->factor * PYRAMID_DECIMATION <= samples_per_point; l++)
+					read->factor *= PYRAMID_DECIMATION;
+				
+			}
+		}
+		
+		// the points to read
+		read->first_point = seg_start / read->factor;
+		read->num_points = ((seg_end + read->factor - 1) / read->factor) - read->first_point;
+		total_points += read->num_points;
+		
+	}
+	
+	// allocate the output
+	mxArray *mat_points = mxCreateStructMatrix(1, 1, PYRAMID_NUMFIELDS, PYRAMID_FIELDNAMES);
+	mxArray *mat_time = mxCreateNumericMatrix(1, total_points, mxINT64_CLASS, mxREAL);
+	mxArray *mat_samples = mxCreateDoubleMatrix(1, total_points, mxREAL);
+	mxArray *mat_mean = mxCreateDoubleMatrix(1, total_points, mxREAL);
+	mxArray *mat_min = mxCreateDoubleMatrix(1, total_points, mxREAL);
+	mxArray *mat_max = mxCreateDoubleMatrix(1, total_points, mxREAL);
+	mxSetField(mat_points, 0, "time", mat_time);
+	mxSetField(mat_points, 0, "numSamples", mat_samples);
+	mxSetField(mat_points, 0, "mean", mat_mean);
+	mxSetField(mat_points, 0, "min", mat_min);
+	mxSetField(mat_points, 0, "max", mat_max);
+	si8 *out_time = (si8 *) mxGetData(mat_time);
+	sf8 *out_samples = mxGetPr(mat_samples);
+	sf8 *out_mean = mxGetPr(mat_mean);
+	sf8 *out_min = mxGetPr(mat_min);
+	sf8 *out_max = mxGetPr(mat_max);
+	
+	// the conversion factor (a negative factor swaps the minimum and maximum)
+	sf8 fac = (apply_conv_factor) ? channel->metadata.time_series_section_2->units_conversion_factor : 1.0;
+	
+	// read the points of each segment
+	BLOCK_DECRYPTION decryption;
+	prepare_block_decryption(&decryption, channel->segments[0].metadata_fps->password_data);
+	si8 offset = 0;
+	for (i = 0; success && i < num_reads; i++) {
+		PYRAMID_READ *read = &reads[i];
+		si8 seg_start_sample = lookup->segment_start_sample[read->segment];
+		si8 seg_samples = lookup->segment_end_sample[read->segment] - seg_start_sample;
+		if (read->num_points == 0)	continue;
+		
+		// allocate a buffer for the points of each stream
+		si4 *buffer = (si4 *) malloc((size_t) (read->num_points * PYRAMID_STREAMS) * sizeof(si4));
+		if (buffer == NULL) {
+			mexPrintf("Error: could not allocated enough memory, exiting....\n");
+			success = false;
+			break;
+		}
+		si4 *mean = buffer, *min = buffer + read->num_points, *max = buffer + 2 * read->num_points;
+		
+		if (read->level < 0 && read->factor > 1) {
+			
+			// decimate the points from the full-rate samples
+			success = decimate_segment_points(channel, lookup, context, read->segment, read->factor, read->first_point, read->num_points, mean, min, max, validate_crc, num_threads);
+			
+		} else if (read->level < 0) {
+			
+			// read the full-rate samples (each sample is a point)
+			CHANNEL_READ samples_read;
+			success = prepare_channel_read(channel, lookup, context, RANGE_BY_SAMPLES, seg_start_sample + read->first_point, seg_start_sample + read->first_point + read->num_points, &samples_read);
+			if (success) {
+				samples_read.validate_crc = validate_crc;
+				samples_read.output_initialized = false;
+				success = read_channel_samples(channel, &samples_read, mean, num_threads);
+				if (samples_read.message[0] != '\0')
+					mexPrintf("%s", samples_read.message);
+			}
+			if (success) {
+				memcpy(min, mean, (size_t) read->num_points * sizeof(si4));
+				memcpy(max, mean, (size_t) read->num_points * sizeof(si4));
+			}
+			
+		} else {
+			
+			// read the points from the level of the pyramid
+			success = read_pyramid_points(read->fp, &read->header, read->level, read->first_point, read->num_points, mean, min, max, validate_crc, context, &decryption, num_threads);
+			if (!success)
+				mexPrintf("Error: could not read the pyramid of segment '%s' (it might be corrupt, try rebuilding it), exiting...\n", channel->segments[read->segment].name);
+			
+		}
+		
+		// transfer the points to the output
+		for (p = 0; success && p < read->num_points; p++) {
+			si8 point_sample = (read->first_point + p) * read->factor;
+			out_time[offset + p] = uutc_for_sample_c(seg_start_sample + point_sample, lookup);
+			out_samples[offset + p] = (sf8) ((seg_samples - point_sample < read->factor) ? seg_samples - point_sample : read->factor);
+			out_mean[offset + p] = mean[p] * fac;
+			out_min[offset + p] = (fac < 0 ? max[p] : min[p]) * fac;
+			out_max[offset + p] = (fac < 0 ? min[p] : max[p]) * fac;
+		}
+		offset += read->num_points;
+		free (buffer);
+		
+	}
+	
+	// clean up
+	for (i = 0; i < num_reads; i++)
+		if (reads[i].fp != NULL)	fclose(reads[i].fp);
+	free (reads);
+	if (own_lookup != NULL)		free_block_lookup(own_lookup);
+	if (!success) {
+		mxDestroyArray(mat_points);
+		return NULL;
+	}
+	
+	return mat_points;
+	
+}
+
+/**
+ * 	Determine the path of the pyramid sidecar of a segment (next to the segment's data file)
+ *
+ * 	@param segment              Pointer to the MEF segment object
+ * 	@param path                 The buffer (of MEF_FULL_FILE_NAME_BYTES) that will hold the path
+ */
+void pyramid_file_path(SEGMENT *segment, si1 *path) {
+	MEF_strncpy(path, segment->time_series_data_fps->full_file_name, MEF_FULL_FILE_NAME_BYTES);
+	
+	// replace the extension of the data file
+	si1 *ext = strrchr(path, '.');
+	if (ext != NULL && strlen(path) - (size_t) (ext - path) == TYPE_BYTES)
+		MEF_strcpy(ext + 1, PYRAMID_FILE_TYPE_STRING);
+	
+}
+
+/**
+ * 	Open the pyramid sidecar of a segment and read its header, if the pyramid exists and is up-to-date (was built 
+ *	from the current data of the segment)
+ *
+ * 	@param segment              Pointer to the MEF segment object
+ * 	@param header               Pointer to the header struct that will hold the header of the pyramid
+ * 	@return                     The opened pyramid file (to be closed by the caller), or NULL if there is no valid pyramid
+ */
+FILE *open_segment_pyramid(SEGMENT *segment, PYRAMID_HEADER *header) {
+	si1		path[MEF_FULL_FILE_NAME_BYTES];
+	
+	pyramid_file_path(segment, path);
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL)		return NULL;
+	
+	// read and check the header (the data of the segment should not have changed since the pyramid was built)
+	if (fread(header, sizeof(PYRAMID_HEADER), 1, fp) != 1							||
+		memcmp(header->magic, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC)) != 0			||
+		header->version != PYRAMID_VERSION											||
+		header->decimation != PYRAMID_DECIMATION									||
+		header->number_of_levels > PYRAMID_MAX_LEVELS								||
+		header->block_points < 1 || header->block_points > PYRAMID_BLOCK_POINTS		||
+		header->number_of_samples != segment->metadata_fps->metadata.time_series_section_2->number_of_samples	||
+		header->source_body_CRC != segment->time_series_data_fps->universal_header->body_CRC) {
+		fclose(fp);
+		return NULL;
+	}
+	
+	return fp;
+	
+}
+
+/**
+ * 	Select the coarsest level in a pyramid of which the points are decimated from at most a given number of samples
+ *
+ * 	@param header               Pointer to the header of the pyramid
+ * 	@param samples_per_point    The maximum number of samples per point
+ * 	@return                     The index of the level, or -1 if no level qualifies
+ */
+si4 select_pyramid_level(PYRAMID_HEADER *header, si8 samples_per_point) {
+	si4 level = -1;
+	for (ui4 i = 0; i < header->number_of_levels; i++)
+		if (header->levels[i].factor <= samples_per_point)
+			level = (si4) i;
+	return level;
+}
+
+/**
+ * 	Read and decode a range of points from a level of a pyramid (the means, minima and maxima)
+ *
+ * 	@param fp                   The opened pyramid file
+ * 	@param header               Pointer to the header of the pyramid
+ * 	@param level                The index of the level
+ * 	@param first_point          The first point to read (in the level)
+ * 	@param num_points           The number of points to read
+ * 	@param mean                 The buffer that will hold the means of the points
+ * 	@param min                  The buffer that will hold the minima of the points
+ * 	@param max                  The buffer that will hold the maxima of the points
+ * 	@param validate_crc         Whether to validate the CRC of each block (false = only the structure of the blocks is checked)
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ * 	@param decryption           Pointer to the prepared keys to decrypt encrypted blocks with
+ * 	@param num_threads          The number of threads to decode with (0 = one per processor)
+ * 	@return                     True if successful, false on failure
+ */
+bool read_pyramid_points(FILE *fp, PYRAMID_HEADER *header, si4 level, si8 first_point, si8 num_points, si4 *mean, si4 *min, si4 *max, bool validate_crc, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption, si4 num_threads) {
+	si8		b;
+	si4		s;
+	
+	PYRAMID_LEVEL *lvl = &header->levels[level];
+	if (num_points < 1)		return true;
+	if (first_point < 0 || first_point + num_points > lvl->number_of_points)
+		return false;
+	
+	// read the indices of the blocks that hold the points
+	si8 first_block = first_point / header->block_points;
+	// (the number of blocks in the level comes from the sidecar, so should also match the number of points)
+	si8 num_blocks = ((first_point + num_points - 1) / header->block_points) - first_block + 1;
+	if (lvl->number_of_blocks != (lvl->number_of_points + header->block_points - 1) / header->block_points)
+		return false;
+	if (num_blocks < 1 || num_blocks > lvl->number_of_blocks || first_block + num_blocks > lvl->number_of_blocks)
+		return false;
+	size_t num_alloc_blocks = (size_t) num_blocks;
+	PYRAMID_INDEX *indices = (PYRAMID_INDEX *) malloc(num_alloc_blocks * sizeof(PYRAMID_INDEX));
+	if (indices == NULL)	return false;
+	if (!read_file_at(fp, (ui8) (lvl->index_offset + first_block * (si8) sizeof(PYRAMID_INDEX)), indices, (ui8) num_blocks * sizeof(PYRAMID_INDEX))) {
+		free (indices);
+		return false;
+	}
+	
+	// read the blocks into one buffer
+	ui8 total_bytes = 0;
+	for (b = 0; b < num_blocks; b++)
+		total_bytes += indices[b].block_bytes;
+	ui1 *data = (ui1 *) malloc((size_t) total_bytes);
+	si4 *points = (si4 *) malloc(num_alloc_blocks * header->block_points * PYRAMID_STREAMS * sizeof(si4));
+	DECODE_BLOCK *blocks = (DECODE_BLOCK *) calloc(num_alloc_blocks * PYRAMID_STREAMS, sizeof(DECODE_BLOCK));
+	bool success = (data != NULL && points != NULL && blocks != NULL);
+	
+	// plan the RED block of each stream (all points of a stream are decoded consecutively)
+	ui8 data_offset = 0;
+	for (b = 0; success && b < num_blocks; b++) {
+		PYRAMID_INDEX *index = &indices[b];
+		if (index->number_of_points > header->block_points || !read_file_at(fp, (ui8) index->file_offset, data + data_offset, index->block_bytes)) {
+			success = false;
+			break;
+		}
+		
+		ui1 *block = data + data_offset;
+		for (s = 0; s < PYRAMID_STREAMS; s++) {
+			RED_BLOCK_HEADER *block_header = (RED_BLOCK_HEADER *) block;
+			if (block + RED_BLOCK_HEADER_BYTES > data + data_offset + index->block_bytes || block_header->number_of_samples != index->number_of_points) {
+				success = false;
+				break;
+			}
+			blocks[s * num_blocks + b].block = block;
+			blocks[s * num_blocks + b].output = points + (s * num_blocks * header->block_points) + (b * header->block_points);
+			blocks[s * num_blocks + b].block_index = first_block + b;
+			block += block_header->block_bytes;
+		}
+		data_offset += index->block_bytes;
+		
+	}
+	
+	// decode
+	si8 failed_block;
+	bool no_access;
+	if (success)
+		success = decode_blocks(blocks, (ui8) (num_blocks * PYRAMID_STREAMS), header->block_points, data, total_bytes, validate_crc, context, decryption, num_threads, &failed_block, &no_access);
+	
+	// transfer the points (only the last block of a level can hold fewer points, so the points of each stream are consecutive)
+	if (success) {
+		si8 offset = first_point - first_block * header->block_points;
+		si8 stream_points = num_blocks * header->block_points;
+		memcpy(mean, points + (PYRAMID_STREAM_MEAN * stream_points) + offset, (size_t) num_points * sizeof(si4));
+		memcpy(min, points + (PYRAMID_STREAM_MIN * stream_points) + offset, (size_t) num_points * sizeof(si4));
+		memcpy(max, points + (PYRAMID_STREAM_MAX * stream_points) + offset, (size_t) num_points * sizeof(si4));
+	}
+	
+	free (indices);
+	free (data);
+	free (points);
+	free (blocks);
+	return success;
+	
+}
+
+/**
+ * 	Read and decimate a range of points from the full-rate data of a segment (for segments without a pyramid). The points
+ *	are decimated in the same way as the points of a pyramid level with the same factor (see build_segment_pyramid)
+ *
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param lookup               Pointer to the block lookup table of the channel
+ * 	@param context              Pointer to the meflib settings of the channel's session
+ * 	@param segment              The index of the segment
+ * 	@param factor               The number of samples that each point is decimated from (a power of PYRAMID_DECIMATION)
+ * 	@param first_point          The first point to read (in the segment)
+ * 	@param num_points           The number of points to read
+ * 	@param mean                 The buffer that will hold the means of the points
+ * 	@param min                  The buffer that will hold the minima of the points
+ * 	@param max                  The buffer that will hold the maxima of the points
+ * 	@param validate_crc         Whether to validate the CRC of each block (false = only the structure of the blocks is checked)
+ * 	@param num_threads          The number of threads to decode with (0 = one per processor)
+ * 	@return                     True if successful, false on failure
+ */
+bool decimate_segment_points(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui4 segment, si8 factor, si8 first_point, si8 num_points, si4 *mean, si4 *min, si4 *max, bool validate_crc, si4 num_threads) {
+	si4		l, num_levels;
+	si8		f, p, pos;
+	
+	si8 seg_start_sample = lookup->segment_start_sample[segment];
+	si8 seg_samples = lookup->segment_end_sample[segment] - seg_start_sample;
+	
+	// the number of levels that the samples are decimated through (the last level has the given factor)
+	for (num_levels = 0, f = 1; f < factor; num_levels++)
+		f *= PYRAMID_DECIMATION;
+	
+	// the number of samples to process at a time (whole points)
+	si8 chunk_samples = ((PYRAMID_BUILD_SAMPLES + factor - 1) / factor) * factor;
+	
+	// allocate the levels and the sample buffer
+	PYRAMID_BUILD_LEVEL levels[PYRAMID_MAX_LEVELS];
+	memset(levels, 0, sizeof(levels));
+	bool success = true;
+	for (l = 0, f = PYRAMID_DECIMATION; l < num_levels; l++, f *= PYRAMID_DECIMATION) {
+		si8 chunk_points = chunk_samples / f;
+		levels[l].factor = f;
+		levels[l].sums = (si8 *) malloc((size_t) chunk_points * sizeof(si8));
+		levels[l].counts = (si8 *) malloc((size_t) chunk_points * sizeof(si8));
+		levels[l].mins = (si4 *) malloc((size_t) chunk_points * sizeof(si4));
+		levels[l].maxs = (si4 *) malloc((size_t) chunk_points * sizeof(si4));
+		if (levels[l].sums == NULL || levels[l].counts == NULL || levels[l].mins == NULL || levels[l].maxs == NULL)
+			success = false;
+	}
+	si4 *samples = (si4 *) malloc((size_t) chunk_samples * sizeof(si4));
+	if (samples == NULL)
+		success = false;
+	if (!success)
+		mexPrintf("Error: could not allocated enough memory, exiting....\n");
+	
+	// read and decimate the samples a chunk at a time
+	si8 end_sample = (first_point + num_points) * factor;
+	if (end_sample > seg_samples)	end_sample = seg_samples;
+	si8 num_out = 0;
+	for (pos = first_point * factor; success && pos < end_sample; pos += chunk_samples) {
+		si8 num_samps = (end_sample - pos < chunk_samples) ? end_sample - pos : chunk_samples;
+		
+		// read the samples
+		CHANNEL_READ read;
+		success = prepare_channel_read(channel, lookup, context, RANGE_BY_SAMPLES, seg_start_sample + pos, seg_start_sample + pos + num_samps, &read);
+		if (success) {
+			read.validate_crc = validate_crc;
+			read.output_initialized = false;
+			success = read_channel_samples(channel, &read, samples, num_threads);
+			if (read.message[0] != '\0')
+				mexPrintf("%s", read.message);
+		}
+		if (!success)	break;
+		
+		// decimate, and transfer the points of the last level
+		decimate_pyramid_chunk(levels, num_levels, samples, num_samps);
+		PYRAMID_BUILD_LEVEL *level = &levels[num_levels - 1];
+		for (p = 0; p < level->chunk_points && num_out < num_points; p++, num_out++) {
+			mean[num_out] = pyramid_point_mean(level->sums[p], level->counts[p]);
+			min[num_out] = level->mins[p];
+			max[num_out] = level->maxs[p];
+		}
+		
+	}
+	
+	// clean up
+	for (l = 0; l < num_levels; l++) {
+		free (levels[l].sums);
+		free (levels[l].counts);
+		free (levels[l].mins);
+		free (levels[l].maxs);
+	}
+	free (samples);
+	
+	return success;
+	
+}
+
+/**
+ * 	Decimate a chunk of samples into the points (sum, minimum, maximum and number of samples) of each level. The first
+ *	level is decimated from the samples, and each next level from the points of the level before.
+ *
+ *	Note: only the last chunk of a segment can hold a number of samples that is not a multiple of the coarsest 
+ *	factor, so the points of all levels in the other chunks are whole
+ *
+ * 	@param levels               The levels (the points in the chunk are set for each)
+ * 	@param num_levels           The number of levels
+ * 	@param samples              The samples of the chunk
+ * 	@param num_samps            The number of samples in the chunk
+ */
+void decimate_pyramid_chunk(PYRAMID_BUILD_LEVEL *levels, si4 num_levels, si4 *samples, si8 num_samps) {
+	si4		l;
+	si8		p, i;
+	
+	// the first level, from the samples
+	PYRAMID_BUILD_LEVEL *level = &levels[0];
+	level->chunk_points = (num_samps + PYRAMID_DECIMATION - 1) / PYRAMID_DECIMATION;
+	for (p = 0; p < level->chunk_points; p++) {
+		si8 first = p * PYRAMID_DECIMATION;
+		si8 last = (first + PYRAMID_DECIMATION < num_samps) ? first + PYRAMID_DECIMATION : num_samps;
+		si8 sum = 0;
+		si4 min = samples[first], max = samples[first];
+		for (i = first; i < last; i++) {
+			sum += samples[i];
+			if (samples[i] < min)	min = samples[i];
+			if (samples[i] > max)	max = samples[i];
+		}
+		level->sums[p] = sum;
+		level->mins[p] = min;
+		level->maxs[p] = max;
+		level->counts[p] = last - first;
+	}
+	
+	// the next levels, from the points of the level before
+	for (l = 1; l < num_levels; l++) {
+		PYRAMID_BUILD_LEVEL *prev = &levels[l - 1];
+		level = &levels[l];
+		level->chunk_points = (prev->chunk_points + PYRAMID_DECIMATION - 1) / PYRAMID_DECIMATION;
+		for (p = 0; p < level->chunk_points; p++) {
+			si8 first = p * PYRAMID_DECIMATION;
+			si8 last = (first + PYRAMID_DECIMATION < prev->chunk_points) ? first + PYRAMID_DECIMATION : prev->chunk_points;
+			si8 sum = 0, count = 0;
+			si4 min = prev->mins[first], max = prev->maxs[first];
+			for (i = first; i < last; i++) {
+				sum += prev->sums[i];
+				count += prev->counts[i];
+				if (prev->mins[i] < min)	min = prev->mins[i];
+				if (prev->maxs[i] > max)	max = prev->maxs[i];
+			}
+			level->sums[p] = sum;
+			level->mins[p] = min;
+			level->maxs[p] = max;
+			level->counts[p] = count;
+		}
+	}
+	
+}
+
+/**
+ * 	Determine the mean of the samples of a point (rounded to the nearest integer)
+ *
+ * 	@param sum                  The sum of the samples of the point
+ * 	@param count                The number of samples of the point
+ * 	@return                     The mean
+ */
+si4 pyramid_point_mean(si8 sum, si8 count) {
+	return (si4) ((sum >= 0) ? (sum + count / 2) / count : -((-sum + count / 2) / count));
+}
+
+/**
+ * 	Read a number of bytes from a file at a given (64-bit) offset
+ *
+ * 	@param fp                   The opened file
+ * 	@param offset               The offset in the file to read from
+ * 	@param data                 The buffer to read into
+ * 	@param num_bytes            The number of bytes to read
+ * 	@return                     True if all bytes were read, false otherwise
+ */
+bool read_file_at(FILE *fp, ui8 offset, void *data, ui8 num_bytes) {
+	#ifdef _WIN32
+		if (_fseeki64(fp, (si8) offset, SEEK_SET) != 0)		return false;
+	#else
+		if (fseeko(fp, (off_t) offset, SEEK_SET) != 0)		return false;
+	#endif
+	return fread(data, sizeof(ui1), (size_t) num_bytes, fp) == num_bytes;
+}
@@ -17,23 +17,366 @@
  */
 #include "mex.h"
 #include "meflib/meflib/meflib.h"
+#include "matmef_threads.h"
+#include "matmef_aes.h"
+#include "matmef_cache.h"
+#include "matmef_readahead.h"
+#include "matmef_batchio.h"
+#include <stdarg.h>
+
+// Memory-mapped access to the data files (Linux only, other platforms read the data files in windows)
+#ifdef __linux__
+	#define MATMEF_MMAP
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+// SSE2 (always available on x86-64) is used to reconstruct the samples from the differences, other platforms use a scalar loop
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MATMEF_SSE2
+	#include <emmintrin.h>
+#endif
 
 
 // Range Types
 #define RANGE_BY_SAMPLES	0
 #define RANGE_BY_TIME		1
 
+// Output Types
+#define OUTPUT_DOUBLE		0
+#define OUTPUT_INT32		1
+#define OUTPUT_SINGLE		2
+
+// Size of the windows in which the compressed data is read (two windows are in memory while reading)
+#define READ_WINDOW_BYTES	(16 * 1024 * 1024)
+
+// Maximum size of the compressed data of (all channels of) a multi-channel read that is read at once, in a single batch
+// (the size of the two windows of a streamed read, so that a batch does not raise the peak memory of a read)
+#define READ_BATCH_MAX_BYTES	(2 * READ_WINDOW_BYTES)
+
+// Maximum number of blocks that are planned before they are decoded
+#define READ_PLAN_BLOCKS	65536
+
+// Number of entries in the (per block) table that maps the cumulative counts to the symbols while range decoding
+#define RED_SYMBOL_LOOKUP_ENTRIES	1024
+
+// Number of samples that are copied out of the output array at a time when converting the samples in the output array itself
+#define CONVERT_CHUNK_SAMPLES	4096
+
+// Maximum size of the messages that are collected while reading a channel
+#define READ_MESSAGE_BYTES	2048
+
+// Pyramid sidecar files, which hold decimated levels (the mean, minimum and maximum of each 4, 16, 64, ... samples) of
+// a segment as RED blocks, next to the data file (.tdat) of the segment. Matmef specific, not part of the MEF3 format.
+#define PYRAMID_FILE_TYPE_STRING	"tpyr"
+#define PYRAMID_MAGIC				"MMEFPYR"
+#define PYRAMID_VERSION				1
+#define PYRAMID_DECIMATION			4			// the factor between consecutive levels
+#define PYRAMID_MAX_LEVELS			12
+#define PYRAMID_BLOCK_POINTS		4096		// the maximum number of points (decimated samples) in a block of a level
+#define PYRAMID_STREAMS				3			// the streams of each level, a block holds a RED block for each (in this order)
+#define PYRAMID_STREAM_MEAN			0
+#define PYRAMID_STREAM_MIN			1
+#define PYRAMID_STREAM_MAX			2
+
+// Number of samples that are read and decimated at a time, while building a pyramid or decimating the full-rate data
+// of a segment without one (rounded up to a multiple of the coarsest factor)
+#define PYRAMID_BUILD_SAMPLES		(1024 * 1024)
+
+
+// 
+// Structures
+//
+
+// The meflib settings that are used while reading a channel, captured once the channel is opened. Reading and decoding use
+// these instead of the meflib globals, which are shared by the process and can change in the meantime (e.g. by opening another session)
+typedef struct {
+	si8		recording_time_offset;			// the recording time offset of the channel's session
+	ui4		recording_time_offset_mode;
+} READ_CONTEXT;
+
+// A block in the lookup table of a channel
+typedef struct {
+	si8		start_sample;		// the start sample of the block in the channel (segment start sample + block start sample)
+	si8		start_time;			// the start time of the block (with the recording time offset removed)
+	ui4		segment;
+	ui4		block;				// index of the block in its segment
+} BLOCK_LOOKUP_ENTRY;
+
+// A lookup table of the blocks of all segments of a channel (in order), to locate samples, times, blocks and segments by binary search
+typedef struct {
+	BLOCK_LOOKUP_ENTRY	*blocks;
+	ui8					num_blocks;
+	ui4					num_segments;
+	ui8					*segment_first_block;	// the index of the first block of each segment in the table (num_segments + 1 entries)
+	si8					*segment_start_time;	// the start and end time of each segment (with the recording time offset removed)
+	si8					*segment_end_time;
+	si8					*segment_start_sample;	// the first and end sample of each segment (in the channel)
+	si8					*segment_end_sample;
+	si8					first_sample;			// the start sample of the first segment
+	si8					first_time;				// the start time of the first block of the first segment
+	sf8					sampling_frequency;
+} BLOCK_LOOKUP;
+
+// The (validated) range of samples and blocks to read from a channel
+typedef struct {
+	bool	range_type;
+	si8		start_samp;
+	si8		end_samp;
+	si8		start_time;
+	si8		end_time;
+	ui8		num_samps;			// number of samples in the output (0 = empty range, nothing else is set)
+	ui4		start_segment;
+	ui4		end_segment;
+	ui8		start_idx;			// index of the first block in the start segment
+	ui8		end_idx;			// index of the last block in the end segment
+	ui8		num_blocks;
+	ui8		total_data_bytes;
+	bool	output_initialized;	// whether the output buffer is already initialized (e.g. zeroed by matlab), sample ranges then skip the NaN fill
+	bool	validate_crc;		// whether the CRC of each block is validated (false = trusted read, only the structure of the blocks is checked)
+	READ_CONTEXT	context;	// the meflib settings of the channel's session
+	BLOCK_CACHE		*cache;		// the cache of decoded blocks to use (NULL = no cache; only for reads on the main (matlab) thread)
+	READAHEAD		*readahead;	// the readahead of the channel, of which the data is used by the read (NULL = no readahead)
+	ui1				*preloaded;	// the compressed data of the range, read beforehand (NULL = the data is read while decoding)
+	si1		message[READ_MESSAGE_BYTES];	// messages (warnings/errors) collected while reading, to be output by the caller
+} CHANNEL_READ;
+
+// A piece of a segment data file that is part of a read stream
+typedef struct {
+	ui4		segment;
+	ui8		file_offset;		// offset of the piece in the data file
+	ui8		bytes;
+	ui8		stream_offset;		// offset of the piece in the stream
+	bool	short_read;			// whether fewer bytes than expected were read from the piece
+	ui1		*map;				// the memory mapping of the piece (NULL if not mapped)
+	size_t	map_bytes;
+	ui1		*data;				// the data of the piece in the memory mapping
+} READ_STREAM_PIECE;
+
+// A stream of the compressed data in a range to read, which is read (double-buffered) in windows, or
+// - when mapped - is accessed through memory mappings of the data files (with a window per segment)
+typedef struct {
+	CHANNEL				*channel;
+	READAHEAD			*readahead;				// the readahead of the channel, data that was read ahead is copied instead of read (NULL = none)
+	READ_STREAM_PIECE	*pieces;
+	ui4					num_pieces;
+	ui8					total_bytes;
+	ui8					max_block_bytes;		// maximum size of a block (and the room in front of each window for a carried over block)
+	ui8					window_size;
+	ui1					*buffers[2];
+	si4					current_buffer;
+	ui1					*window_data;			// start of the current window (including a carried over block)
+	ui8					window_bytes;
+	ui8					next_pos;				// position in the stream of the data after the current window
+	ui1					*prefetch_data;			// the next window, being read in the background
+	ui8					prefetch_bytes;
+	bool				prefetch_pending;		// whether a next window is (being) read
+	bool				prefetching;			// whether the next window is being read on a thread
+	THREAD				prefetch_thread;
+	bool				mapped;					// whether the pieces are memory-mapped
+	ui4					current_piece;			// the piece that is the current window (when mapped)
+} READ_STREAM;
+
+// A worker that reads a number of channels into a <channels> x <samples> output matrix
+typedef struct {
+	CHANNEL			**channels;
+	CHANNEL_READ	*reads;
+	si4				first_channel;		// the first channel to read
+	si4				channel_step;		// the step to the next channel to read
+	si4				num_channels;		// the total number of channels (and rows in the output matrix)
+	void			*output;			// the output matrix (double or single, depending on the output type)
+	si4				output_type;
+	ui8				output_samps;
+	bool			apply_conv_factor;
+	sf8				nan_value;
+	bool			success;
+} CHANNELS_WORKER;
+
+// A range (epoch) to read from a channel, as part of a read of multiple ranges
+typedef struct {
+	ui4		range;				// the index of the range (in the output)
+	ui8		num_samps;			// number of samples in the output (0 = empty range, nothing else is set)
+	si8		start_samp;
+	si8		start_time;
+	ui8		first_block;		// the first and last block that the range needs (indices in the block lookup table)
+	ui8		last_block;
+} EPOCH;
+
+// A group of epochs of a channel that overlap or border on each other (in blocks), whose blocks are read and decoded at once
+typedef struct {
+	ui8		first_block;		// the first and last block of the group (indices in the block lookup table)
+	ui8		last_block;
+	ui8		first_epoch;		// the index of the first epoch of the group (the epochs of a group follow each other)
+	ui8		num_epochs;
+	ui1		*preloaded;			// the compressed data of the blocks, read beforehand (NULL = the data is read while decoding)
+	bool	short_read;			// whether fewer bytes than expected were read into the preloaded data
+} EPOCHS_GROUP;
+
+// A worker that reads the epochs of a number of channels into a <channels> x <samples> x <ranges> output matrix
+typedef struct {
+	CHANNEL			**channels;
+	BLOCK_LOOKUP	*lookups;
+	READ_CONTEXT	*contexts;
+	EPOCH			*epochs;			// the epochs of each channel (num_ranges per channel, sorted by their first block)
+	EPOCHS_GROUP	*groups;
+	ui8				*channel_first_group;	// the index of the first group of each channel (num_channels + 1 entries)
+	si4				first_channel;		// the first channel to read
+	si4				channel_step;		// the step to the next channel to read
+	si4				num_channels;		// the total number of channels (and rows in the output matrix)
+	si4				num_ranges;
+	bool			range_type;
+	void			*output;			// the output matrix (double or single, depending on the output type)
+	si4				output_type;
+	ui8				output_samps;
+	bool			apply_conv_factor;
+	bool			validate_crc;
+	sf8				nan_value;
+	bool			success;
+	si1				message[READ_MESSAGE_BYTES];	// messages (errors) of the read that failed, to be output by the caller
+} EPOCHS_WORKER;
+
+// A RED block that is planned for decoding
+typedef struct {
+	ui1		*block;				// pointer to the RED block (header) in the compressed data buffer
+	si4		*output;			// pointer to the position in the output buffer to decode the samples to (NULL = only check the block)
+	si4		*cached;			// the (already decoded) samples of the block in the cache, which are copied instead (NULL = decode)
+	ui4		segment;			// the segment of the block
+	ui8		block_index;		// index of the block in the segment (used for messages)
+} DECODE_BLOCK;
+
+// The keys to decrypt (encrypted) RED blocks with, prepared once for a read
+typedef struct {
+	si1				access_level;		// the access level of the password (NO_ENCRYPTION if there is no password data)
+	AES_DECRYPT_KEY	level_1;
+	AES_DECRYPT_KEY	level_2;
+} BLOCK_DECRYPTION;
+
+// A level in a pyramid sidecar
+typedef struct {
+	si8		factor;					// the number of samples that each point of the level is decimated from
+	si8		number_of_points;
+	si8		number_of_blocks;
+	si8		index_offset;			// offset of the indices (PYRAMID_INDEX) of the blocks of the level in the file
+	ui4		maximum_block_bytes;
+	ui4		pad;
+} PYRAMID_LEVEL;
+
+// The header at the start of a pyramid sidecar
+typedef struct {
+	si1				magic[8];				// PYRAMID_MAGIC (only written once the file is complete)
+	ui4				version;
+	ui4				decimation;
+	ui4				number_of_levels;
+	ui4				block_points;
+	si8				number_of_samples;		// the number of samples in the segment that the pyramid was built from
+	ui4				source_body_CRC;		// the body CRC of the segment's data file that the pyramid was built from
+	ui4				pad;
+	PYRAMID_LEVEL	levels[PYRAMID_MAX_LEVELS];
+} PYRAMID_HEADER;
+
+// The index of a block of a level in a pyramid sidecar (the RED blocks of the streams directly follow each other)
+typedef struct {
+	si8		file_offset;
+	ui4		block_bytes;			// the size of the RED blocks of all streams together
+	ui4		number_of_points;
+} PYRAMID_INDEX;
+
+// The state of a level while decimating samples into points (while building a pyramid, or reading without one)
+typedef struct {
+	si8				factor;
+	si8				*sums;				// the sum, minimum, maximum and number of samples of each point of the level in the current chunk
+	si4				*mins;
+	si4				*maxs;
+	si8				*counts;
+	si8				chunk_points;		// the number of points of the level in the current chunk
+	si4				*block_points;		// the points of the block that is being filled (PYRAMID_STREAMS x block points; only when building)
+	ui4				num_block_points;
+	PYRAMID_INDEX	*indices;
+	si8				num_blocks;
+} PYRAMID_BUILD_LEVEL;
+
+// A worker that decodes a contiguous range of planned blocks
+typedef struct {
+	DECODE_BLOCK	*blocks;
+	ui8				num_blocks;
+	ui4				max_samps;
+	ui1				*compressed_data;
+	ui8				compressed_bytes;
+	bool			validate_crc;
+	READ_CONTEXT	*context;
+	BLOCK_DECRYPTION	*decryption;
+	bool			success;
+	si8				failed_block;		// index of the block that failed the check or could not be decrypted (-1 if none)
+	bool			no_access;			// whether the failed block could not be decrypted
+} DECODE_WORKER;
+
 // 
 // Functions
 //
 
-mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor);
-mxArray *read_channel_data_from_object(CHANNEL *channel, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor);
+mxArray *read_channel_data_from_path(si1 *channel_path, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc);
+mxArray *read_channel_data_from_object(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, READAHEAD *readahead, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc);
+mxArray *read_session_channels_data(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, bool range_type, si8 range_start, si8 range_end, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc);
+void read_channels_worker(void *arg);
+mxArray *read_session_channels_epochs(si1 *session_path, si1 **channel_names, si4 num_channels, si1 *password, bool range_type, si8 *ranges_start, si8 *ranges_end, si4 num_ranges, bool apply_conv_factor, si4 num_threads, si4 output_type, bool validate_crc);
+int compare_epochs(const void *a, const void *b);
+void read_epochs_worker(void *arg);
+void copy_epoch_samples(EPOCHS_WORKER *worker, si4 *samples, ui8 num_samps, ui8 output_offset, sf8 fac);
+void set_block_range_read(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui8 first_block, ui8 last_block, CHANNEL_READ *read);
+bool open_read_stream(READ_STREAM *stream, CHANNEL *channel, CHANNEL_READ *read, ui4 max_samps);
+bool set_read_stream_pieces(READ_STREAM *stream, CHANNEL *channel, CHANNEL_READ *read);
+void preload_channel_reads(CHANNEL **channels, CHANNEL_READ *reads, si4 num_channels, si4 num_threads);
+void preload_epochs_groups(CHANNEL **channels, BLOCK_LOOKUP *lookups, READ_CONTEXT *contexts, EPOCHS_GROUP *groups, ui8 *channel_first_group, si4 num_channels, si4 num_threads);
+bool preload_read_streams(CHANNEL **channels, READ_STREAM *streams, ui1 **preloaded, ui8 num_streams, si4 num_threads);
+void start_read_window(READ_STREAM *stream);
+void read_window_worker(void *arg);
+bool read_window_contains_block(READ_STREAM *stream, ui1 *block);
+ui1 *advance_read_window(READ_STREAM *stream, ui1 *block);
+void close_read_stream(READ_STREAM *stream, CHANNEL_READ *read);
+void read_stream_data(READ_STREAM *stream, ui8 pos, ui1 *data, ui8 num_bytes);
+bool map_read_stream(READ_STREAM *stream);
+void unmap_read_stream(READ_STREAM *stream);
+bool prepare_channel_read(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, bool range_type, si8 range_start, si8 range_end, CHANNEL_READ *read);
+bool read_channel_samples(CHANNEL *channel, CHANNEL_READ *read, si4 *decomp_data, si4 num_threads);
+void next_segment_block(CHANNEL *channel, ui4 *segment, ui8 *block);
+void cache_decoded_blocks(BLOCK_CACHE *cache, DECODE_BLOCK *blocks, ui8 num_blocks, CHANNEL *channel, ui8 channel_id, si1 access_level, bool validated);
+void convert_samples_to_double(si4 *samples, ui8 num_samps, sf8 *output, ui8 stride, sf8 fac, sf8 nan_value);
+void convert_samples_to_single(si4 *samples, ui8 num_samps, sf4 *output, ui8 stride, sf8 fac, sf4 nan_value);
+void convert_samples_in_output(si4 *samples, ui8 num_samps, void *output, si4 output_type, sf8 fac, sf8 nan_value);
+void add_read_message(CHANNEL_READ *read, const char *format, ...);
+void capture_read_context(READ_CONTEXT *context);
+void apply_context_time_offset(READ_CONTEXT *context, si8 *time);
+void remove_context_time_offset(READ_CONTEXT *context, si8 *time);
 
-si8 sample_for_uutc_c(si8 uutc, CHANNEL *channel);
-si8 uutc_for_sample_c(si8 sample, CHANNEL *channel);
+bool build_block_lookup(CHANNEL *channel, READ_CONTEXT *context, BLOCK_LOOKUP *lookup);
+void free_block_lookup(BLOCK_LOOKUP *lookup);
+ui8 find_segment_block(BLOCK_LOOKUP *lookup, ui4 segment, si8 time);
+si8 sample_for_uutc_c(si8 uutc, BLOCK_LOOKUP *lookup);
+si8 uutc_for_sample_c(si8 sample, BLOCK_LOOKUP *lookup);
 void memset_int(si4 *ptr, si4 value, size_t num);
+si4 check_block_bounds(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes);
 si4 check_block_crc(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes);
+bool check_block(ui1 *block_hdr_ptr, ui4 max_samps, ui1 *total_data_ptr, ui8 total_data_bytes, bool validate_crc);
+
+void prepare_block_decryption(BLOCK_DECRYPTION *decryption, PASSWORD_DATA *password_data);
+bool decode_red_block(RED_PROCESSING_STRUCT *rps, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption);
+void offset_block_start_time(RED_BLOCK_HEADER *block_header, READ_CONTEXT *context);
+void copy_cached_block(RED_PROCESSING_STRUCT *rps, READ_CONTEXT *context, si4 *cached);
+void reconstruct_samples(si1 *differences, ui4 number_of_samples, si4 *output);
+void unscale_retrend_samples(si4 *samples, ui4 number_of_samples, sf8 scale_factor, sf8 slope, sf8 intercept);
+void decode_blocks_worker(void *arg);
+bool decode_blocks(DECODE_BLOCK *blocks, ui8 num_blocks, ui4 max_samps, ui1 *compressed_data, ui8 compressed_bytes, bool validate_crc, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption, si4 num_threads, si8 *failed_block, bool *no_access);
+
+mxArray *read_channel_pyramid_from_path(si1 *channel_path, si1 *password, si8 range_start, si8 range_end, si8 num_points, bool apply_conv_factor, si4 num_threads, bool validate_crc);
+mxArray *read_channel_pyramid_from_object(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, si8 range_start, si8 range_end, si8 num_points, bool apply_conv_factor, si4 num_threads, bool validate_crc);
+void pyramid_file_path(SEGMENT *segment, si1 *path);
+FILE *open_segment_pyramid(SEGMENT *segment, PYRAMID_HEADER *header);
+si4 select_pyramid_level(PYRAMID_HEADER *header, si8 samples_per_point);
+bool read_pyramid_points(FILE *fp, PYRAMID_HEADER *header, si4 level, si8 first_point, si8 num_points, si4 *mean, si4 *min, si4 *max, bool validate_crc, READ_CONTEXT *context, BLOCK_DECRYPTION *decryption, si4 num_threads);
+bool decimate_segment_points(CHANNEL *channel, BLOCK_LOOKUP *lookup, READ_CONTEXT *context, ui4 segment, si8 factor, si8 first_point, si8 num_points, si4 *mean, si4 *min, si4 *max, bool validate_crc, si4 num_threads);
+void decimate_pyramid_chunk(PYRAMID_BUILD_LEVEL *levels, si4 num_levels, si4 *samples, si8 num_samps);
+si4 pyramid_point_mean(si8 sum, si8 count);
+bool read_file_at(FILE *fp, ui8 offset, void *data, ui8 num_bytes);
 
 
 
@@ -0,0 +1,219 @@
+/**
+ * 	@file
+ * 	Sequential readahead of the compressed data of a channel, which reads the blocks that follow a read in the background
+ *
+ *	When a channel is walked in consecutive windows (e.g. to extract features from a whole recording), each read
+ *	otherwise starts with a synchronous read of its data. Once reads are detected to continue where the previous
+ *	read ended, the blocks that follow a read are read on a background thread (after hinting the kernel where
+ *	possible), so that the next read finds its data already in memory. This mostly pays off on storage with a
+ *	high latency per request, such as network-mounted archives.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_readahead.h"
+#include "matmef_read.h"
+
+
+/**
+ * 	Initialize the readahead of a channel (no previous reads, nothing read ahead)
+ *
+ * 	@param readahead            Pointer to the readahead
+ */
+void init_readahead(READAHEAD *readahead) {
+	memset(readahead, 0, sizeof(READAHEAD));
+}
+
+/**
+ * 	Release the readahead of a channel, waiting for a background read to finish
+ *
+ * 	@param readahead            Pointer to the readahead
+ */
+void free_readahead(READAHEAD *readahead) {
+
+	wait_for_readahead(readahead);
+	free (readahead->data);
+	if (readahead->fp != NULL)
+		fclose(readahead->fp);
+	init_readahead(readahead);
+
+}
+
+/**
+ * 	Wait for the data that is being read ahead (on a thread) to be read
+ *
+ * 	@param readahead            Pointer to the readahead
+ */
+void wait_for_readahead(READAHEAD *readahead) {
+	if (readahead->reading)
+		thread_join(&readahead->thread);
+	readahead->reading = false;
+}
+
+/**
+ * 	Check whether the data at a position in the data file of a segment was read ahead
+ *
+ *	Note: the readahead should have been waited for (wait_for_readahead)
+ *
+ * 	@param readahead            Pointer to the readahead
+ * 	@param segment              The segment of the data file
+ * 	@param file_offset          The offset in the data file
+ * 	@return                     True if the data at the offset was read ahead
+ */
+bool readahead_holds(READAHEAD *readahead, ui4 segment, ui8 file_offset) {
+	return readahead->pending && !readahead->reading && readahead->segment == segment &&
+		   file_offset >= readahead->file_offset && file_offset < readahead->file_offset + readahead->bytes_read;
+}
+
+/**
+ * 	Copy data from the data file of a segment that was read ahead
+ *
+ *	Note: the readahead should have been waited for (wait_for_readahead)
+ *
+ * 	@param readahead            Pointer to the readahead
+ * 	@param segment              The segment of the data file
+ * 	@param file_offset          The offset in the data file of the data to copy
+ * 	@param data                 The buffer to copy into
+ * 	@param num_bytes            The number of bytes to copy
+ * 	@return                     The number of bytes that were copied (from the start of the range; 0 if the start was not read ahead)
+ */
+ui8 copy_readahead_data(READAHEAD *readahead, ui4 segment, ui8 file_offset, ui1 *data, ui8 num_bytes) {
+
+	if (!readahead_holds(readahead, segment, file_offset))
+		return 0;
+
+	ui8 available = readahead->file_offset + readahead->bytes_read - file_offset;
+	if (num_bytes > available)	num_bytes = available;
+	memcpy(data, readahead->data + (file_offset - readahead->file_offset), (size_t) num_bytes);
+	return num_bytes;
+
+}
+
+/**
+ * 	Update the access pattern of a channel after a read, and read ahead the blocks that follow
+ *	the read when the reads are sequential
+ *
+ *	Reads are sequential when they start at the last block of the previous read (consecutive windows usually share a
+ *	block) or at the block after it. The blocks that are read ahead are as many as the read had (the next read is likely
+ *	of the same size), starting at the last block of the read.
+ *
+ * 	@param readahead            Pointer to the readahead
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param start_segment        The segment of the first block of the read
+ * 	@param start_idx            The index of the first block of the read (in its segment)
+ * 	@param end_segment          The segment of the last block of the read
+ * 	@param end_idx              The index of the last block of the read (in its segment)
+ * 	@param num_blocks           The number of blocks of the read
+ */
+void update_readahead(READAHEAD *readahead, CHANNEL *channel, ui4 start_segment, ui8 start_idx, ui4 end_segment, ui8 end_idx, ui8 num_blocks) {
+
+	// the data that was read ahead has been used (or was not needed)
+	wait_for_readahead(readahead);
+	readahead->pending = false;
+
+	// check if the read continued where the previous read ended
+	bool sequential = false;
+	if (readahead->has_previous) {
+		ui4 next_segment = readahead->previous_end_segment;
+		ui8 next_idx = readahead->previous_end_idx;
+		next_segment_block(channel, &next_segment, &next_idx);
+		sequential = (start_segment == readahead->previous_end_segment && start_idx == readahead->previous_end_idx) ||
+					 (start_segment == next_segment && start_idx == next_idx);
+	}
+	readahead->sequential_reads = sequential ? readahead->sequential_reads + 1 : 0;
+	readahead->has_previous = true;
+	readahead->previous_end_segment = end_segment;
+	readahead->previous_end_idx = end_idx;
+
+	// read ahead
+	if (readahead->sequential_reads >= READAHEAD_SEQUENTIAL_READS) {
+
+		// when the read ended at the last block of a segment, the next read continues in the next segment
+		ui8 number_of_blocks = (ui8) channel->segments[end_segment].metadata_fps->metadata.time_series_section_2->number_of_blocks;
+		if (end_idx + 1 >= number_of_blocks && end_segment + 1 < (ui4) channel->number_of_segments)
+			start_readahead(readahead, channel, end_segment + 1, 0, num_blocks);
+		else
+			start_readahead(readahead, channel, end_segment, end_idx, num_blocks + 1);
+
+	}
+
+}
+
+/**
+ * 	Start reading a number of blocks of a segment ahead, on a background thread
+ *
+ * 	@param readahead            Pointer to the readahead (should not be reading)
+ * 	@param channel              Pointer to the MEF channel object
+ * 	@param segment              The segment of the blocks
+ * 	@param first_block          The index of the first block to read ahead (in the segment)
+ * 	@param num_blocks           The number of blocks to read ahead (limited to the blocks in the segment and READAHEAD_MAX_BYTES)
+ */
+void start_readahead(READAHEAD *readahead, CHANNEL *channel, ui4 segment, ui8 first_block, ui8 num_blocks) {
+	SEGMENT *seg = &channel->segments[segment];
+	TIME_SERIES_INDEX *indices = seg->time_series_indices_fps->time_series_indices;
+	ui8 number_of_blocks = (ui8) seg->metadata_fps->metadata.time_series_section_2->number_of_blocks;
+
+	readahead->pending = false;
+	if (first_block >= number_of_blocks || num_blocks == 0)
+		return;
+
+	// the range of the blocks in the data file
+	ui8 last_block = first_block + num_blocks - 1;
+	if (last_block >= number_of_blocks)		last_block = number_of_blocks - 1;
+	ui8 file_offset = (ui8) indices[first_block].file_offset;
+	ui8 file_end = (last_block + 1 < number_of_blocks) ? (ui8) indices[last_block + 1].file_offset : (ui8) seg->time_series_data_fps->file_length;
+	if (file_end <= file_offset)
+		return;
+	ui8 bytes = file_end - file_offset;
+	if (bytes > READAHEAD_MAX_BYTES)		bytes = READAHEAD_MAX_BYTES;
+
+	// make room for the data
+	if (readahead->data_size < bytes) {
+		ui1 *data = (ui1 *) realloc(readahead->data, (size_t) bytes);
+		if (data == NULL)
+			return;
+		readahead->data = data;
+		readahead->data_size = bytes;
+	}
+
+	// open the data file of the segment
+	if (readahead->fp == NULL || readahead->fp_segment != segment) {
+		if (readahead->fp != NULL)
+			fclose(readahead->fp);
+		readahead->fp = fopen(seg->time_series_data_fps->full_file_name, "rb");
+		readahead->fp_segment = segment;
+		if (readahead->fp == NULL)
+			return;
+	}
+
+	// hint the kernel to start reading the range right away
+	#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+		(void) posix_fadvise(fileno(readahead->fp), (off_t) file_offset, (off_t) bytes, POSIX_FADV_WILLNEED);
+	#endif
+
+	// read on a separate thread (if the thread cannot be started, nothing is read ahead)
+	readahead->segment = segment;
+	readahead->file_offset = file_offset;
+	readahead->bytes = bytes;
+	readahead->bytes_read = 0;
+	readahead->reading = thread_create(&readahead->thread, readahead_worker, readahead);
+	readahead->pending = readahead->reading;
+
+}
+
+/**
+ * 	Worker function that reads the data ahead
+ *
+ * 	@param arg                  Pointer to the (READAHEAD) readahead
+ */
+void readahead_worker(void *arg) {
+	READAHEAD *readahead = (READAHEAD *) arg;
+	if (read_file_at(readahead->fp, readahead->file_offset, readahead->data, readahead->bytes))
+		readahead->bytes_read = readahead->bytes;
+}
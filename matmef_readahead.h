@@ -0,0 +1,76 @@
+#ifndef MATMEF_READAHEAD_
+#define MATMEF_READAHEAD_
+/**
+ * 	@file - headers
+ * 	Sequential readahead of the compressed data of a channel, which reads the blocks that follow a read in the background
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include "matmef_threads.h"
+#include <stdbool.h>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+#endif
+
+
+// The number of consecutive reads that should continue where the previous read ended before reading ahead
+#define READAHEAD_SEQUENTIAL_READS	1
+
+// The maximum number of bytes that are read ahead
+#define READAHEAD_MAX_BYTES			(64 * 1024 * 1024)
+
+
+//
+// Structures
+//
+
+// The readahead of a channel
+typedef struct {
+
+	// the access pattern
+	bool		has_previous;			// whether there was a previous read
+	ui4			previous_end_segment;	// the segment of the last block of the previous read
+	ui8			previous_end_idx;		// the index of the last block of the previous read (in its segment)
+	ui4			sequential_reads;		// the number of consecutive reads that continued where the previous read ended
+
+	// the data that is read ahead (a range of blocks in the data file of a single segment)
+	ui4			segment;
+	ui8			file_offset;			// offset of the data in the data file
+	ui8			bytes;					// number of bytes that are (being) read
+	ui8			bytes_read;				// number of bytes that were read (set once the read is finished)
+	ui1			*data;
+	ui8			data_size;				// the allocated size of the data buffer
+	bool		pending;				// whether the data is (being) read
+	bool		reading;				// whether the data is being read on a thread
+	THREAD		thread;
+
+	// the data file that is read from (opened separately, the channel's own file pointers are used by the main thread)
+	FILE		*fp;
+	ui4			fp_segment;
+} READAHEAD;
+
+
+//
+// Functions
+//
+
+void init_readahead(READAHEAD *readahead);
+void free_readahead(READAHEAD *readahead);
+void wait_for_readahead(READAHEAD *readahead);
+bool readahead_holds(READAHEAD *readahead, ui4 segment, ui8 file_offset);
+ui8 copy_readahead_data(READAHEAD *readahead, ui4 segment, ui8 file_offset, ui1 *data, ui8 num_bytes);
+void update_readahead(READAHEAD *readahead, CHANNEL *channel, ui4 start_segment, ui8 start_idx, ui4 end_segment, ui8 end_idx, ui8 num_blocks);
+void start_readahead(READAHEAD *readahead, CHANNEL *channel, ui4 segment, ui8 first_block, ui8 num_blocks);
+void readahead_worker(void *arg);
+
+
+#endif   // MATMEF_READAHEAD_
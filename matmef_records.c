@@ -0,0 +1,725 @@
+/**
+ * 	@file
+ * 	Query of the records (annotations) of a session, channel or segment, filtered by type and time, into columnar matlab-structs
+ *
+ *	Mapping the records of a level (see map_mef3_records) reads the whole record data file and creates a struct (with a
+ *	nested body struct) for each record, which is slow and memory hungry for levels with many records. A query instead
+ *	selects the records by their type and time using the record indices, reads only the (byte ranges of the) selected
+ *	records from the record data file and maps them to columns: a column of times, types and versions for all selected
+ *	records, and a struct of columns with the bodies of each record type.
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_records.h"
+
+
+// the meflib globals (defined in meflib.c, which is included by read_mef_records.c)
+extern MEF_GLOBALS	*MEF_globals;
+
+
+// The largest gap (in bytes) between selected records that is read through, rather than skipped with a separate read
+#define RECORDS_READ_GAP_BYTES		(64 * 1024)
+
+// The record types of which the bodies are mapped (the field names are the type strings)
+static const ui4 RECORDS_BODY_TYPE_CODES[] = {
+	MEFREC_Note_TYPE_CODE,
+	MEFREC_EDFA_TYPE_CODE,
+	MEFREC_LNTP_TYPE_CODE,
+	MEFREC_Seiz_TYPE_CODE,
+	MEFREC_SyLg_TYPE_CODE,
+	MEFREC_CSti_TYPE_CODE,
+	MEFREC_ESti_TYPE_CODE,
+	MEFREC_Curs_TYPE_CODE,
+	MEFREC_Epoc_TYPE_CODE
+};
+static const int RECORDS_NUM_BODY_TYPES = 9;
+
+// the fields of the columnar records struct
+static const int RECORDS_NUMFIELDS 			= 13;
+static const char *RECORDS_FIELDNAMES[] 	= {
+	"time",
+	"type",
+	"version_major",
+	"version_minor",
+	MEFREC_Note_TYPE_STRING,
+	MEFREC_EDFA_TYPE_STRING,
+	MEFREC_LNTP_TYPE_STRING,
+	MEFREC_Seiz_TYPE_STRING,
+	MEFREC_SyLg_TYPE_STRING,
+	MEFREC_CSti_TYPE_STRING,
+	MEFREC_ESti_TYPE_STRING,
+	MEFREC_Curs_TYPE_STRING,
+	MEFREC_Epoc_TYPE_STRING
+};
+
+
+/**
+ * 	Create a numeric column vector for a field of a (1x1) columnar records matlab-struct
+ *
+ * 	@param mat_struct			Pointer to the (1x1) matlab-struct
+ * 	@param field				The name of the field
+ * 	@param rows					The number of rows (the number of records)
+ * 	@param class_id				The matlab class of the column
+ * 	@return						A pointer to the data of the column
+ */
+static void *create_records_column(mxArray *mat_struct, const char *field, mwSize rows, mxClassID class_id) {
+	mxArray *mat_column = mxCreateNumericMatrix(rows, 1, class_id, mxREAL);
+	mxSetField(mat_struct, 0, field, mat_column);
+	return mxGetData(mat_column);
+}
+
+/**
+ * 	Create a (cell) column of strings for a field of a (1x1) columnar records matlab-struct
+ *
+ * 	@param mat_struct			Pointer to the (1x1) matlab-struct
+ * 	@param field				The name of the field
+ * 	@param rows					The number of rows (the number of records)
+ * 	@return						A pointer to the (cell) column
+ */
+static mxArray *create_records_text_column(mxArray *mat_struct, const char *field, mwSize rows) {
+	mxArray *mat_column = mxCreateCellMatrix(rows, 1);
+	mxSetField(mat_struct, 0, field, mat_column);
+	return mat_column;
+}
+
+/**
+ * 	Create a matlab string from a string in a record, which is not read beyond the bytes that it may span in the record
+ *
+ * 	@param str					The string in the record
+ * 	@param max_bytes			The maximum number of bytes of the string (e.g. the size of the field or the body)
+ * 	@return						A pointer to the matlab string
+ */
+static mxArray *create_record_string(si1 *str, size_t max_bytes) {
+	size_t length = 0;
+	while (length < max_bytes && str[length] != '\0')	length++;
+	if (length < max_bytes)
+		return mxCreateString(str);
+
+	// the string is not terminated within the bytes, copy and terminate
+	si1 *terminated = (si1 *) mxMalloc(length + 1);
+	memcpy(terminated, str, length);
+	terminated[length] = '\0';
+	mxArray *mat_str = mxCreateString(terminated);
+	mxFree(terminated);
+	return mat_str;
+}
+
+/**
+ * 	Retrieve the minimum number of bytes of the (version 1.0) body of a record type that is mapped as a fixed-size struct
+ *
+ * 	@param type_code			The type code (MEFREC_*_TYPE_CODE) of the records
+ * 	@return						The size of the body struct, or 0 for types of which the body is text (or not mapped)
+ */
+static si8 record_body_struct_bytes(ui4 type_code) {
+	switch (type_code) {
+		case MEFREC_EDFA_TYPE_CODE:		return MEFREC_EDFA_1_0_BYTES;
+		case MEFREC_LNTP_TYPE_CODE:		return MEFREC_LNTP_1_0_BYTES;
+		case MEFREC_Seiz_TYPE_CODE:		return MEFREC_Seiz_1_0_BYTES;
+		case MEFREC_CSti_TYPE_CODE:		return MEFREC_CSti_1_0_BYTES;
+		case MEFREC_ESti_TYPE_CODE:		return MEFREC_ESti_1_0_BYTES;
+		case MEFREC_Curs_TYPE_CODE:		return MEFREC_Curs_1_0_BYTES;
+		case MEFREC_Epoc_TYPE_CODE:		return MEFREC_Epoc_1_0_BYTES;
+		default:						return 0;
+	}
+}
+
+/**
+ * 	Find the run of selected records that are read together with a selected record, being the records that
+ * 	directly follow each other in the record data file (or are separated by less than RECORDS_READ_GAP_BYTES)
+ *
+ * 	@param entries				The selected records
+ * 	@param num_entries			The number of selected records
+ * 	@param first				The index of the first (selected) record of the run
+ * 	@return						The index of the last (selected) record of the run
+ */
+static si8 find_records_run_end(RECORD_QUERY_ENTRY *entries, si8 num_entries, si8 first) {
+	si8 last = first;
+	while (last + 1 < num_entries) {
+		RECORD_QUERY_ENTRY *next = &entries[last + 1];
+		si8 end = entries[last].file_offset + entries[last].bytes;
+		if (next->bytes < RECORD_HEADER_BYTES || next->file_offset < end || next->file_offset - end > RECORDS_READ_GAP_BYTES)
+			break;
+		last++;
+	}
+	return last;
+}
+
+
+/**
+ * 	Query the records of a session, channel or segment by their type and time
+ *
+ *	The level is determined by the extension of the directory (.mefd, .timd/.vidd or .segd). Only the metadata and
+ *	record indices of the level are read (and those of the levels below it), the records themselves are read by query_records
+ *
+ * 	@param level_path			The path to the session, channel or segment directory
+ * 	@param password				Password for the MEF3 datafiles (no password = NULL)
+ * 	@param type_codes			The type codes (MEFREC_*_TYPE_CODE) of the records to select (NULL = all types)
+ * 	@param num_type_codes		The number of type codes (0 = all types)
+ * 	@param range_start			Start of the time range (as an epoch/unix timestamp; -1 = from the first record)
+ * 	@param range_end			End of the time range, the time itself not included (as an epoch/unix timestamp; -1 = up to and including the last record)
+ * 	@return						Pointer to a (1x1) columnar records matlab-struct (see map_records_columns), or NULL on failure
+ */
+mxArray *query_records_from_path(si1 *level_path, si1 *password, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end) {
+	si1				extension[TYPE_BYTES] = {0};
+	SESSION			*session = NULL;
+	CHANNEL			*channel = NULL;
+	SEGMENT			*segment = NULL;
+	FILE_PROCESSING_STRUCT	*ri_fps = NULL;
+
+	// if the password is just the null character, then correct to a null pointer
+	if (password != NULL && password[0] == '\0')	password = NULL;
+
+	// initialize MEF library
+	(void) initialize_meflib();
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	MEF_globals->read_time_series_indices   = 0;
+	MEF_globals->read_video_indices         = 0;
+	MEF_globals->read_record_indices        = 1;
+
+	// read the metadata and record indices of the level (but not the record data)
+	extract_path_parts(level_path, NULL, NULL, extension);
+	if (strcmp(extension, SESSION_DIRECTORY_TYPE_STRING) == 0) {
+		session = read_MEF_session(NULL, level_path, password, NULL, MEF_FALSE, MEF_FALSE);
+		if (session != NULL)	ri_fps = session->record_indices_fps;
+
+	} else if (strcmp(extension, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING) == 0 || strcmp(extension, VIDEO_CHANNEL_DIRECTORY_TYPE_STRING) == 0) {
+		channel = read_MEF_channel(NULL, level_path, UNKNOWN_CHANNEL_TYPE, password, NULL, MEF_FALSE, MEF_FALSE);
+		if (channel != NULL)	ri_fps = channel->record_indices_fps;
+
+	} else if (strcmp(extension, SEGMENT_DIRECTORY_TYPE_STRING) == 0) {
+		segment = read_MEF_segment(NULL, level_path, UNKNOWN_CHANNEL_TYPE, password, NULL, MEF_FALSE, MEF_FALSE);
+		if (segment != NULL)	ri_fps = segment->record_indices_fps;
+
+	} else {
+		MEF_globals->behavior_on_fail = EXIT_ON_FAIL;
+		mexPrintf("Error: unrecognized directory '%s', should be a session (.%s), channel (.%s or .%s) or segment (.%s) directory, exiting...\n", level_path, SESSION_DIRECTORY_TYPE_STRING, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING, VIDEO_CHANNEL_DIRECTORY_TYPE_STRING, SEGMENT_DIRECTORY_TYPE_STRING);
+		return NULL;
+	}
+	MEF_globals->behavior_on_fail = EXIT_ON_FAIL;
+
+	// query the records (a level without record indices has no records)
+	mxArray *mat_records = NULL;
+	if (session == NULL && channel == NULL && segment == NULL)
+		mexPrintf("Error: could not read '%s', exiting...\n", level_path);
+	else if (ri_fps == NULL)
+		mat_records = map_records_columns(NULL, 0);
+	else
+		mat_records = query_records(ri_fps, type_codes, num_type_codes, range_start, range_end);
+
+	// free the level
+	if (session != NULL)	free_session(session, MEF_TRUE);
+	if (channel != NULL)	free_channel(channel, MEF_TRUE);
+	if (segment != NULL)	free_segment(segment, MEF_TRUE);
+
+	return mat_records;
+
+}
+
+/**
+ * 	Query records by their type and time, using the record indices to read only the selected records from the record data file
+ *
+ * 	@param ri_fps				The record indices of the level (read by meflib, with the recording time offset applied as configured)
+ * 	@param type_codes			The type codes (MEFREC_*_TYPE_CODE) of the records to select (NULL = all types)
+ * 	@param num_type_codes		The number of type codes (0 = all types)
+ * 	@param range_start			Start of the time range (as an epoch/unix timestamp; -1 = from the first record)
+ * 	@param range_end			End of the time range, the time itself not included (as an epoch/unix timestamp; -1 = up to and including the last record)
+ * 	@return						Pointer to a (1x1) columnar records matlab-struct (see map_records_columns), or NULL on failure
+ */
+mxArray *query_records(FILE_PROCESSING_STRUCT *ri_fps, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end) {
+	si8		i;
+	si1		rd_path[MEF_FULL_FILE_NAME_BYTES], path[MEF_FULL_FILE_NAME_BYTES], name[MEF_BASE_FILE_NAME_BYTES];
+
+	// the path to the record data file (next to the record indices file)
+	extract_path_parts(ri_fps->full_file_name, path, name, NULL);
+	MEF_snprintf(rd_path, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", path, name, RECORD_DATA_FILE_TYPE_STRING);
+
+	// open the record data file and retrieve its length
+	FILE *fp = fopen(rd_path, "rb");
+	if (fp == NULL) {
+		mexPrintf("Error: could not open the record data file '%s', exiting...\n", rd_path);
+		return NULL;
+	}
+	#ifdef _WIN32
+		_fseeki64(fp, 0, SEEK_END);
+		si8 rd_file_length = _ftelli64(fp);
+	#else
+		fseeko(fp, 0, SEEK_END);
+		si8 rd_file_length = (si8) ftello(fp);
+	#endif
+
+	// select the records by their indices
+	RECORD_QUERY_ENTRY *entries = NULL;
+	si8 num_entries = select_record_indices(ri_fps, rd_file_length, type_codes, num_type_codes, range_start, range_end, &entries);
+	if (num_entries < 0) {
+		fclose(fp);
+		mexPrintf("Error: could not allocate enough memory for the selection of records, exiting...\n");
+		return NULL;
+	}
+
+	// read the selected records
+	ui1 *buffer = NULL;
+	bool success = read_selected_records(fp, entries, num_entries, &buffer);
+	fclose(fp);
+	if (!success) {
+		free (entries);
+		mexPrintf("Error: could not allocate enough memory to read the selected records, exiting...\n");
+		return NULL;
+	}
+
+	// validate, offset the time and decrypt the records
+	bool warned_access = false;
+	for (i = 0; i < num_entries; i++)
+		prepare_selected_record(&entries[i], ri_fps->password_data, &warned_access);
+
+	// map the records to columns
+	mxArray *mat_records = map_records_columns(entries, num_entries);
+
+	free (buffer);
+	free (entries);
+	return mat_records;
+
+}
+
+/**
+ * 	Select records by their type and time from the record indices
+ *
+ *	The number of bytes of each record in the record data file follows from the offset of the next record (or the end
+ *	of the file for the last record); these are validated against the record headers once read
+ *
+ * 	@param ri_fps				The record indices
+ * 	@param rd_file_length		The length of the record data file
+ * 	@param type_codes			The type codes (MEFREC_*_TYPE_CODE) of the records to select (NULL = all types)
+ * 	@param num_type_codes		The number of type codes (0 = all types)
+ * 	@param range_start			Start of the time range (-1 = from the first record)
+ * 	@param range_end			End of the time range, the time itself not included (-1 = up to and including the last record)
+ * 	@param entries				Pointer to a variable that will hold the (allocated) array of selected records (NULL when nothing is selected)
+ * 	@return						The number of selected records, or -1 on failure (memory allocation)
+ */
+si8 select_record_indices(FILE_PROCESSING_STRUCT *ri_fps, si8 rd_file_length, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end, RECORD_QUERY_ENTRY **entries) {
+	si8		i;
+	si4		j;
+
+	*entries = NULL;
+	RECORD_INDEX *ri = ri_fps->record_indices;
+	si8 number_of_indices = ri_fps->universal_header->number_of_entries;
+	if (number_of_indices == UNKNOWN_NUMBER_OF_ENTRIES)
+		number_of_indices = (ri_fps->raw_data_bytes - UNIVERSAL_HEADER_BYTES) / RECORD_INDEX_BYTES;
+	if (ri == NULL || number_of_indices <= 0)
+		return 0;
+
+	*entries = (RECORD_QUERY_ENTRY *) malloc((size_t) number_of_indices * sizeof(RECORD_QUERY_ENTRY));
+	if (*entries == NULL)
+		return -1;
+
+	si8 num_entries = 0;
+	for (i = 0; i < number_of_indices; i++) {
+
+		// check the time
+		if (range_start >= 0 && ri[i].time < range_start)		continue;
+		if (range_end >= 0 && ri[i].time >= range_end)			continue;
+
+		// check the type
+		if (num_type_codes > 0) {
+			ui4 type_code = *((ui4 *) ri[i].type_string);
+			for (j = 0; j < num_type_codes; j++)
+				if (type_codes[j] == type_code)		break;
+			if (j == num_type_codes)	continue;
+		}
+
+		// select
+		RECORD_QUERY_ENTRY *entry = &(*entries)[num_entries++];
+		entry->file_offset = ri[i].file_offset;
+		entry->bytes = ((i + 1 < number_of_indices) ? ri[i + 1].file_offset : rd_file_length) - ri[i].file_offset;
+		entry->header = NULL;
+		entry->readable_body = false;
+
+	}
+
+	return num_entries;
+
+}
+
+/**
+ * 	Read the selected records from the record data file into a single buffer
+ *
+ *	Records that directly follow each other in the file (or are only separated by a small gap) are read at once.
+ *	Records that could not be read keep a NULL header.
+ *
+ * 	@param fp					The opened record data file
+ * 	@param entries				The selected records, the header pointers are set to the records in the buffer
+ * 	@param num_entries			The number of selected records
+ * 	@param buffer				Pointer to a variable that will hold the (allocated) buffer with the records (NULL when nothing is read)
+ * 	@return						True if successful, false on failure (memory allocation)
+ */
+bool read_selected_records(FILE *fp, RECORD_QUERY_ENTRY *entries, si8 num_entries, ui1 **buffer) {
+	si8		i, j, first, last;
+
+	// determine the number of bytes to read (the runs, including the gaps within them)
+	*buffer = NULL;
+	si8 buffer_bytes = 0;
+	for (first = 0; first < num_entries; first = last + 1) {
+		last = first;
+		if (entries[first].file_offset < UNIVERSAL_HEADER_BYTES || entries[first].bytes < RECORD_HEADER_BYTES)		continue;
+		last = find_records_run_end(entries, num_entries, first);
+		buffer_bytes += entries[last].file_offset + entries[last].bytes - entries[first].file_offset;
+	}
+	if (buffer_bytes == 0)
+		return true;
+
+	*buffer = (ui1 *) malloc((size_t) buffer_bytes);
+	if (*buffer == NULL)
+		return false;
+
+	// read the runs
+	ui1 *data = *buffer;
+	for (first = 0; first < num_entries; first = last + 1) {
+		last = first;
+		if (entries[first].file_offset < UNIVERSAL_HEADER_BYTES || entries[first].bytes < RECORD_HEADER_BYTES)		continue;
+		last = find_records_run_end(entries, num_entries, first);
+		si8 run_bytes = entries[last].file_offset + entries[last].bytes - entries[first].file_offset;
+
+		#ifdef _WIN32
+			bool success = _fseeki64(fp, entries[first].file_offset, SEEK_SET) == 0;
+		#else
+			bool success = fseeko(fp, (off_t) entries[first].file_offset, SEEK_SET) == 0;
+		#endif
+		if (success)
+			success = fread(data, sizeof(ui1), (size_t) run_bytes, fp) == (size_t) run_bytes;
+
+		if (success)
+			for (j = first; j <= last; j++)
+				entries[j].header = (RECORD_HEADER *) (data + (entries[j].file_offset - entries[first].file_offset));
+		else
+			for (i = first; i <= last; i++)
+				mexPrintf("Warning: could not read the record at offset %lld of the record data file, skipping record\n", entries[i].file_offset);
+
+		data += run_bytes;
+	}
+
+	return true;
+
+}
+
+/**
+ * 	Prepare a selected record that was read for mapping: apply or remove the recording time offset (as configured in
+ * 	meflib), validate the CRC (if configured) and decrypt the body (if encrypted and the password gives access)
+ *
+ * 	@param entry				The selected record
+ * 	@param password_data		The password data of the level (NULL if not available)
+ * 	@param warned_access		Pointer to a flag whether a warning about encrypted bodies was already given (to warn only once)
+ */
+void prepare_selected_record(RECORD_QUERY_ENTRY *entry, PASSWORD_DATA *password_data, bool *warned_access) {
+	ui4		i;
+
+	RECORD_HEADER *rh = entry->header;
+	if (rh == NULL)		return;
+
+	// apply or remove the recording time offset (as decrypt_records in meflib does)
+	if (MEF_globals->recording_time_offset_mode & (RTO_APPLY | RTO_APPLY_ON_INPUT))
+		apply_recording_time_offset(&rh->time);
+	else if (MEF_globals->recording_time_offset_mode & (RTO_REMOVE | RTO_REMOVE_ON_INPUT))
+		remove_recording_time_offset(&rh->time);
+
+	// check whether the body lies within the range of the record
+	if ((si8) RECORD_HEADER_BYTES + (si8) rh->bytes > entry->bytes) {
+		mexPrintf("Warning: the body of the record at offset %lld extends beyond the next record, skipping body\n", entry->file_offset);
+		return;
+	}
+
+	// validate the CRC (calculated on the encrypted record)
+	if ((MEF_globals->CRC_mode & (CRC_VALIDATE | CRC_VALIDATE_ON_INPUT)) && rh->encryption >= NO_ENCRYPTION) {
+		if (CRC_validate((ui1 *) rh + CRC_BYTES, RECORD_HEADER_BYTES + rh->bytes - CRC_BYTES, rh->record_CRC) == MEF_FALSE) {
+			mexPrintf("Warning: invalid CRC of the record at offset %lld, skipping body\n", entry->file_offset);
+			return;
+		}
+	}
+
+	// decrypt
+	if (rh->encryption > NO_ENCRYPTION) {
+		if (password_data == NULL || password_data->access_level < rh->encryption) {
+			if (!*warned_access)
+				mexPrintf("Warning: records are encrypted and the password does not give access to them, skipping the bodies of these records\n");
+			*warned_access = true;
+			return;
+		}
+
+		ui1 *decryption_key = (rh->encryption == LEVEL_1_ENCRYPTION) ? password_data->level_1_encryption_key : password_data->level_2_encryption_key;
+		ui1 *body = (ui1 *) rh + RECORD_HEADER_BYTES;
+		for (i = 0; i < rh->bytes / ENCRYPTION_BLOCK_BYTES; i++)
+			AES_decrypt(body + i * ENCRYPTION_BLOCK_BYTES, body + i * ENCRYPTION_BLOCK_BYTES, NULL, decryption_key);
+		rh->encryption = -rh->encryption;  // mark as currently decrypted
+	}
+
+	entry->readable_body = true;
+
+}
+
+/**
+ * 	Map selected records to a newly created columnar records matlab-struct
+ *
+ *	The struct holds a column with the time, version_major and version_minor of each record and a <records> x 4 char
+ *	matrix with the types. For each record type with a body (Note, EDFA, LNTP, Seiz, SyLg, CSti, ESti, Curs, Epoc)
+ *	there is a struct of columns (see map_records_type_columns) with the bodies of the records of that type, of which
+ *	the 'index' column holds the (1-based) rows of these records in the time/type/version columns.
+ *
+ * 	@param entries				The selected records (records that could not be read are left out)
+ * 	@param num_entries			The number of selected records
+ * 	@return						A pointer to the new matlab-struct
+ */
+mxArray *map_records_columns(RECORD_QUERY_ENTRY *entries, si8 num_entries) {
+	si8		i;
+	si4		j;
+
+	// count the records that were read
+	mwSize num_records = 0;
+	for (i = 0; i < num_entries; i++)
+		if (entries[i].header != NULL)		num_records++;
+
+	// create the struct with the columns of the headers
+	mxArray *mat_records = mxCreateStructMatrix(1, 1, RECORDS_NUMFIELDS, RECORDS_FIELDNAMES);
+	si8 *time				= (si8 *) create_records_column(mat_records, "time", num_records, mxINT64_CLASS);
+	ui1 *version_major		= (ui1 *) create_records_column(mat_records, "version_major", num_records, mxUINT8_CLASS);
+	ui1 *version_minor		= (ui1 *) create_records_column(mat_records, "version_minor", num_records, mxUINT8_CLASS);
+	mwSize type_dims[2] = {num_records, TYPE_BYTES - 1};
+	mxArray *mat_type = mxCreateCharArray(2, type_dims);
+	mxSetField(mat_records, 0, "type", mat_type);
+	mxChar *type = mxGetChars(mat_type);
+
+	// fill the columns of the headers
+	mwSize row = 0;
+	for (i = 0; i < num_entries; i++) {
+		RECORD_HEADER *rh = entries[i].header;
+		if (rh == NULL)		continue;
+
+		time[row] = rh->time;
+		version_major[row] = rh->version_major;
+		version_minor[row] = rh->version_minor;
+		for (j = 0; j < TYPE_BYTES - 1; j++)
+			type[j * num_records + row] = (mxChar) (ui1) rh->type_string[j];
+		row++;
+	}
+
+	// map the bodies, per type
+	for (j = 0; j < RECORDS_NUM_BODY_TYPES; j++)
+		mxSetField(mat_records, 0, RECORDS_FIELDNAMES[4 + j], map_records_type_columns(RECORDS_BODY_TYPE_CODES[j], entries, num_entries));
+
+	// return the struct
+	return mat_records;
+
+}
+
+/**
+ * 	Map the bodies of the selected records of a single type to a newly created (1x1) matlab-struct with a column per field
+ *
+ *	The fields are those of the body struct that is mapped for a record of the type by map_mef3_records, with text as
+ *	cell columns. The 'index' column holds the (1-based) row of each record in the columns of map_records_columns. Only
+ *	the bodies that were read, have a known version (1.0) and - for fixed-size bodies - hold the whole body struct are mapped.
+ *
+ * 	@param type_code			The type code (MEFREC_*_TYPE_CODE) of the records
+ * 	@param entries				The selected records
+ * 	@param num_entries			The number of selected records
+ * 	@return						A pointer to the new matlab-struct
+ */
+mxArray *map_records_type_columns(ui4 type_code, RECORD_QUERY_ENTRY *entries, si8 num_entries) {
+	mwSize	i;
+	mwSize	n = 0;
+	bool	warned_version = false;
+	bool	warned_bytes = false;
+
+	// gather the records of the type and their rows in the header columns
+	RECORD_HEADER **records = (RECORD_HEADER **) mxMalloc((size_t) (num_entries > 0 ? num_entries : 1) * sizeof(RECORD_HEADER *));
+	sf8 *rows = (sf8 *) mxMalloc((size_t) (num_entries > 0 ? num_entries : 1) * sizeof(sf8));
+	mwSize row = 0;
+	si8 body_bytes = record_body_struct_bytes(type_code);
+	for (i = 0; i < (mwSize) num_entries; i++) {
+		RECORD_HEADER *rh = entries[i].header;
+		if (rh == NULL)		continue;
+		row++;
+
+		if (*((ui4 *) rh->type_string) != type_code || !entries[i].readable_body)	continue;
+		if (rh->version_major != 1 || rh->version_minor != 0) {
+			if (!warned_version)
+				mexPrintf("Warning: unrecognized %s version, skipping %s body\n", rh->type_string, rh->type_string);
+			warned_version = true;
+			continue;
+		}
+		if ((si8) rh->bytes < body_bytes) {
+			if (!warned_bytes)
+				mexPrintf("Warning: %s body is smaller than expected, skipping %s body\n", rh->type_string, rh->type_string);
+			warned_bytes = true;
+			continue;
+		}
+
+		records[n] = rh;
+		rows[n] = (sf8) row;
+		n++;
+	}
+
+	// create the struct and the columns, fill the columns one field at a time
+	mxArray *mat_type = NULL;
+	switch (type_code) {
+		case MEFREC_Note_TYPE_CODE:
+		case MEFREC_SyLg_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "text"};
+				mat_type = mxCreateStructMatrix(1, 1, 2, fieldnames);
+				mxArray *text = create_records_text_column(mat_type, "text", n);
+				for (i = 0; i < n; i++)		mxSetCell(text, i, create_record_string((si1 *) records[i] + RECORD_HEADER_BYTES, records[i]->bytes));
+			}
+
+			break;
+		case MEFREC_EDFA_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "duration"};
+				mat_type = mxCreateStructMatrix(1, 1, 2, fieldnames);
+				si8 *duration = (si8 *) create_records_column(mat_type, "duration", n, mxINT64_CLASS);
+				for (i = 0; i < n; i++)		duration[i] = ((MEFREC_EDFA_1_0 *) ((ui1 *) records[i] + MEFREC_EDFA_1_0_OFFSET))->duration;
+			}
+
+			break;
+		case MEFREC_LNTP_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "length"};
+				mat_type = mxCreateStructMatrix(1, 1, 2, fieldnames);
+				si8 *length = (si8 *) create_records_column(mat_type, "length", n, mxINT64_CLASS);
+				for (i = 0; i < n; i++)		length[i] = ((MEFREC_LNTP_1_0 *) ((ui1 *) records[i] + MEFREC_LNTP_1_0_OFFSET))->length;
+			}
+
+			break;
+		case MEFREC_Seiz_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "earliest_onset", "latest_offset", "duration", "number_of_channels", "onset_code", "marker_name_1", "marker_name_2", "annotation"};
+				mat_type = mxCreateStructMatrix(1, 1, 9, fieldnames);
+				si8 *earliest_onset 		= (si8 *) create_records_column(mat_type, "earliest_onset", n, mxINT64_CLASS);
+				si8 *latest_offset 			= (si8 *) create_records_column(mat_type, "latest_offset", n, mxINT64_CLASS);
+				si8 *duration 				= (si8 *) create_records_column(mat_type, "duration", n, mxINT64_CLASS);
+				si4 *number_of_channels 	= (si4 *) create_records_column(mat_type, "number_of_channels", n, mxINT32_CLASS);
+				si4 *onset_code 			= (si4 *) create_records_column(mat_type, "onset_code", n, mxINT32_CLASS);
+				mxArray *marker_name_1 		= create_records_text_column(mat_type, "marker_name_1", n);
+				mxArray *marker_name_2 		= create_records_text_column(mat_type, "marker_name_2", n);
+				mxArray *annotation 		= create_records_text_column(mat_type, "annotation", n);
+				for (i = 0; i < n; i++) {
+					MEFREC_Seiz_1_0 *seiz = (MEFREC_Seiz_1_0 *) ((ui1 *) records[i] + MEFREC_Seiz_1_0_OFFSET);
+					earliest_onset[i] = seiz->earliest_onset;
+					latest_offset[i] = seiz->latest_offset;
+					duration[i] = seiz->duration;
+					number_of_channels[i] = seiz->number_of_channels;
+					onset_code[i] = seiz->onset_code;
+					mxSetCell(marker_name_1, i, create_record_string(seiz->marker_name_1, sizeof(seiz->marker_name_1)));
+					mxSetCell(marker_name_2, i, create_record_string(seiz->marker_name_2, sizeof(seiz->marker_name_2)));
+					mxSetCell(annotation, i, create_record_string(seiz->annotation, sizeof(seiz->annotation)));
+				}
+			}
+
+			break;
+		case MEFREC_CSti_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "task_type", "stimulus_duration", "stimulus_type", "patient_response"};
+				mat_type = mxCreateStructMatrix(1, 1, 5, fieldnames);
+				mxArray *task_type 			= create_records_text_column(mat_type, "task_type", n);
+				si8 *stimulus_duration 		= (si8 *) create_records_column(mat_type, "stimulus_duration", n, mxINT64_CLASS);
+				mxArray *stimulus_type 		= create_records_text_column(mat_type, "stimulus_type", n);
+				mxArray *patient_response 	= create_records_text_column(mat_type, "patient_response", n);
+				for (i = 0; i < n; i++) {
+					MEFREC_CSti_1_0 *csti = (MEFREC_CSti_1_0 *) ((ui1 *) records[i] + MEFREC_CSti_1_0_OFFSET);
+					mxSetCell(task_type, i, create_record_string(csti->task_type, sizeof(csti->task_type)));
+					stimulus_duration[i] = csti->stimulus_duration;
+					mxSetCell(stimulus_type, i, create_record_string(csti->stimulus_type, sizeof(csti->stimulus_type)));
+					mxSetCell(patient_response, i, create_record_string(csti->patient_response, sizeof(csti->patient_response)));
+				}
+			}
+
+			break;
+		case MEFREC_ESti_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "amplitude", "frequency", "pulse_width", "ampunit_code", "mode_code", "waveform", "anode", "catode"};
+				mat_type = mxCreateStructMatrix(1, 1, 9, fieldnames);
+				sf8 *amplitude 				= (sf8 *) create_records_column(mat_type, "amplitude", n, mxDOUBLE_CLASS);
+				sf8 *frequency 				= (sf8 *) create_records_column(mat_type, "frequency", n, mxDOUBLE_CLASS);
+				si8 *pulse_width 			= (si8 *) create_records_column(mat_type, "pulse_width", n, mxINT64_CLASS);
+				si4 *ampunit_code 			= (si4 *) create_records_column(mat_type, "ampunit_code", n, mxINT32_CLASS);
+				si4 *mode_code 				= (si4 *) create_records_column(mat_type, "mode_code", n, mxINT32_CLASS);
+				mxArray *waveform 			= create_records_text_column(mat_type, "waveform", n);
+				mxArray *anode 				= create_records_text_column(mat_type, "anode", n);
+				mxArray *catode 			= create_records_text_column(mat_type, "catode", n);
+				for (i = 0; i < n; i++) {
+					MEFREC_ESti_1_0 *esti = (MEFREC_ESti_1_0 *) ((ui1 *) records[i] + MEFREC_ESti_1_0_OFFSET);
+					amplitude[i] = esti->amplitude;
+					frequency[i] = esti->frequency;
+					pulse_width[i] = esti->pulse_width;
+					ampunit_code[i] = esti->ampunit_code;
+					mode_code[i] = esti->mode_code;
+					mxSetCell(waveform, i, create_record_string(esti->waveform, sizeof(esti->waveform)));
+					mxSetCell(anode, i, create_record_string(esti->anode, sizeof(esti->anode)));
+					mxSetCell(catode, i, create_record_string(esti->catode, sizeof(esti->catode)));
+				}
+			}
+
+			break;
+		case MEFREC_Curs_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "id_number", "trace_timestamp", "latency", "value", "name"};
+				mat_type = mxCreateStructMatrix(1, 1, 6, fieldnames);
+				si8 *id_number 				= (si8 *) create_records_column(mat_type, "id_number", n, mxINT64_CLASS);
+				si8 *trace_timestamp 		= (si8 *) create_records_column(mat_type, "trace_timestamp", n, mxINT64_CLASS);
+				si8 *latency 				= (si8 *) create_records_column(mat_type, "latency", n, mxINT64_CLASS);
+				sf8 *value 					= (sf8 *) create_records_column(mat_type, "value", n, mxDOUBLE_CLASS);
+				mxArray *name 				= create_records_text_column(mat_type, "name", n);
+				for (i = 0; i < n; i++) {
+					MEFREC_Curs_1_0 *cursor = (MEFREC_Curs_1_0 *) ((ui1 *) records[i] + MEFREC_Curs_1_0_OFFSET);
+					id_number[i] = cursor->id_number;
+					trace_timestamp[i] = cursor->trace_timestamp;
+					latency[i] = cursor->latency;
+					value[i] = cursor->value;
+					mxSetCell(name, i, create_record_string(cursor->name, sizeof(cursor->name)));
+				}
+			}
+
+			break;
+		case MEFREC_Epoc_TYPE_CODE:
+			{
+				const char *fieldnames[] = {"index", "id_number", "timestamp", "end_timestamp", "duration", "type", "text"};
+				mat_type = mxCreateStructMatrix(1, 1, 7, fieldnames);
+				si8 *id_number 				= (si8 *) create_records_column(mat_type, "id_number", n, mxINT64_CLASS);
+				si8 *timestamp 				= (si8 *) create_records_column(mat_type, "timestamp", n, mxINT64_CLASS);
+				si8 *end_timestamp 			= (si8 *) create_records_column(mat_type, "end_timestamp", n, mxINT64_CLASS);
+				si8 *duration 				= (si8 *) create_records_column(mat_type, "duration", n, mxINT64_CLASS);
+				mxArray *epoch_type 		= create_records_text_column(mat_type, "type", n);
+				mxArray *text 				= create_records_text_column(mat_type, "text", n);
+				for (i = 0; i < n; i++) {
+					MEFREC_Epoc_1_0 *epoc = (MEFREC_Epoc_1_0 *) ((ui1 *) records[i] + MEFREC_Epoc_1_0_OFFSET);
+					id_number[i] = epoc->id_number;
+					timestamp[i] = epoc->timestamp;
+					end_timestamp[i] = epoc->end_timestamp;
+					duration[i] = epoc->duration;
+					mxSetCell(epoch_type, i, create_record_string(epoc->epoch_type, sizeof(epoc->epoch_type)));
+					mxSetCell(text, i, create_record_string(epoc->text, sizeof(epoc->text)));
+				}
+			}
+
+			break;
+		default:
+			{
+				const char *fieldnames[] = {"index"};
+				mat_type = mxCreateStructMatrix(1, 1, 1, fieldnames);
+			}
+	}
+
+	// the rows of the records
+	sf8 *index = (sf8 *) create_records_column(mat_type, "index", n, mxDOUBLE_CLASS);
+	memcpy(index, rows, (size_t) n * sizeof(sf8));
+
+	mxFree(records);
+	mxFree(rows);
+
+	// return the struct
+	return mat_type;
+
+}
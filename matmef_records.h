@@ -0,0 +1,47 @@
+#ifndef MATMEF_RECORDS_
+#define MATMEF_RECORDS_
+/**
+ * 	@file - headers
+ * 	Query of the records (annotations) of a session, channel or segment, filtered by type and time, into columnar matlab-structs
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "meflib/meflib/meflib.h"
+#include <stdbool.h>
+
+
+//
+// Structures
+//
+
+// A record that was selected (by its record index) and read
+typedef struct {
+	si8				file_offset;		// the offset of the record in the record data file
+	si8				bytes;				// the number of bytes of the record in the file (header and body; from the record indices)
+	RECORD_HEADER	*header;			// the record (header followed by the body) as read, NULL if it could not be read
+	bool			readable_body;		// whether the body was read, validated and (if needed) decrypted
+} RECORD_QUERY_ENTRY;
+
+
+//
+// Functions
+//
+
+mxArray *query_records_from_path(si1 *level_path, si1 *password, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end);
+mxArray *query_records(FILE_PROCESSING_STRUCT *ri_fps, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end);
+si8 select_record_indices(FILE_PROCESSING_STRUCT *ri_fps, si8 rd_file_length, ui4 *type_codes, si4 num_type_codes, si8 range_start, si8 range_end, RECORD_QUERY_ENTRY **entries);
+bool read_selected_records(FILE *fp, RECORD_QUERY_ENTRY *entries, si8 num_entries, ui1 **buffer);
+void prepare_selected_record(RECORD_QUERY_ENTRY *entry, PASSWORD_DATA *password_data, bool *warned_access);
+mxArray *map_records_columns(RECORD_QUERY_ENTRY *entries, si8 num_entries);
+mxArray *map_records_type_columns(ui4 type_code, RECORD_QUERY_ENTRY *entries, si8 num_entries);
+
+
+#endif   // MATMEF_RECORDS_
@@ -0,0 +1,153 @@
+/**
+ * 	@file
+ * 	Minimal cross-platform threading functions (pthreads or Windows threads)
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "matmef_threads.h"
+
+
+// the native thread entry-points, which pass on to the thread function
+#ifdef _WIN32
+static DWORD WINAPI thread_entry(LPVOID arg) {
+	THREAD *thread = (THREAD *) arg;
+	thread->func(thread->arg);
+	return 0;
+}
+#else
+static void *thread_entry(void *arg) {
+	THREAD *thread = (THREAD *) arg;
+	thread->func(thread->arg);
+	return NULL;
+}
+#endif
+
+
+/**
+ * 	Start a new thread
+ *
+ *	Note: the thread struct is passed to the new thread, so it should remain valid until the thread is joined
+ *
+ * 	@param thread               Pointer to the thread struct that will hold the thread handle
+ * 	@param func                 The function to run in the thread
+ * 	@param arg                  The argument that is passed to the function
+ * 	@return                     True if the thread was started, false on failure
+ */
+bool thread_create(THREAD *thread, THREAD_FUNC func, void *arg) {
+	thread->func = func;
+	thread->arg = arg;
+
+#ifdef _WIN32
+	thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+	return thread->handle != NULL;
+#else
+	return pthread_create(&thread->handle, NULL, thread_entry, thread) == 0;
+#endif
+
+}
+
+/**
+ * 	Wait for a thread to finish and release the thread handle
+ *
+ * 	@param thread               Pointer to the thread struct of a started thread
+ */
+void thread_join(THREAD *thread) {
+
+#ifdef _WIN32
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->handle, NULL);
+#endif
+
+}
+
+/**
+ * 	Run a function on a number of threads and wait for all of them to finish
+ *
+ *	Each thread receives its own argument from the args array. The last argument is processed on the
+ *	calling thread, so a single thread (or a failure to start threads) results in the function
+ *	simply being called sequentially on the calling thread.
+ *
+ * 	@param num_threads          The number of threads to run the function on
+ * 	@param func                 The function to run
+ * 	@param args                 Array of (num_threads) arguments, one for each thread
+ * 	@param arg_bytes            The size of a single argument in the array (in bytes)
+ * 	@return                     True if successful, false if one or more threads could not be started (these are then run on the calling thread)
+ */
+bool run_threads(si4 num_threads, THREAD_FUNC func, void *args, size_t arg_bytes) {
+	si4		i;
+	bool	started_all = true;
+
+	if (num_threads < 1)	return true;
+
+	// allocate the thread handles
+	THREAD *threads = (THREAD *) calloc((size_t) num_threads, sizeof(THREAD));
+	bool *started = (bool *) calloc((size_t) num_threads, sizeof(bool));
+	if (threads == NULL || started == NULL) {
+		free(threads);
+		free(started);
+		for (i = 0; i < num_threads; i++)
+			func((ui1 *) args + (i * arg_bytes));
+		return false;
+	}
+
+	// start all but the last on a new thread
+	for (i = 0; i < num_threads - 1; i++) {
+		started[i] = thread_create(&threads[i], func, (ui1 *) args + (i * arg_bytes));
+		if (!started[i])	started_all = false;
+	}
+
+	// run the last on the calling thread, and any that failed to start
+	func((ui1 *) args + ((num_threads - 1) * arg_bytes));
+	for (i = 0; i < num_threads - 1; i++)
+		if (!started[i])	func((ui1 *) args + (i * arg_bytes));
+
+	// wait for the threads to finish
+	for (i = 0; i < num_threads - 1; i++)
+		if (started[i])		thread_join(&threads[i]);
+
+	free(threads);
+	free(started);
+	return started_all;
+
+}
+
+/**
+ * 	Retrieve the number of (online) logical processors
+ *
+ * 	@return                     The number of processors, or 1 if it could not be determined
+ */
+si4 get_number_of_processors() {
+
+#ifdef _WIN32
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	return (sysinfo.dwNumberOfProcessors > 0) ? (si4) sysinfo.dwNumberOfProcessors : 1;
+#else
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	return (num > 0) ? (si4) num : 1;
+#endif
+
+}
+
+/**
+ * 	Resolve a requested number of threads to the number that will be used
+ *
+ * 	@param num_threads          The requested number of threads (0 = one thread per processor)
+ * 	@param num_tasks            The number of tasks that are to be divided over the threads (threads are capped at this number)
+ * 	@return                     The number of threads to use (at least 1)
+ */
+si4 resolve_number_of_threads(si4 num_threads, si8 num_tasks) {
+	if (num_threads < 1)					num_threads = get_number_of_processors();
+	if ((si8) num_threads > num_tasks)		num_threads = (si4) num_tasks;
+	if (num_threads < 1)					num_threads = 1;
+	return num_threads;
+}
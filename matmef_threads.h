@@ -0,0 +1,50 @@
+#ifndef MATMEF_THREADS_
+#define MATMEF_THREADS_
+/**
+ * 	@file - headers
+ * 	Minimal cross-platform threading functions (pthreads or Windows threads)
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "meflib/meflib/meflib.h"
+#include <stdbool.h>
+
+#ifndef _WIN32
+	#include <pthread.h>
+#endif
+
+
+// Thread function (the return value is not used)
+typedef void (*THREAD_FUNC)(void *arg);
+
+// Thread handle
+typedef struct {
+	THREAD_FUNC		func;
+	void			*arg;
+	#ifdef _WIN32
+		HANDLE		handle;
+	#else
+		pthread_t	handle;
+	#endif
+} THREAD;
+
+
+//
+// Functions
+//
+
+bool thread_create(THREAD *thread, THREAD_FUNC func, void *arg);
+void thread_join(THREAD *thread);
+bool run_threads(si4 num_threads, THREAD_FUNC func, void *args, size_t arg_bytes);
+si4 get_number_of_processors();
+si4 resolve_number_of_threads(si4 num_threads, si8 num_tasks);
+
+
+#endif   // MATMEF_THREADS_
@@ -183,6 +183,46 @@ bool write_metadata(si1 *segment_path, si1 *password_l1, si1 *password_l2, si8 s
 	
 }
 
+/**
+ * 	Extract the segment name from the path to a segment directory, and check whether the path is indeed that
+ *  of a segment directory in a time-series channel directory
+ *
+ * 	@param segment_path         The path to the segment directory
+ * 	@param segment_name         Buffer (of MEF_BASE_FILE_NAME_BYTES) that will hold the segment name
+ * 	@return                     True if the path is that of a time-series segment, or False if not
+ */
+bool extract_ts_segment_name(si1 *segment_path, si1 *segment_name) {
+    si1     path_in[MEF_FULL_FILE_NAME_BYTES], path_out[MEF_FULL_FILE_NAME_BYTES], name[MEF_BASE_FILE_NAME_BYTES], type[TYPE_BYTES];
+	
+	// extract the segment name and check the directory-type (if indeed segment)
+	extract_path_parts(segment_path, path_out, name, type);
+    if (!strcmp(type, SEGMENT_DIRECTORY_TYPE_STRING)) {
+		// segment type/directory
+
+        // copy the segment name for file name construction later
+        MEF_strncpy(segment_name, name, MEF_BASE_FILE_NAME_BYTES);
+		
+		// extract the channel name and check the type (if indeed time-series)
+        MEF_strncpy(path_in, path_out, MEF_FULL_FILE_NAME_BYTES);
+        extract_path_parts(path_in, path_out, name, type);
+        if (strcmp(type, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING)) {
+			// incorrect directory-type
+			
+			mexPrintf("Error: Not a time-series channel, exiting...\n");
+            return false;
+        }
+		
+    } else {
+		// not segment type/directory
+		
+		mexPrintf("Error: Not a segment, exiting...\n");
+        return false;
+    }
+	
+	return true;
+	
+}
+
 /**
  * 	Write time-series data (.tdat & .tidx files) to a segment directory. 
  * 
@@ -196,23 +236,18 @@ bool write_metadata(si1 *segment_path, si1 *password_l1, si1 *password_l2, si8 s
  * 	@param password_l2          Level 2 password for the data (no password = NULL)
  *	@param samples_per_block    Number of samples per MEF3 block
  *	@param data             	The data to write as a 1-D array of data-type int32
+ *	@param lossy_flag           Whether to use lossy compression
+ *  @param num_threads          The number of threads used to encode the data (1 = single-threaded; 0 = one per processor). The 
+ *                              blocks are encoded in batches by the threads and written in order, so the output is the same
  * 	@return                     True if succesfully written, or False on failure
  */
-bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, ui4 samples_per_block, const mxArray *data, bool lossy_flag) {
+bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, ui4 samples_per_block, const mxArray *data, bool lossy_flag, si4 num_threads) {
     
     PASSWORD_DATA           *pwd;
     UNIVERSAL_HEADER    	*ts_data_uh;
     FILE_PROCESSING_STRUCT  *gen_fps, *metadata_fps;
-	TIME_SERIES_INDEX   	*tsi;
-    RED_PROCESSING_STRUCT   *rps;
-	RED_BLOCK_HEADER    	*block_header;
 	
-    si1     path_in[MEF_FULL_FILE_NAME_BYTES], path_out[MEF_FULL_FILE_NAME_BYTES], name[MEF_BASE_FILE_NAME_BYTES], type[TYPE_BYTES];
     si1     full_file_name[MEF_FULL_FILE_NAME_BYTES], file_path[MEF_FULL_FILE_NAME_BYTES], segment_name[MEF_BASE_FILE_NAME_BYTES];
-	si4     max_samp, min_samp;
-    ui4     block_samps;
-    si8     start_sample, samps_remaining, file_offset;
-	si8     curr_time, time_inc;
 
 	//
 	// 
@@ -242,38 +277,10 @@ bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *pas
     pwd = process_password_data(NULL, password_l1, password_l2, gen_fps->universal_header);
     MEF_globals->behavior_on_fail = EXIT_ON_FAIL;
 	
-	// extract the segment name and check the directory-type (if indeed segment)
-	extract_path_parts(segment_path, path_out, name, type);
+	// extract the segment name and check the directory-type (if indeed a time-series segment)
     MEF_strncpy(file_path, segment_path, MEF_FULL_FILE_NAME_BYTES);
-    if (!strcmp(type, SEGMENT_DIRECTORY_TYPE_STRING)) {
-		// segment type/directory
-
-        // copy the segment name for file name construction later
-        MEF_strncpy(segment_name, name, MEF_BASE_FILE_NAME_BYTES);
-		
-		// extract the channel name and check the type (if indeed time-series)
-        MEF_strncpy(path_in, path_out, MEF_FULL_FILE_NAME_BYTES);
-        extract_path_parts(path_in, path_out, name, type);
-        if (!strcmp(type, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING)) {
-			// correct/corresponding directory-type
-			
-            // extract the session name
-            MEF_strncpy(path_in, path_out, MEF_FULL_FILE_NAME_BYTES);
-            extract_path_parts(path_in, path_out, name, type);
-			
-        } else {
-			// incorrect directory-type
-			
-			mexPrintf("Error: Not a time-series channel, exiting...\n");
-            return false;
-        }
-		
-    } else {
-		// not segment type/directory
-		
-		mexPrintf("Error: Not a segment, exiting...\n");
-        return false;
-    }
+	if (!extract_ts_segment_name(segment_path, segment_name))
+		return false;
 	
 	
 	
@@ -353,81 +360,19 @@ bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *pas
 	//
 	//
 	
-    // TODO optional filtration
-    // use allocation below if lossy
-    if (lossy_flag == 1) {
-        
-		rps = RED_allocate_processing_struct(samples_per_block, 0, samples_per_block, RED_MAX_DIFFERENCE_BYTES(samples_per_block), samples_per_block, samples_per_block, pwd);
-        // ASK RED lossy compression user specified???
-        rps->compression.mode = RED_MEAN_RESIDUAL_RATIO;
-        rps->directives.detrend_data = MEF_TRUE;
-        rps->directives.require_normality = MEF_TRUE;
-        rps->compression.goal_mean_residual_ratio = 0.10;
-        rps->compression.goal_tolerance = 0.01;
-		
-    } else {
-        
-		rps = RED_allocate_processing_struct(samples_per_block, 0, 0, RED_MAX_DIFFERENCE_BYTES(samples_per_block), 0, 0, pwd);
-		
-    }
-    rps->block_header = (RED_BLOCK_HEADER *) (rps->compressed_data = ts_data_fps->RED_blocks);
-
-    // create new RED blocks
-    curr_time = metadata_fps->universal_header->start_time;
-    time_inc = (si8) (((sf8) samples_per_block / tmd2->sampling_frequency) * (sf8) 1e6);
-    samps_remaining = tmd2->number_of_samples;
-    block_header = rps->block_header;
-    tsi = ts_idx_fps->time_series_indices;
-    min_samp = RED_POSITIVE_INFINITY;
-    max_samp = RED_NEGATIVE_INFINITY;
-    block_samps = samples_per_block;
-    file_offset = UNIVERSAL_HEADER_BYTES;
-
-    start_sample = 0;
-
     // Write the data and update the metadata
-    while (samps_remaining) {
-
-        // check
-        if (samps_remaining < block_samps)
-            block_samps = (ui4) samps_remaining;
-        block_header->number_of_samples = block_samps;
-        block_header->start_time = (si8) (curr_time + 0.5); // ASK Why 0.5 here?
-        curr_time += time_inc;
-
-        rps->original_data = rps->original_ptr = (si4 *)pData + (tmd2->number_of_samples - samps_remaining);
-
-        // filter - comment out if don't want
-        // filtps->data_length = block_samps;
-        // RED_filter(filtps);
-
-        samps_remaining -= (si8) block_samps;
-
-        // compress
-        (void) RED_encode(rps);
-        ts_data_fps->universal_header->body_CRC = CRC_update((ui1 *) block_header, block_header->block_bytes, ts_data_fps->universal_header->body_CRC);
-        e_fwrite((void *) block_header, sizeof(ui1), block_header->block_bytes, ts_data_fps->fp, ts_data_fps->full_file_name, __FUNCTION__, __LINE__, EXIT_ON_FAIL);
-
-        // time series indices
-        tsi->file_offset = file_offset;
-        file_offset += (tsi->block_bytes = block_header->block_bytes);
-        tsi->start_time = block_header->start_time;
-        tsi->start_sample = start_sample;
-        start_sample += (tsi->number_of_samples = (si8) block_samps);
-        RED_find_extrema(rps->original_ptr, block_samps, tsi);
-        if (max_samp < tsi->maximum_sample_value)
-            max_samp = tsi->maximum_sample_value;
-        if (min_samp > tsi->minimum_sample_value)
-            min_samp = tsi->minimum_sample_value;
-        tsi->RED_block_flags = block_header->flags;
-        ++tsi;
-
-        // update metadata
-        if (tmd2->maximum_block_bytes < block_header->block_bytes)
-            tmd2->maximum_block_bytes = block_header->block_bytes;
-        if (tmd2->maximum_difference_bytes < block_header->difference_bytes)
-            tmd2->maximum_difference_bytes = block_header->difference_bytes;
-    }
+	si4 min_samp = RED_POSITIVE_INFINITY, max_samp = RED_NEGATIVE_INFINITY;
+	si8 file_offset = UNIVERSAL_HEADER_BYTES;
+	bool success = write_ts_blocks(ts_data_fps, tmd2, ts_idx_fps->time_series_indices, pData, tmd2->number_of_samples, samples_per_block, 
+								   metadata_fps->universal_header->start_time, 0, true, pwd, lossy_flag, num_threads, &file_offset, &min_samp, &max_samp);
+	if (!success) {
+		fclose(ts_data_fps->fp);
+		free_file_processing_struct(metadata_fps);
+		free_file_processing_struct(ts_data_fps);
+		free_file_processing_struct(ts_idx_fps);
+		free_file_processing_struct(gen_fps);
+		return false;
+	}
 
     // update metadata
     tmd2->maximum_contiguous_block_bytes = file_offset - UNIVERSAL_HEADER_BYTES;
@@ -459,13 +404,498 @@ bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *pas
     free_file_processing_struct(ts_data_fps);
     free_file_processing_struct(ts_idx_fps);
     free_file_processing_struct(gen_fps);
-    rps->block_header = NULL;
-    rps->compressed_data = NULL;
-    rps->original_data = NULL;
-    rps->original_ptr = NULL;
-    RED_free_processing_struct(rps);
 
 	// return succes
 	return true;
 	
-}
\ No newline at end of file
+}
+
+/**
+ * 	Append time-series data to the existing data (.tdat & .tidx files) of a segment directory.
+ * 
+ *  Only the new samples are encoded into blocks, which are appended to the end of the data file. The indices of the new
+ *  blocks are appended to the indices file, the universal-headers (entries, CRCs and end time) of both files are updated
+ *  in place and the time-series section 2 fields in the metadata file (.tmet) are updated incrementally. The blocks that
+ *  were written before are not rewritten. The new blocks directly follow the last block in time, and have the same number
+ *  of samples per block as the existing data (the maximum block samples in the metadata).
+ *
+ *  Note:  This function requires that the segment already has time-series data (.tdat & .tidx files), which were
+ *         written using write_mef_ts_data_and_indices
+ * 	
+ * 	@param segment_path         The path to the segment directory
+ * 	@param password_l1          Level 1 password for the data (no password = NULL)
+ * 	@param password_l2          Level 2 password for the data (no password = NULL)
+ *	@param data             	The data to append as a 1-D array of data-type int32
+ *	@param lossy_flag           Whether to use lossy compression
+ *  @param num_threads          The number of threads used to encode the data (1 = single-threaded; 0 = one per processor)
+ * 	@return                     True if succesfully appended, or False on failure
+ */
+bool append_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, const mxArray *data, bool lossy_flag, si4 num_threads) {
+	
+    PASSWORD_DATA           *pwd;
+    FILE_PROCESSING_STRUCT  *gen_fps, *metadata_fps;
+	TIME_SERIES_INDEX		last_tsi;
+    si1     full_file_name[MEF_FULL_FILE_NAME_BYTES], segment_name[MEF_BASE_FILE_NAME_BYTES];
+	
+	// if the password is just the null character, then correct to a null pointer
+	if (password_l1 != NULL && password_l1[0] == '\0')	password_l1 = NULL;
+	if (password_l2 != NULL && password_l2[0] == '\0')	password_l2 = NULL;
+	
+	// check the data type
+	if (mxGetClassID(data) != mxINT32_CLASS) {
+		mexPrintf("Error: Incorrect data-type, should be int32, exiting...\n");
+		return false;
+	}
+	si4 *pData = (si4 *) mxGetData(data);
+	si8 num_samps = (si8) mxGetDimensions(data)[0];
+	
+	// extract the segment name and check the directory-type (if indeed a time-series segment)
+	if (!extract_ts_segment_name(segment_path, segment_name))
+		return false;
+	
+	// initialize MEF library
+	(void) initialize_meflib();
+	
+    // set up a generic mef3 fps and process the password data with it
+    gen_fps = allocate_file_processing_struct(UNIVERSAL_HEADER_BYTES, NO_FILE_TYPE_CODE, NULL, NULL, 0);
+	initialize_universal_header(gen_fps, MEF_TRUE, MEF_FALSE, MEF_TRUE);
+    MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+    pwd = process_password_data(NULL, password_l1, password_l2, gen_fps->universal_header);
+	
+	
+	// 
+    // Read the existing time-series metadata file
+	// 
+    MEF_snprintf(full_file_name, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", segment_path, segment_name, TIME_SERIES_METADATA_FILE_TYPE_STRING);
+    metadata_fps = read_MEF_file(NULL, full_file_name, password_l1, pwd, NULL, USE_GLOBAL_BEHAVIOR);
+	if (metadata_fps == NULL) {
+		mexPrintf("Error: could not read the metadata file '%s', exiting...\n", full_file_name);
+		free_file_processing_struct(gen_fps);
+		return false;
+	}
+    MEF_globals->recording_time_offset = metadata_fps->metadata.section_3->recording_time_offset;
+    TIME_SERIES_METADATA_SECTION_2 *tmd2 = metadata_fps->metadata.time_series_section_2;
+	ui4 samples_per_block = (ui4) tmd2->maximum_block_samples;
+	
+	// check the block size (before it is used to determine the number of new blocks)
+	if (samples_per_block == 0) {
+		mexPrintf("Error: the metadata file '%s' has a maximum block size of 0 samples, exiting...\n", full_file_name);
+		free_file_processing_struct(metadata_fps);
+		free_file_processing_struct(gen_fps);
+		return false;
+	}
+	
+	
+	//
+	// Open the existing time-series data and indices files and read their universal-headers
+	// (the new indices are placed after the universal-header in the indices fps, and appended to the file from there)
+	//
+	
+	si8 num_blocks = (num_samps + samples_per_block - 1) / samples_per_block;
+	FILE_PROCESSING_STRUCT *ts_data_fps = allocate_file_processing_struct(UNIVERSAL_HEADER_BYTES, TIME_SERIES_DATA_FILE_TYPE_CODE, NULL, metadata_fps, 0);
+	FILE_PROCESSING_STRUCT *ts_idx_fps = allocate_file_processing_struct(UNIVERSAL_HEADER_BYTES + (num_blocks * TIME_SERIES_INDEX_BYTES), TIME_SERIES_INDICES_FILE_TYPE_CODE, NULL, metadata_fps, 0);
+    MEF_snprintf(ts_data_fps->full_file_name, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", segment_path, segment_name, TIME_SERIES_DATA_FILE_TYPE_STRING);
+    MEF_snprintf(ts_idx_fps->full_file_name, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s", segment_path, segment_name, TIME_SERIES_INDICES_FILE_TYPE_STRING);
+	ts_data_fps->directives.close_file = ts_idx_fps->directives.close_file = MEF_TRUE;
+	ts_data_fps->password_data = ts_idx_fps->password_data = NULL;
+	
+	bool success = true;
+	FILE_PROCESSING_STRUCT *fps[2] = {ts_data_fps, ts_idx_fps};
+	for (si4 i = 0; i < 2 && success; i++) {
+		fps[i]->fp = fopen(fps[i]->full_file_name, "r+b");
+		if (fps[i]->fp == NULL) {
+			mexPrintf("Error: could not open the file '%s', write the data before appending, exiting...\n", fps[i]->full_file_name);
+			success = false;
+		} else if (fread(fps[i]->raw_data, sizeof(ui1), UNIVERSAL_HEADER_BYTES, fps[i]->fp) != UNIVERSAL_HEADER_BYTES ||
+				   CRC_validate(fps[i]->raw_data + CRC_BYTES, UNIVERSAL_HEADER_BYTES - CRC_BYTES, fps[i]->universal_header->header_CRC) != MEF_TRUE) {
+			mexPrintf("Error: invalid universal-header in file '%s', exiting...\n", fps[i]->full_file_name);
+			success = false;
+		}
+	}
+	
+	// check whether the data and indices files match (with each other and the metadata)
+	if (success && (ts_data_fps->universal_header->number_of_entries != ts_idx_fps->universal_header->number_of_entries ||
+					ts_idx_fps->universal_header->number_of_entries != tmd2->number_of_blocks)) {
+		mexPrintf("Error: the number of blocks in the data, indices and metadata files do not match, exiting...\n");
+		success = false;
+	}
+	
+	// read the last index entry, the new blocks start where the last block ends
+	si8 start_time = metadata_fps->universal_header->start_time;
+	if (success && tmd2->number_of_blocks > 0) {
+		if (FSEEK64(ts_idx_fps->fp, -((si8) TIME_SERIES_INDEX_BYTES), SEEK_END) != 0 || fread(&last_tsi, TIME_SERIES_INDEX_BYTES, 1, ts_idx_fps->fp) != 1) {
+			mexPrintf("Error: could not read the last entry from the indices file, exiting...\n");
+			success = false;
+		} else {
+			start_time = last_tsi.start_time;
+			remove_recording_time_offset(&start_time);
+			start_time += (si8) (((sf8) last_tsi.number_of_samples / tmd2->sampling_frequency) * (sf8) 1e6);
+		}
+	}
+	
+	
+	// remember the lengths and universal-headers of the data and indices files, and the metadata file as it is 
+	// on disk, so that the files can be restored if the append fails partway
+	si8 file_lengths[2] = {0, 0};
+	ui1 original_headers[2][UNIVERSAL_HEADER_BYTES];
+	ui1 *original_metadata = NULL;
+	for (si4 i = 0; i < 2 && success; i++) {
+		memcpy(original_headers[i], fps[i]->raw_data, UNIVERSAL_HEADER_BYTES);
+		if (FSEEK64(fps[i]->fp, 0, SEEK_END) != 0 || (file_lengths[i] = (si8) FTELL64(fps[i]->fp)) < UNIVERSAL_HEADER_BYTES) {
+			mexPrintf("Error: could not determine the length of the file '%s', exiting...\n", fps[i]->full_file_name);
+			success = false;
+		}
+	}
+	if (success) {
+		FILE *metadata_fp = fopen(metadata_fps->full_file_name, "rb");
+		original_metadata = (ui1 *) malloc((size_t) metadata_fps->raw_data_bytes);
+		if (metadata_fp == NULL || original_metadata == NULL || 
+			fread(original_metadata, sizeof(ui1), (size_t) metadata_fps->raw_data_bytes, metadata_fp) != (size_t) metadata_fps->raw_data_bytes) {
+			mexPrintf("Error: could not read the metadata file '%s', exiting...\n", metadata_fps->full_file_name);
+			success = false;
+		}
+		if (metadata_fp != NULL)
+			fclose(metadata_fp);
+	}
+	bool appending = success;
+	
+	
+	//
+	// Encode the new samples and append the blocks to the data file
+	//
+	
+	si4 min_samp = RED_POSITIVE_INFINITY, max_samp = RED_NEGATIVE_INFINITY;
+	si8 file_offset = file_lengths[0];
+	if (success) {
+		success = write_ts_blocks(ts_data_fps, tmd2, ts_idx_fps->time_series_indices, pData, num_samps, samples_per_block, 
+								  start_time, tmd2->number_of_samples, false, pwd, lossy_flag, num_threads, &file_offset, &min_samp, &max_samp);
+	}
+	
+	// append the new indices to the indices file (in the file the times have the recording time offset applied, which the RED 
+	// encoder has already done for the block start times) and update the body CRC
+	if (success) {
+		if (FSEEK64(ts_idx_fps->fp, 0, SEEK_END) != 0 || 
+			fwrite(ts_idx_fps->time_series_indices, TIME_SERIES_INDEX_BYTES, (size_t) num_blocks, ts_idx_fps->fp) != (size_t) num_blocks) {
+			mexPrintf("Error: could not append to the indices file, exiting...\n");
+			success = false;
+		}
+		ts_idx_fps->universal_header->body_CRC = CRC_update((ui1 *) ts_idx_fps->time_series_indices, num_blocks * TIME_SERIES_INDEX_BYTES, ts_idx_fps->universal_header->body_CRC);
+	}
+	
+	
+	//
+	// Update the metadata and the universal headers
+	//
+	
+	if (success) {
+		
+		// time-series section 2 metadata
+		tmd2->number_of_samples += num_samps;
+		tmd2->number_of_blocks += num_blocks;
+		tmd2->recording_duration = (si8) (((sf8) tmd2->number_of_samples / (sf8) tmd2->sampling_frequency) * 1e6);
+		tmd2->maximum_contiguous_block_bytes = file_offset - UNIVERSAL_HEADER_BYTES;
+		tmd2->maximum_contiguous_blocks = tmd2->number_of_blocks;
+		sf8 max_native = (sf8) max_samp * tmd2->units_conversion_factor;
+		sf8 min_native = (sf8) min_samp * tmd2->units_conversion_factor;
+		if (tmd2->units_conversion_factor < 0.0) {
+			max_native = (sf8) min_samp * tmd2->units_conversion_factor;
+			min_native = (sf8) max_samp * tmd2->units_conversion_factor;
+		}
+		if (tmd2->maximum_native_sample_value < max_native)		tmd2->maximum_native_sample_value = max_native;
+		if (tmd2->minimum_native_sample_value > min_native)		tmd2->minimum_native_sample_value = min_native;
+		
+		// the end time of the data, the end of the last new block (extend the end time in the universal headers if the data ends later)
+		TIME_SERIES_INDEX *new_tsi = &ts_idx_fps->time_series_indices[num_blocks - 1];
+		si8 end_time = new_tsi->start_time;
+		remove_recording_time_offset(&end_time);
+		end_time += (si8) (((sf8) new_tsi->number_of_samples / tmd2->sampling_frequency) * (sf8) 1e6);
+		if (metadata_fps->universal_header->end_time < end_time)
+			metadata_fps->universal_header->end_time = end_time;
+		apply_recording_time_offset(&end_time);
+		
+		// update and rewrite the universal headers of the data and indices files
+		for (si4 i = 0; i < 2 && success; i++) {
+			fps[i]->universal_header->number_of_entries = tmd2->number_of_blocks;
+			if (ABS(fps[i]->universal_header->end_time) < ABS(end_time))
+				fps[i]->universal_header->end_time = end_time;
+			fps[i]->universal_header->header_CRC = CRC_calculate(fps[i]->raw_data + CRC_BYTES, UNIVERSAL_HEADER_BYTES - CRC_BYTES);
+			if (FSEEK64(fps[i]->fp, 0, SEEK_SET) != 0 || fwrite(fps[i]->raw_data, sizeof(ui1), UNIVERSAL_HEADER_BYTES, fps[i]->fp) != UNIVERSAL_HEADER_BYTES ||
+				fflush(fps[i]->fp) != 0) {
+				mexPrintf("Error: could not update the universal-header of file '%s', exiting...\n", fps[i]->full_file_name);
+				success = false;
+			}
+		}
+		
+		// write/update the time-series metadata file (over the existing file, and kept open to check whether it was written;
+		// write_MEF_file itself does not report write errors)
+		if (success) {
+			metadata_fps->fp = fopen(metadata_fps->full_file_name, "r+b");
+			if (metadata_fps->fp == NULL) {
+				mexPrintf("Error: could not open the metadata file '%s', exiting...\n", metadata_fps->full_file_name);
+				success = false;
+			} else {
+				metadata_fps->directives.close_file = MEF_FALSE;
+				write_MEF_file(metadata_fps);
+				if (ferror(metadata_fps->fp) || fflush(metadata_fps->fp) != 0) {
+					mexPrintf("Error: could not update the metadata file '%s', exiting...\n", metadata_fps->full_file_name);
+					success = false;
+					
+					// restore the metadata file
+					if (FSEEK64(metadata_fps->fp, 0, SEEK_SET) != 0 || 
+						fwrite(original_metadata, sizeof(ui1), (size_t) metadata_fps->raw_data_bytes, metadata_fps->fp) != (size_t) metadata_fps->raw_data_bytes)
+						mexPrintf("Error: could not restore the metadata file '%s'\n", metadata_fps->full_file_name);
+				}
+				if (fclose(metadata_fps->fp) != 0 && success) {
+					mexPrintf("Error: could not update the metadata file '%s', exiting...\n", metadata_fps->full_file_name);
+					success = false;
+				}
+				metadata_fps->fp = NULL;
+			}
+		}
+		
+	}
+	
+	// undo the append when it failed partway (remove the appended blocks and indices, and restore the universal-headers)
+	if (!success && appending) {
+		for (si4 i = 0; i < 2; i++) {
+			if (!restore_appended_file(fps[i]->fp, file_lengths[i], original_headers[i]))
+				mexPrintf("Error: could not restore the file '%s' to its state before the append\n", fps[i]->full_file_name);
+		}
+	}
+	
+    // clean up
+	free (original_metadata);
+    free_file_processing_struct(ts_data_fps);
+    free_file_processing_struct(ts_idx_fps);
+    free_file_processing_struct(metadata_fps);
+    free_file_processing_struct(gen_fps);
+	
+	return success;
+	
+}
+
+/**
+ * 	Restore an opened time-series data or indices file to its state before an append (truncate the file to its
+ *  previous length and rewrite its previous universal-header)
+ *
+ * 	@param fp                   The opened file
+ * 	@param length               The length of the file (in bytes) before the append
+ * 	@param header               The universal-header of the file before the append
+ * 	@return                     True if the file was restored, false on failure
+ */
+bool restore_appended_file(FILE *fp, si8 length, ui1 *header) {
+	
+	// write out what is buffered first, so that it is not written after the truncation
+	if (fflush(fp) != 0)
+		clearerr(fp);
+	
+	// truncate the file
+	#ifdef _WIN32
+		if (_chsize_s(_fileno(fp), length) != 0)					return false;
+	#else
+		if (ftruncate(fileno(fp), (off_t) length) != 0)			return false;
+	#endif
+	
+	// rewrite the universal-header
+	if (FSEEK64(fp, 0, SEEK_SET) != 0 || fwrite(header, sizeof(ui1), UNIVERSAL_HEADER_BYTES, fp) != UNIVERSAL_HEADER_BYTES)
+		return false;
+	return fflush(fp) == 0;
+	
+}
+
+/**
+ * 	Encode samples into RED blocks and write the blocks (in order) to the end of an opened time-series data file
+ *
+ *  The blocks are encoded in batches by multiple threads (each worker with its own RED processing struct), after
+ *  which the calling thread writes the blocks in order and updates the body CRC, indices and metadata maxima. The 
+ *  output is therefore the same regardless of the number of threads.
+ * 	
+ * 	@param ts_data_fps          The file-processing-struct of the time-series data file (the blocks are written to its file pointer 
+ *                              and the body CRC in its universal-header is updated)
+ * 	@param tmd2                 The time-series section 2 metadata (the maximum block and difference bytes are updated)
+ * 	@param tsi                  The time-series indices that will be filled for the blocks (one for each block)
+ *	@param data             	The samples to encode
+ *	@param num_samps            The number of samples to encode
+ *	@param samples_per_block    Number of samples per MEF3 block
+ *	@param start_time           The start time of the first block (the next blocks follow at intervals of samples_per_block)
+ *	@param start_sample         The start sample of the first block (in the segment)
+ *	@param discontinuity        Whether the first block is flagged as discontinuous
+ * 	@param pwd                  The password data (for encryption)
+ *	@param lossy_flag           Whether to use lossy compression
+ *  @param num_threads          The number of threads used to encode the data (1 = single-threaded; 0 = one per processor)
+ *	@param file_offset          Pointer to the offset in the data file where the first block is written, is updated to the end of the last block
+ *	@param min_samp             Pointer to the minimum sample value so far, is updated with the samples of the blocks
+ *	@param max_samp             Pointer to the maximum sample value so far, is updated with the samples of the blocks
+ * 	@return                     True if succesfully written, or False on failure
+ */
+bool write_ts_blocks(FILE_PROCESSING_STRUCT *ts_data_fps, TIME_SERIES_METADATA_SECTION_2 *tmd2, TIME_SERIES_INDEX *tsi, si4 *data, si8 num_samps, ui4 samples_per_block, 
+					 si8 start_time, si8 start_sample, bool discontinuity, PASSWORD_DATA *pwd, bool lossy_flag, si4 num_threads, si8 *file_offset, si4 *min_samp, si4 *max_samp) {
+	si8		i, j;
+	
+	// check the block size
+	if (samples_per_block == 0) {
+		mexPrintf("Error: invalid block size of 0 samples, exiting...\n");
+		return false;
+	}
+	
+	// determine the number of blocks, the number of threads, the size of a block slot (8-byte aligned) and the number of blocks each worker encodes per batch
+	si8 num_blocks = (num_samps + samples_per_block - 1) / samples_per_block;
+	num_threads = resolve_number_of_threads(num_threads, num_blocks);
+	ui8 slot_bytes = ((ui8) RED_MAX_COMPRESSED_BYTES(samples_per_block, 1) + 7) & ~((ui8) 7);
+	ui8 worker_blocks = WRITE_WORKER_BYTES / slot_bytes;
+	if (worker_blocks > WRITE_WORKER_BLOCKS)	worker_blocks = WRITE_WORKER_BLOCKS;
+	if (worker_blocks < 1)						worker_blocks = 1;
+	
+	// set up the workers that encode the blocks (each with its own RED processing struct and buffer)
+	ENCODE_WORKER *workers = (ENCODE_WORKER *) calloc((size_t) num_threads, sizeof(ENCODE_WORKER));
+	bool success = (workers != NULL);
+	for (i = 0; success && i < num_threads; i++) {
+		
+		// TODO optional filtration
+		// use allocation below if lossy
+		RED_PROCESSING_STRUCT *rps;
+		if (lossy_flag == 1) {
+			
+			rps = RED_allocate_processing_struct(samples_per_block, 0, samples_per_block, RED_MAX_DIFFERENCE_BYTES(samples_per_block), samples_per_block, samples_per_block, pwd);
+			// ASK RED lossy compression user specified???
+			rps->compression.mode = RED_MEAN_RESIDUAL_RATIO;
+			rps->directives.detrend_data = MEF_TRUE;
+			rps->directives.require_normality = MEF_TRUE;
+			rps->compression.goal_mean_residual_ratio = 0.10;
+			rps->compression.goal_tolerance = 0.01;
+			
+		} else {
+			
+			rps = RED_allocate_processing_struct(samples_per_block, 0, 0, RED_MAX_DIFFERENCE_BYTES(samples_per_block), 0, 0, pwd);
+			
+		}
+		
+		workers[i].rps = rps;
+		workers[i].buffer = (ui1 *) malloc((size_t) (worker_blocks * slot_bytes));
+		workers[i].slot_bytes = slot_bytes;
+		workers[i].data = data;
+		workers[i].number_of_samples = num_samps;
+		workers[i].samples_per_block = samples_per_block;
+		workers[i].start_time = start_time;
+		workers[i].time_inc = (si8) (((sf8) samples_per_block / tmd2->sampling_frequency) * (sf8) 1e6);
+		workers[i].discontinuity = discontinuity;
+		workers[i].tsi = tsi;
+		if (rps == NULL || workers[i].buffer == NULL)
+			success = false;
+		
+	}
+	if (!success)
+		mexPrintf("Error: could not allocate enough memory to encode the data, exiting...\n");
+	
+    // encode and write the blocks, a batch at a time
+	si8 block = 0;
+    while (success && block < num_blocks) {
+		
+		// divide the blocks of the batch over the workers
+		for (i = 0; i < num_threads; i++) {
+			workers[i].first_block = block;
+			workers[i].num_blocks = 0;
+			if (block < num_blocks) {
+				workers[i].num_blocks = (ui8) (num_blocks - block);
+				if (workers[i].num_blocks > worker_blocks)	workers[i].num_blocks = worker_blocks;
+				block += (si8) workers[i].num_blocks;
+			}
+		}
+		
+		// compress
+		run_threads(num_threads, encode_blocks_worker, workers, sizeof(ENCODE_WORKER));
+		
+		// write the encoded blocks in order
+		for (i = 0; success && i < num_threads; i++) {
+			for (j = 0; success && j < (si8) workers[i].num_blocks; j++) {
+				RED_BLOCK_HEADER *block_header = (RED_BLOCK_HEADER *) (workers[i].buffer + j * slot_bytes);
+				
+				// write the block (a failed write is returned, so that an append can be undone)
+				if (fwrite((void *) block_header, sizeof(ui1), block_header->block_bytes, ts_data_fps->fp) != block_header->block_bytes) {
+					mexPrintf("Error: could not write to the data file '%s', exiting...\n", ts_data_fps->full_file_name);
+					success = false;
+					break;
+				}
+				ts_data_fps->universal_header->body_CRC = CRC_update((ui1 *) block_header, block_header->block_bytes, ts_data_fps->universal_header->body_CRC);
+				
+				// time series indices (the extrema were set by the worker)
+				tsi->file_offset = *file_offset;
+				*file_offset += (tsi->block_bytes = block_header->block_bytes);
+				tsi->start_time = block_header->start_time;
+				tsi->start_sample = start_sample;
+				start_sample += (tsi->number_of_samples = (si8) block_header->number_of_samples);
+				if (*max_samp < tsi->maximum_sample_value)
+					*max_samp = tsi->maximum_sample_value;
+				if (*min_samp > tsi->minimum_sample_value)
+					*min_samp = tsi->minimum_sample_value;
+				tsi->RED_block_flags = block_header->flags;
+				++tsi;
+				
+				// update metadata
+				if (tmd2->maximum_block_bytes < block_header->block_bytes)
+					tmd2->maximum_block_bytes = block_header->block_bytes;
+				if (tmd2->maximum_difference_bytes < block_header->difference_bytes)
+					tmd2->maximum_difference_bytes = block_header->difference_bytes;
+				
+			}
+		}
+		
+    }
+	
+	// release the workers
+	for (i = 0; workers != NULL && i < num_threads; i++) {
+		if (workers[i].rps != NULL) {
+			workers[i].rps->block_header = NULL;
+			workers[i].rps->compressed_data = NULL;
+			workers[i].rps->original_data = NULL;
+			workers[i].rps->original_ptr = NULL;
+			RED_free_processing_struct(workers[i].rps);
+		}
+		free (workers[i].buffer);
+	}
+	free (workers);
+	return success;
+	
+}
+
+/**
+ * 	Worker function that encodes a range of consecutive blocks into the buffer of the worker
+ *
+ *	Note: this function does not output any messages to matlab, and can therefore be called from other threads
+ *	      than the main (matlab) thread
+ *
+ * 	@param arg                  Pointer to the encode worker (ENCODE_WORKER) struct
+ */
+void encode_blocks_worker(void *arg) {
+	ENCODE_WORKER *worker = (ENCODE_WORKER *) arg;
+	RED_PROCESSING_STRUCT *rps = worker->rps;
+	ui8 i;
+	
+	for (i = 0; i < worker->num_blocks; i++) {
+		si8 block = worker->first_block + (si8) i;
+		si8 block_start = block * (si8) worker->samples_per_block;
+		ui4 block_samps = worker->samples_per_block;
+		if (worker->number_of_samples - block_start < (si8) block_samps)
+			block_samps = (ui4) (worker->number_of_samples - block_start);
+		
+		// start with a clean block header in the slot (as if each block is encoded in the same zeroed buffer)
+		rps->block_header = (RED_BLOCK_HEADER *) (rps->compressed_data = worker->buffer + i * worker->slot_bytes);
+		memset(rps->block_header, 0, RED_BLOCK_HEADER_BYTES);
+		rps->block_header->number_of_samples = block_samps;
+		rps->block_header->start_time = worker->start_time + block * worker->time_inc;
+		
+		// only the first block (of a new segment) is flagged as discontinuous
+		rps->directives.discontinuity = (block == 0 && worker->discontinuity) ? MEF_TRUE : MEF_FALSE;
+		
+		// filter - comment out if don't want
+		// filtps->data_length = block_samps;
+		// RED_filter(filtps);
+		
+		// compress
+		rps->original_data = rps->original_ptr = worker->data + block_start;
+		(void) RED_encode(rps);
+		RED_find_extrema(rps->original_ptr, block_samps, &worker->tsi[block]);
+		
+	}
+	
+}
@@ -17,6 +17,44 @@
  */
 #include "mex.h"
 #include "meflib/meflib/meflib.h"
+#include "matmef_threads.h"
+
+// 64-bit file positioning and truncation (for appending to large data files, and undoing a failed append)
+#ifdef _WIN32
+	#include <io.h>
+	#define FSEEK64		_fseeki64
+	#define FTELL64		_ftelli64
+#else
+	#include <unistd.h>
+	#define FSEEK64		fseeko
+	#define FTELL64		ftello
+#endif
+
+
+// Maximum size of the buffer that each worker encodes a batch of blocks into, and the maximum number of blocks in that batch
+#define WRITE_WORKER_BYTES	(8 * 1024 * 1024)
+#define WRITE_WORKER_BLOCKS	256
+
+
+// 
+// Structures
+//
+
+// A worker that encodes a range of consecutive blocks (the encoded blocks are written in order afterwards)
+typedef struct {
+	RED_PROCESSING_STRUCT	*rps;
+	ui1						*buffer;			// the buffer the blocks are encoded into (one slot of slot_bytes per block)
+	ui8						slot_bytes;
+	si4						*data;				// the samples to encode
+	si8						number_of_samples;	// the total number of samples to encode
+	ui4						samples_per_block;
+	si8						start_time;			// the start time of the first block
+	si8						time_inc;			// the time between the start of consecutive blocks
+	bool					discontinuity;		// whether the first block is flagged as discontinuous
+	TIME_SERIES_INDEX		*tsi;				// the time-series indices of the blocks (the extrema of the encoded blocks are stored here)
+	si8						first_block;		// the range of blocks to encode
+	ui8						num_blocks;
+} ENCODE_WORKER;
 
 
 // 
@@ -24,7 +62,13 @@
 //
 
 bool write_metadata(si1 *segment_path, si1 *password_l1, si1 *password_l2, si8 start_time, si8 end_time, si1 *anonymized_name, si4 channelType, mxArray *mat_tmd2, mxArray *mat_md3);
-bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, ui4 samples_per_block, const mxArray *data, bool lossy_flag);
+bool write_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, ui4 samples_per_block, const mxArray *data, bool lossy_flag, si4 num_threads);
+bool append_mef_ts_data_and_indices(si1 *segment_path, si1 *password_l1, si1 *password_l2, const mxArray *data, bool lossy_flag, si4 num_threads);
+bool restore_appended_file(FILE *fp, si8 length, ui1 *header);
+bool extract_ts_segment_name(si1 *segment_path, si1 *segment_name);
+bool write_ts_blocks(FILE_PROCESSING_STRUCT *ts_data_fps, TIME_SERIES_METADATA_SECTION_2 *tmd2, TIME_SERIES_INDEX *tsi, si4 *data, si8 num_samps, ui4 samples_per_block, 
+					 si8 start_time, si8 start_sample, bool discontinuity, PASSWORD_DATA *pwd, bool lossy_flag, si4 num_threads, si8 *file_offset, si4 *min_samp, si4 *max_samp);
+void encode_blocks_worker(void *arg);
 
 
 #endif   // MATMEF_WRITE_
\ No newline at end of file
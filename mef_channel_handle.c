@@ -0,0 +1,312 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Open a MEF3 time-series channel once and read (many) ranges of data from it through a handle
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <ctype.h>
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_read.h"
+#include "matmef_handles.h"
+#include "matmef_cache.h"
+
+
+// whether the cache of decoded blocks was set to its default size (on the first call of the mex module)
+static bool cache_configured = false;
+
+
+/**
+ * 	Release the opened channels and the cache of decoded blocks (when the mex module is cleared)
+ */
+static void release_mex_module() {
+	close_all_channel_handles();
+	set_block_cache_capacity(0);
+	cache_configured = false;
+}
+
+
+/**
+ * 	Retrieve the handle input argument (the second input argument)
+ *
+ * 	@param nrhs                 The number of input arguments
+ * 	@param prhs                 The input arguments
+ * 	@param command              The command (for the error message)
+ * 	@return                     The handle
+ */
+static ui8 get_handle_arg(int nrhs, const mxArray *prhs[], const char *command) {
+	si8 handle = 0;
+	
+	if (nrhs < 2)
+		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:noHandleArg", "'handle' input argument not set, the '%s' command requires a handle", command);
+	if (!getInputArgAsInt64(prhs[1], "handle", 1, 9007199254740992, &handle))
+		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidHandleArg", "'handle' input argument invalid");
+	
+	return (ui8) handle;
+}
+
+
+/**
+ * Main entry point for 'mef_channel_handle'
+ *
+ * @param command           The command to execute ['open', 'read', 'close', 'closeAll', 'cacheStats', 'cacheFlush' or 'cacheSize']
+ *
+ * 'open' command:
+ * @param channelPath       Path (absolute or relative) to the MEF3 channel folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @return                  The handle to the opened channel
+ *
+ * 'read' command:
+ * @param handle            The handle to an opened channel
+ * @param rangeType         Modality that is used to define the data-range to read [either 'time' or 'samples' (default)]
+ * @param rangeStart        Start-point for the reading of data. This can be either an (microsecond) epoch/unix timestamp or a (0-based) sample-index; -1 for beginning/first)
+ * @param rangeEnd          End-point at which to stop the of reading data. This can be either an (microsecond) epoch/unix timestamp or (0-based) sample-index; -1 for end/last)
+ * @param applyConvFactor   Whether to apply the unit conversion factor to the raw data. [0 = not apply (default), 1 = apply]
+ * @param numThreads        The number of threads used to decode the data [1 = single-threaded (default), 0 = one thread per processor]
+ * @param outputType        The data type of the output ['double' (default), 'single' or 'int32' (only for ranges in samples, without conversion factor)]
+ * @param validateCRC       Whether to validate the CRC of each block of data [1 = validate (default), 0 = trusted read, only the structure of the blocks is checked]
+ * @return                  A vector holding the channel data
+ *
+ * 'close' command:
+ * @param handle            The handle to an opened channel
+ *
+ * 'cacheStats' command:
+ * @return                  A struct with the hits, misses, entries, bytes and capacity of the cache of decoded blocks
+ *
+ * 'cacheFlush' command:    Remove all blocks from the cache of decoded blocks (and reset the hit and miss counters)
+ *
+ * 'cacheSize' command:
+ * @param bytes             The maximum size of the cache of decoded blocks, in bytes of decoded samples [0 = disable the cache]
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	
+	// make sure the opened channels and the cache are freed when the mex module is cleared
+	mexAtExit(release_mex_module);
+	
+	// enable the cache of decoded blocks (for reads through handles) on the first call
+	if (!cache_configured) {
+		set_block_cache_capacity(BLOCK_CACHE_DEFAULT_BYTES);
+		cache_configured = true;
+	}
+	
+	
+	//
+	// command
+	// 
+	
+	// check the command input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:noCommandArg", "'command' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidCommandArg", "'command' input argument invalid, should be a string (array of characters)");
+	char *mat_command = mxArrayToString(prhs[0]);
+	for(int i = 0; mat_command[i]; i++)	mat_command[i] = tolower(mat_command[i]);
+	si1 command[16];
+	MEF_strncpy(command, mat_command, 16);
+	mxFree(mat_command);
+	
+	
+	//
+	// open
+	//
+	
+	if (strcmp(command, "open") == 0) {
+		
+		// check the channel path input argument
+		if (nrhs < 2)				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:noChannelPathArg", "'channelPath' input argument not set");
+		if(!mxIsChar(prhs[1]))		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidChannelPathArg", "'channelPath' input argument invalid, should be a string (array of characters)");
+		if(mxIsEmpty(prhs[1]))		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidChannelPathArg", "'channelPath' input argument invalid, argument is empty");
+		
+		// set the channel path
+		si1 channel_path[MEF_FULL_FILE_NAME_BYTES];
+		char *mat_channel_path = mxArrayToString(prhs[1]);
+		MEF_strncpy(channel_path, mat_channel_path, MEF_FULL_FILE_NAME_BYTES);
+		mxFree(mat_channel_path);
+		
+		// check if a password input argument is given and is not empty
+		si1 password[PASSWORD_BYTES] = {0};
+		if (nrhs > 2 && !mxIsEmpty(prhs[2])) {
+			
+			// check the password input argument data type
+			if (!mxIsChar(prhs[2]))
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+			
+			// convert password (matlab char-array to UTF-8 character string)
+			if (!cpyMxStringToUtf8CharString(prhs[2], password, PASSWORD_BYTES))
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+			
+		}
+		
+		// open the channel
+		ui8 handle = open_channel_handle(channel_path, password);
+		if (handle == 0)
+			mexErrMsgTxt("Error while opening channel");
+		
+		// return the handle
+		if (nlhs > 0)
+			plhs[0] = mxCreateDoubleScalar((double) handle);
+		
+		
+	//
+	// read
+	//
+	
+	} else if (strcmp(command, "read") == 0) {
+		
+		// retrieve the channel
+		ui8 handle = get_handle_arg(nrhs, prhs, command);
+		BLOCK_LOOKUP *lookup = NULL;
+		READ_CONTEXT *context = NULL;
+		READAHEAD *readahead = NULL;
+		CHANNEL *channel = use_channel_handle(handle, &lookup, &context, &readahead);
+		if (channel == NULL)
+			mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidHandleArg", "'handle' input argument invalid, no opened channel with handle %llu (closed?)", handle);
+		
+		// range
+		bool range_type = RANGE_BY_SAMPLES;
+		si8 range_start = -1;
+		si8 range_end = -1;
+		
+		// check if a range-type input argument is given
+		if (nrhs > 2) {
+			
+			// check valid range type
+			if (!mxIsChar(prhs[2]))
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidRangeTypeArg", "'rangeType' input argument invalid, should be a string (array of characters)");
+			char *mat_range_type = mxArrayToString(prhs[2]);
+			for(int i = 0; mat_range_type[i]; i++)	mat_range_type[i] = tolower(mat_range_type[i]);
+			if (strcmp(mat_range_type, "time") != 0 && strcmp(mat_range_type, "samples") != 0)
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidRangeTypeArg", "'rangeType' input argument invalid, allowed values are 'time' or 'samples'");
+			
+			// set the range type
+			if (strcmp(mat_range_type, "time") == 0)
+				range_type = RANGE_BY_TIME;
+			mxFree(mat_range_type);
+			
+			// check and retrieve a range-start input
+			if (nrhs > 3)
+				if (!getInputArgAsInt64(prhs[3], "rangeStart", -1, LLONG_MAX, &range_start))	return;
+			
+			// check and retrieve a range-end input
+			if (nrhs > 4)
+				if (!getInputArgAsInt64(prhs[4], "rangeEnd", -1, LLONG_MAX, &range_end))	return;
+			
+		}
+		
+		// conversion factor
+		bool apply_conv_factor = false;
+		if (nrhs > 5) {
+			if (!getInputArgAsBool(prhs[5], "applyConvFactor", &apply_conv_factor))	return;
+		}
+		
+		// number of threads
+		si8 num_threads = 1;
+		if (nrhs > 6) {
+			if (!getInputArgAsInt64(prhs[6], "numThreads", 0, 1024, &num_threads))	return;
+		}
+		
+		// output type
+		si4 output_type = OUTPUT_DOUBLE;
+		if (nrhs > 7) {
+			
+			// check valid output type
+			if (!mxIsChar(prhs[7]))
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidOutputTypeArg", "'outputType' input argument invalid, should be a string (array of characters)");
+			char *mat_output_type = mxArrayToString(prhs[7]);
+			for(int i = 0; mat_output_type[i]; i++)	mat_output_type[i] = tolower(mat_output_type[i]);
+			if (strcmp(mat_output_type, "double") != 0 && strcmp(mat_output_type, "single") != 0 && strcmp(mat_output_type, "int32") != 0)
+				mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidOutputTypeArg", "'outputType' input argument invalid, allowed values are 'double', 'single' or 'int32'");
+			
+			// set the output type
+			if (strcmp(mat_output_type, "single") == 0)
+				output_type = OUTPUT_SINGLE;
+			else if (strcmp(mat_output_type, "int32") == 0)
+				output_type = OUTPUT_INT32;
+			mxFree(mat_output_type);
+			
+		}
+		
+		// CRC validation
+		bool validate_crc = true;
+		if (nrhs > 8) {
+			if (!getInputArgAsBool(prhs[8], "validateCRC", &validate_crc))	return;
+		}
+		
+		// read the data
+		mxArray *data = read_channel_data_from_object(channel, lookup, context, readahead, range_type, range_start, range_end, apply_conv_factor, (si4) num_threads, output_type, validate_crc);
+		if (data == NULL)	
+			mexErrMsgTxt("Error while reading channel data");
+		
+		// set the data as output, if output is expected
+		if (nlhs > 0)
+			plhs[0] = data;
+		else
+			mxDestroyArray(data);
+		
+		
+	//
+	// close
+	//
+	
+	} else if (strcmp(command, "close") == 0) {
+		
+		ui8 handle = get_handle_arg(nrhs, prhs, command);
+		if (!close_channel_handle(handle))
+			mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidHandleArg", "'handle' input argument invalid, no opened channel with handle %llu (closed?)", handle);
+		
+	} else if (strcmp(command, "closeall") == 0) {
+		
+		close_all_channel_handles();
+		
+		
+	//
+	// cache
+	//
+	
+	} else if (strcmp(command, "cachestats") == 0) {
+		
+		// retrieve the counters (a disabled cache has no entries)
+		BLOCK_CACHE *cache = get_block_cache();
+		const char *field_names[] = {"hits", "misses", "entries", "bytes", "capacity"};
+		mxArray *stats = mxCreateStructMatrix(1, 1, 5, field_names);
+		mxSetField(stats, 0, "hits", mxCreateDoubleScalar((cache == NULL) ? 0 : (double) cache->hits));
+		mxSetField(stats, 0, "misses", mxCreateDoubleScalar((cache == NULL) ? 0 : (double) cache->misses));
+		mxSetField(stats, 0, "entries", mxCreateDoubleScalar((cache == NULL) ? 0 : (double) cache->num_entries));
+		mxSetField(stats, 0, "bytes", mxCreateDoubleScalar((cache == NULL) ? 0 : (double) cache->bytes));
+		mxSetField(stats, 0, "capacity", mxCreateDoubleScalar((cache == NULL) ? 0 : (double) cache->capacity));
+		
+		// return the counters
+		if (nlhs > 0)
+			plhs[0] = stats;
+		else
+			mxDestroyArray(stats);
+		
+	} else if (strcmp(command, "cacheflush") == 0) {
+		
+		flush_block_cache();
+		
+	} else if (strcmp(command, "cachesize") == 0) {
+		
+		// check and retrieve the size input argument
+		si8 bytes = 0;
+		if (nrhs < 2)
+			mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:noBytesArg", "'bytes' input argument not set, the 'cacheSize' command requires a size (in bytes)");
+		if (!getInputArgAsInt64(prhs[1], "bytes", 0, LLONG_MAX, &bytes))	return;
+		
+		// set the size (0 = disable)
+		set_block_cache_capacity((ui8) bytes);
+		
+	} else {
+		mexErrMsgIdAndTxt("MATLAB:mef_channel_handle:invalidCommandArg", "'command' input argument invalid, allowed values are 'open', 'read', 'close', 'closeAll', 'cacheStats', 'cacheFlush' or 'cacheSize'");
+	}
+	
+	// succesfull return from call
+	return;
+	
+}
@@ -0,0 +1,74 @@
+%
+%   Open a MEF3 time-series channel once and read (many) ranges of data from it through a handle
+%
+%   handle = mef_channel_handle('open', channelPath, password)
+%   [data] = mef_channel_handle('read', handle, rangeType, rangeStart, rangeEnd, applyConvFactor, numThreads, outputType, validateCRC)
+%            mef_channel_handle('close', handle)
+%            mef_channel_handle('closeAll')
+%   [stats]= mef_channel_handle('cacheStats')
+%            mef_channel_handle('cacheFlush')
+%            mef_channel_handle('cacheSize', bytes)
+%
+%       channelPath     = path (absolute or relative) to the MEF3 channel directory
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       handle          = the handle to an opened channel, as returned by the 'open' command
+%       rangeType       = Modality that is used to define the data-range to read, can be either 'time' or 'samples'.
+%                         Default is 'samples'.
+%       rangeStart      = Start-point for the reading of data. Can either be an (microsecond) epoch/unix
+%                         timestamp or a (0-based) sample-index. Pass -1 to start at the beginning or first 
+%                         sample of the timeseries. The default is -1, beginning/first
+%       rangeEnd        = End-point to stop the of reading data. Either as an (microsecond) epoch/unix 
+%                         timestamp or (0-based) sample-index. Pass -1 as value to end at the end or last 
+%                         sample of the timeseries. The default is -1, end/last
+%       applyConvFactor = Apply the unit conversion factor to the raw data [0 = not apply, 1 = apply]
+%                         Default = 0 - Do not apply conversion factor
+%       numThreads      = The number of threads used to decode the data [1 = single-threaded, 0 = one thread per processor]
+%                         Default = 1 - Single-threaded
+%       outputType      = The data type of the output, can be 'double', 'single' or 'int32'. The 'single' output uses half
+%                         the memory of 'double'. The 'int32' output holds the raw (integer) samples and is decoded directly
+%                         into the output array, which saves memory and time; 'int32' is only available when the rangeType 
+%                         is 'samples' and the conversion factor is not applied. Default is 'double'.
+%       validateCRC     = Whether to validate the CRC of each block of data [0 = trusted read, 1 = validate]. A trusted read
+%                         only checks the structure of the blocks (e.g. their sizes), which is faster but will not detect corrupt
+%                         data; only use it on data that have been validated before. Default = 1 - Validate the CRCs
+%       bytes           = The maximum size of the cache of decoded blocks, in bytes of decoded samples (0 = disable the cache)
+%
+%   Returns:
+%       handle          = The handle to the opened channel
+%       data            = A vector of doubles (or singles/int32) holding the channel data
+%       stats           = A struct with the number of hits and misses, and the number of entries, bytes and capacity
+%                         (in bytes) of the cache of decoded blocks
+%
+%   Notes:
+%       - Opening a channel parses the metadata and indices of all the segments of a channel once and keeps the data
+%         files open. Subsequent reads through the handle only seek to and decode the blocks of data that are requested,
+%         which is considerably faster than 'read_mef_ts_data' when reading many (small) ranges from the same channel.
+%       - Opened channels stay in memory until they are closed (or until the mex file is cleared, e.g. by 'clear mex')
+%       - Blocks that are decoded by reads through a handle are kept in a (least recently used) cache, so that reading
+%         (overlapping) ranges again does not have to check and decode the same blocks again. The cache holds 256MB of
+%         decoded samples by default and is kept across calls and channels until it is flushed with 'cacheFlush' (or
+%         the mex file is cleared). A read of a range that is larger than half of the cache bypasses the cache (and
+%         is not counted as a miss). Only reads through a handle use the cache; 'read_mef_ts_data',
+%         'read_mef_ts_session_data' and the other readers always decode the blocks they read.
+%       - When reads through a handle continue where the previous read ended (e.g. walking a channel in consecutive
+%         windows), the data that follows each read is read ahead in the background, so that the next read does not
+%         have to wait for its data to be read (which mostly helps on storage with a high latency, e.g. network drives)
+%       - See 'read_mef_ts_data' for more information on the ranges
+%
+%   Example:
+%       handle = mef_channel_handle('open', './mefSessDir.mefd/Ch01.timd');
+%       for iEpoch = 1:size(epochs, 1)
+%           data = mef_channel_handle('read', handle, 'samples', int64(epochs(iEpoch, 1)), int64(epochs(iEpoch, 2)));
+%       end
+%       mef_channel_handle('close', handle);
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function varargout = mef_channel_handle(command, varargin)
@@ -277,40 +277,81 @@ function [metadata, data] = readMef3(sessPath, password, channels, rangeType, va
         % catch errors
         try
             
-            % loop through the channels in the order they are requested
+            % retrieve the names of the channels (as they are on disk) in the order they are requested
+            channelNames = cell(1, length(channels));
             for iChannel = 1:length(channels)
                 channelIndex = find(ismember(lower({metadata.time_series_channels.name}), lower(channels{iChannel})));
-                channelPath = [metadata.time_series_channels(channelIndex).path, filesep, metadata.time_series_channels(channelIndex).name, '.', metadata.time_series_channels(channelIndex).extension];
+                channelNames{iChannel} = metadata.time_series_channels(channelIndex).name;
+            end
+            sessionPath = metadata.time_series_channels(1).path;
+            
+            % check which (compiled) mex functions are available
+            % note: the pre-compiled mex files do not include the session functions, fall back to
+            %       reading per range or per channel when these are not compiled (see README)
+            if exist('read_mef_ts_session_epochs', 'file') == 3
+                
+                % read the signals of all channels for all ranges at once (<channels> x <samples> x <ranges>)
+                % note: the ranges are merged where they overlap, so that data that is shared by ranges is only read and decoded
+                %       once. Ranges that are shorter than the longest range are padded with nans at the end.
+                data = read_mef_ts_session_epochs(sessionPath, password, channelNames, rangeType, int64(ranges), true);
+                
+            elseif exist('read_mef_ts_session_data', 'file') == 3
                 
-                %
-                % read the data of each channel
-                %
-
                 % loop through the ranges
                 for iRange = 1:size(ranges, 1)
-
-                    % read the signal
-                    signal = read_mef_ts_data(channelPath, password, rangeType, int64(ranges(iRange, 1)), int64(ranges(iRange, 2)), true)';
-
+                    
+                    % read the signals of all channels at once (<channels> x <samples>)
+                    signals = read_mef_ts_session_data(sessionPath, password, channelNames, rangeType, int64(ranges(iRange, 1)), int64(ranges(iRange, 2)), true);
+                    
                     % on the first read, initialize the array
                     % note: we cannot beforehand determine the size of matrix because of potential
                     %       recording gaps in the data. Therefore, we allocate memory here.
-                    if iChannel == 1 && iRange == 1
-                        data = nan(length(channels), length(signal), size(ranges, 1));
+                    if iRange == 1
+                        data = nan(length(channels), size(signals, 2), size(ranges, 1));
                     end
-
+                    
                     % if signal too large for the data matrix, pad data matrix with nans
-                    if length(signal) > size(data, 2)
-                       data = padarray(data, [0, (length(signal) - size(data, 2))], nan, 'post');
+                    if size(signals, 2) > size(data, 2)
+                       data = padarray(data, [0, (size(signals, 2) - size(data, 2))], nan, 'post');
                     end
-
+                    
                     % store the data 
-                    data(iChannel, 1:length(signal), iRange) = signal;
-
+                    data(:, 1:size(signals, 2), iRange) = signals;
+                    
+                end
+                
+            else
+                
+                % loop through the channels in the order they are requested
+                for iChannel = 1:length(channels)
+                    channelIndex = find(ismember(lower({metadata.time_series_channels.name}), lower(channels{iChannel})));
+                    channelPath = [metadata.time_series_channels(channelIndex).path, filesep, metadata.time_series_channels(channelIndex).name, '.', metadata.time_series_channels(channelIndex).extension];
+                    
+                    % loop through the ranges
+                    for iRange = 1:size(ranges, 1)
+                        
+                        % read the signal
+                        signal = read_mef_ts_data(channelPath, password, rangeType, int64(ranges(iRange, 1)), int64(ranges(iRange, 2)), true)';
+                        
+                        % on the first read, initialize the array
+                        if iChannel == 1 && iRange == 1
+                            data = nan(length(channels), length(signal), size(ranges, 1));
+                        end
+                        
+                        % if signal too large for the data matrix, pad data matrix with nans
+                        if length(signal) > size(data, 2)
+                           data = padarray(data, [0, (length(signal) - size(data, 2))], nan, 'post');
+                        end
+                        
+                        % store the data 
+                        data(iChannel, 1:length(signal), iRange) = signal;
+                        
+                    end
+                    
                 end
                 
             end
-
+            
         catch e
             
             % error message
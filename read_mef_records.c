@@ -0,0 +1,144 @@
+/**
+ * 	@file
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Query the records (annotations) of a session, channel or segment by type and time, into columns
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "mex_utils.h"
+#include "matmef_dataconverter.h"
+#include "matmef_records.h"
+
+#include "meflib/meflib/meflib.c"
+#include "meflib/meflib/mefrec.c"
+
+
+/**
+ * Main entry point for 'read_mef_records'
+ *
+ * @param levelPath         Path (absolute or relative) to the MEF3 session, channel or segment folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @param types             A cell array with the types of the records to read (e.g. {'Note', 'Seiz'}), or a string for a single type; empty for all types (default)
+ * @param rangeStart        Start of the time range as an (microsecond) epoch/unix timestamp; -1 for the first record (default)
+ * @param rangeEnd          End of the time range as an (microsecond) epoch/unix timestamp (not included); -1 for up to and including the last record (default)
+ * @return                  A struct with the columns of the records (fields: time, type, version_major, version_minor and a struct of body columns per record type)
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	si4		i;
+
+
+	//
+	// level path
+	//
+
+	// check the level path input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:read_mef_records:noLevelPathArg", "'levelPath' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidLevelPathArg", "'levelPath' input argument invalid, should be a string (array of characters)");
+	if(mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidLevelPathArg", "'levelPath' input argument invalid, argument is empty");
+
+	// set the level path
+	si1 level_path[MEF_FULL_FILE_NAME_BYTES];
+	char *mat_level_path = mxArrayToString(prhs[0]);
+	MEF_strncpy(level_path, mat_level_path, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_level_path);
+
+	// remove a trailing path separator
+	size_t path_len = strlen(level_path);
+	if (path_len > 1 && (level_path[path_len - 1] == '/' || level_path[path_len - 1] == '\\'))
+		level_path[path_len - 1] = '\0';
+
+	// check if the level directory exists
+	if (!dirExists(level_path))
+		mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidLevelPathArg", "'levelPath' input argument invalid, the directory does not exist");
+
+
+	//
+	// password (optional)
+	//
+
+	si1 password[PASSWORD_BYTES] = {0};
+
+	// check if a password input argument is given and is not empty
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+
+		// check the password input argument data type
+		if (!mxIsChar(prhs[1]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+
+		// convert password (matlab char-array to UTF-8 character string)
+		if (!cpyMxStringToUtf8CharString(prhs[1], password, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+
+	}
+
+
+	//
+	// types (optional)
+	//
+
+	ui4 *type_codes = NULL;
+	si4 num_type_codes = 0;
+	if (nrhs > 2 && !mxIsEmpty(prhs[2])) {
+		if (!mxIsCell(prhs[2]) && !mxIsChar(prhs[2]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidTypesArg", "'types' input argument invalid, should be a cell array containing record types (e.g. {'Note', 'Seiz'})");
+
+		// retrieve the type codes (the four characters of a type, as a little endian ui4; see MEFREC_*_TYPE_CODE)
+		num_type_codes = mxIsChar(prhs[2]) ? 1 : (si4) mxGetNumberOfElements(prhs[2]);
+		type_codes = (ui4 *) mxCalloc((size_t) num_type_codes, sizeof(ui4));
+		for (i = 0; i < num_type_codes; i++) {
+			const mxArray *mat_type = mxIsChar(prhs[2]) ? prhs[2] : mxGetCell(prhs[2], i);
+			if (mat_type == NULL || !mxIsChar(mat_type) || mxGetNumberOfElements(mat_type) != TYPE_BYTES - 1)
+				mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidTypesArg", "'types' input argument invalid, each record type should be a string of 4 characters (e.g. 'Note')");
+
+			char *type_string = mxArrayToString(mat_type);
+			memcpy(&type_codes[i], type_string, TYPE_BYTES - 1);
+			mxFree(type_string);
+		}
+	}
+
+
+	//
+	// range (in time)
+	//
+
+	si8 range_start = -1;
+	si8 range_end = -1;
+	if (nrhs > 3)
+		if (!getInputArgAsInt64(prhs[3], "rangeStart", -1, LLONG_MAX, &range_start))	return;
+	if (nrhs > 4)
+		if (!getInputArgAsInt64(prhs[4], "rangeEnd", -1, LLONG_MAX, &range_end))	return;
+	if (range_start >= 0 && range_end >= 0 && range_end <= range_start)
+		mexErrMsgIdAndTxt("MATLAB:read_mef_records:invalidRangeArg", "The end of the range should be after the start of the range");
+
+
+	//
+	// query the records
+	//
+	mxArray *records = query_records_from_path(level_path, password, type_codes, num_type_codes, range_start, range_end);
+
+	// free the type codes
+	if (type_codes != NULL)
+		mxFree(type_codes);
+
+	// check for errors
+	if (records == NULL)
+		mexErrMsgTxt("Error while reading records");
+
+	// set the records as output, if output is expected
+	if (nlhs > 0)
+		plhs[0] = records;
+	else
+		mxDestroyArray(records);
+
+	// succesfull return from call
+	return;
+
+}
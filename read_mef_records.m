@@ -0,0 +1,45 @@
+%
+%   Read the records (annotations) of a session, channel or segment, selected by type and time, as columns
+%
+%   [records] = read_mef_records(levelPath, password, types, rangeStart, rangeEnd)
+%
+%       levelPath       = path (absolute or relative) to the MEF3 session (.mefd), channel (.timd/.vidd) or segment (.segd) directory
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       types           = a cell array with the types of the records to read (e.g. {'Note', 'Seiz'}), or a string
+%                         for a single type. Pass an empty value to read records of all types. Default is {}, all types
+%       rangeStart      = Start of the time range as an (microsecond) epoch/unix timestamp. Pass -1 to start at the
+%                         first record. The default is -1, first
+%       rangeEnd        = End of the time range as an (microsecond) epoch/unix timestamp; records at this time are not
+%                         included. Pass -1 to include up to the last record. The default is -1, last
+%
+%   Returns:
+%       records         = A struct with a column (a value per record) for each of the fields:
+%                            time           - the time of each record as an int64 epoch/unix timestamp
+%                            type           - the type of each record, as a <records> x 4 char matrix (cellstr(records.type) for a cell array)
+%                            version_major  - the major version of each record
+%                            version_minor  - the minor version of each record
+%                         And a struct for each record type with a body (Note, EDFA, LNTP, Seiz, SyLg, CSti, ESti, Curs
+%                         and Epoc), that holds a column for each field of the body (e.g. records.Seiz.earliest_onset
+%                         as an int64 vector, text as a cell array) and an 'index' column with the rows of these records
+%                         in the columns above (e.g. records.time(records.Seiz.index) are the times of the Seiz records)
+%
+%   Notes:
+%       - The records are selected using the record indices (.ridx), after which only the selected records are read
+%         from the record data (.rdat). This is considerably faster and uses less memory than mapping all the records
+%         of a level with read_mef_session_metadata when only a part of the records is needed.
+%       - Only the records of the given level are read, not those of the levels below it (e.g. a session query does not
+%         return the records of its channels).
+%       - The bodies of records with an unrecognized version, that are smaller than the body of their type, or that are
+%         encrypted and the password does not give access to, are skipped; these records are still included in the time,
+%         type and version columns.
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function records = read_mef_records(levelPath, password, types, rangeStart, rangeEnd)
@@ -26,7 +26,7 @@
  *
  * @param sessionPath	Path (absolute or relative) to the MEF3 session folder
  * @param password		Password to the MEF3 data; Pass empty string/variable if not encrypted
- * @param readIndices	Whether to read and map time-series and video indices [0 or 1; default is 0]
+ * @param readIndices	Whether to read and map time-series and video indices [0 = no (default), 1 = as struct arrays, 2 = compact, as a struct of column vectors]
  * @param readRecords	Whether to read the records [0 or 1; default is 1]
  * @return				Structure containing session metadata, channels metadata, segments metadata and records
  */
@@ -92,8 +92,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 			
 			// retrieve the map indices flag value
 			double mat_read_indices_flag = mxGetScalar(prhs[2]);
-			if (mat_read_indices_flag != 0 && mat_read_indices_flag != 1)
-				mexErrMsgIdAndTxt("MATLAB:read_mef_session_metadata:invalidReadIndicesArg", "'readIndices' input argument invalid, allowed values are 0, false, 1 or true");
+			if (mat_read_indices_flag != MAP_INDICES_NONE && mat_read_indices_flag != MAP_INDICES_STRUCTS && mat_read_indices_flag != MAP_INDICES_COMPACT)
+				mexErrMsgIdAndTxt("MATLAB:read_mef_session_metadata:invalidReadIndicesArg", "'readIndices' input argument invalid, allowed values are 0, false, 1, true or 2 (compact)");
 			
 			// set the flag
 			read_indices_flag = mat_read_indices_flag;
@@ -5,8 +5,14 @@
 %
 %       sessionPath  = path (absolute or relative) to the MEF3 session folder
 %       password     = password to the MEF3 data; Pass empty string/variable if not encrypted
-%       readIndices  = whether to read and map time-series and video indices [0 or 1; default is 0]
-%       readRecords  = whether to read the records [0 or 1; default is 1]
+%       readIndices  = whether to read and map time-series and video indices [0, 1 or 2; default is 0]
+%                      0 = do not read the indices
+%                      1 = map the indices of each segment to a struct array, with an element per index entry
+%                      2 = compact, map the indices of each segment to a single struct of which each field is a
+%                          (typed) column vector that holds the values of all entries (e.g. 'start_time' as an
+%                          int64 vector); This is considerably faster and uses less memory for larger segments
+%       readRecords  = whether to read the records [0 or 1; default is 1]; To read only the records of
+%                      certain types or within a time range (as columns), use read_mef_records instead
 %
 %   Returns: 
 %       metadata     = structure containing session metadata, channels metadata, segments metadata and records
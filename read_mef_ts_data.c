@@ -28,7 +28,10 @@
  * @param rangeStart        Start-point for the reading of data. This can be either an (microsecond) epoch/unix timestamp or a (0-based) sample-index; -1 for beginning/first)
  * @param rangeEnd          End-point at which to stop the of reading data. This can be either an (microsecond) epoch/unix timestamp or (0-based) sample-index; -1 for end/last)
  * @param applyConvFactor   Whether to apply the unit conversion factor to the raw data. [0 = not apply (default), 1 = apply]
- * @return                  A vector of doubles holding the channel data
+ * @param numThreads        The number of threads used to decode the data [1 = single-threaded (default), 0 = one thread per processor]
+ * @param outputType        The data type of the output ['double' (default), 'single' or 'int32' (only for ranges in samples, without conversion factor)]
+ * @param validateCRC       Whether to validate the CRC of each block of data [1 = validate (default), 0 = trusted read, only the structure of the blocks is checked]
+ * @return                  A vector holding the channel data
  */
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 
@@ -114,10 +117,55 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
     }
     
 	
+    //
+    // Number of threads
+    //
+    
+	si8 num_threads = 1;
+	if (nrhs > 6) {
+		if (!getInputArgAsInt64(prhs[6], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
+	
+    //
+    // Output type
+    //
+    
+	si4 output_type = OUTPUT_DOUBLE;
+	if (nrhs > 7) {
+		
+		// check valid output type
+		if (!mxIsChar(prhs[7]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_data:invalidOutputTypeArg", "'outputType' input argument invalid, should be a string (array of characters)");
+		char *mat_output_type = mxArrayToString(prhs[7]);
+		for(int i = 0; mat_output_type[i]; i++)	mat_output_type[i] = tolower(mat_output_type[i]);
+		if (strcmp(mat_output_type, "double") != 0 && strcmp(mat_output_type, "single") != 0 && strcmp(mat_output_type, "int32") != 0)
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_data:invalidOutputTypeArg", "'outputType' input argument invalid, allowed values are 'double', 'single' or 'int32'");
+		
+		// set the output type
+		if (strcmp(mat_output_type, "single") == 0)
+			output_type = OUTPUT_SINGLE;
+		else if (strcmp(mat_output_type, "int32") == 0)
+			output_type = OUTPUT_INT32;
+		mxFree(mat_output_type);
+		
+	}
+	
+	
+    //
+    // CRC validation
+    //
+    
+	bool validate_crc = true;
+	if (nrhs > 8) {
+		if (!getInputArgAsBool(prhs[8], "validateCRC", &validate_crc))	return;
+	}
+	
+	
 	// 
 	// read the data
 	// 
-	mxArray *data = read_channel_data_from_path(channel_path, password, range_type, range_start, range_end, apply_conv_factor);
+	mxArray *data = read_channel_data_from_path(channel_path, password, range_type, range_start, range_end, apply_conv_factor, (si4) num_threads, output_type, validate_crc);
 	if (data == NULL)	
 		mexErrMsgTxt("Error while reading channel data");
     
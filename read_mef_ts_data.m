@@ -1,7 +1,7 @@
 %
 %   Read the MEF3 data from a time-series channel
 %
-%   [data] = read_mef_ts_data(channelPath, password, rangeType, rangeStart, rangeEnd, applyConvFactor)
+%   [data] = read_mef_ts_data(channelPath, password, rangeType, rangeStart, rangeEnd, applyConvFactor, numThreads, outputType, validateCRC)
 %
 %       channelPath     = path (absolute or relative) to the MEF3 channel directory
 %       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
@@ -15,9 +15,18 @@
 %                         sample of the timeseries. The default is -1, end/last
 %       applyConvFactor = Apply the unit conversion factor to the raw data [0 = not apply, 1 = apply]
 %                         Default = 0 - Do not apply conversion factor
+%       numThreads      = The number of threads used to decode the data [1 = single-threaded, 0 = one thread per processor]
+%                         Default = 1 - Single-threaded
+%       outputType      = The data type of the output, can be 'double', 'single' or 'int32'. The 'single' output uses half
+%                         the memory of 'double'. The 'int32' output holds the raw (integer) samples and is decoded directly
+%                         into the output array, which saves memory and time; 'int32' is only available when the rangeType 
+%                         is 'samples' and the conversion factor is not applied. Default is 'double'.
+%       validateCRC     = Whether to validate the CRC of each block of data [0 = trusted read, 1 = validate]. A trusted read
+%                         only checks the structure of the blocks (e.g. their sizes), which is faster but will not detect corrupt
+%                         data; only use it on data that have been validated before. Default = 1 - Validate the CRCs
 %
 %   Returns:
-%       data            = A vector of doubles holding the channel data
+%       data            = A vector of doubles (or singles/int32) holding the channel data
 %
 %   Notes:
 %       - When the rangeType is set to 'samples', the function simply returns the samples as they are
@@ -38,4 +47,4 @@
 %   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 %   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
 %
-function data = read_mef_ts_data(channelPath, password, rangeType, rangeStart, rangeEnd)
+function data = read_mef_ts_data(channelPath, password, rangeType, rangeStart, rangeEnd, applyConvFactor, numThreads, outputType, validateCRC)
@@ -0,0 +1,150 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Read the min/max envelopes of multiple time-series channels in a session (from the time-series indices only)
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_envelope.h"
+
+
+/**
+ * Main entry point for 'read_mef_ts_envelope'
+ *
+ * @param sessionPath       Path (absolute or relative) to the MEF3 session folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @param channels          A cell array with the names of the time-series channels (or a string for a single channel)
+ * @param rangeStart        Start of the time range as an (microsecond) epoch/unix timestamp; -1 for the start of the first block
+ * @param rangeEnd          End of the time range as an (microsecond) epoch/unix timestamp; -1 for the end of the last block
+ * @param numBins           The number of bins to merge the block envelopes into (e.g. the number of pixels to draw); 0 = an envelope per block (default)
+ * @param applyConvFactor   Whether to apply the unit conversion factor to the minimum and maximum values. [0 = not apply (default), 1 = apply]
+ * @return                  A struct array with the envelope of each channel (fields: name, time, numSamples, min and max)
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	si4		i;
+	
+	
+	//
+	// session path
+	// 
+	
+	// check the session path input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:noSessionPathArg", "'sessionPath' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidSessionPathArg", "'sessionPath' input argument invalid, should be a string (array of characters)");
+	if(mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidSessionPathArg", "'sessionPath' input argument invalid, argument is empty");
+	
+	// set the session path
+	si1 session_path[MEF_FULL_FILE_NAME_BYTES];
+	char *mat_session_path = mxArrayToString(prhs[0]);
+	MEF_strncpy(session_path, mat_session_path, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_session_path);
+	
+	// remove a trailing path separator
+	size_t path_len = strlen(session_path);
+	if (path_len > 1 && (session_path[path_len - 1] == '/' || session_path[path_len - 1] == '\\'))
+		session_path[path_len - 1] = '\0';
+	
+
+	// 
+	// password (optional)
+	// 
+	
+	si1 password[PASSWORD_BYTES] = {0};
+	
+	// check if a password input argument is given and is not empty
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+	
+		// check the password input argument data type
+		if (!mxIsChar(prhs[1]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+
+		// convert password (matlab char-array to UTF-8 character string)
+		if (!cpyMxStringToUtf8CharString(prhs[1], password, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+
+	}
+	
+	
+	//
+	// channels
+	//
+	
+	// check the channels input argument
+    if (nrhs < 3)										mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:noChannelsArg", "'channels' input argument not set");
+	if (!mxIsCell(prhs[2]) && !mxIsChar(prhs[2]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidChannelsArg", "'channels' input argument invalid, should be a cell array containing channel names (e.g. {'Ch1', 'Ch2', 'Ch3'})");
+	if (mxIsEmpty(prhs[2]))								mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidChannelsArg", "'channels' input argument invalid, argument is empty");
+	
+	// retrieve the channel names
+	si4 num_channels = mxIsChar(prhs[2]) ? 1 : (si4) mxGetNumberOfElements(prhs[2]);
+	si1 **channel_names = (si1 **) mxCalloc((size_t) num_channels, sizeof(si1 *));
+	for (i = 0; i < num_channels; i++) {
+		const mxArray *mat_channel_name = mxIsChar(prhs[2]) ? prhs[2] : mxGetCell(prhs[2], i);
+		if (mat_channel_name == NULL || !mxIsChar(mat_channel_name) || mxIsEmpty(mat_channel_name))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_envelope:invalidChannelsArg", "'channels' input argument invalid, should be a cell array containing channel names (e.g. {'Ch1', 'Ch2', 'Ch3'})");
+		channel_names[i] = mxArrayToString(mat_channel_name);
+	}
+	
+	
+	//
+	// range (in time)
+	//
+	
+	si8 range_start = -1;
+	si8 range_end = -1;
+	if (nrhs > 3)
+		if (!getInputArgAsInt64(prhs[3], "rangeStart", -1, LLONG_MAX, &range_start))	return;
+	if (nrhs > 4)
+		if (!getInputArgAsInt64(prhs[4], "rangeEnd", -1, LLONG_MAX, &range_end))	return;
+	
+	
+    //
+    // Number of bins
+    //
+    
+	si8 num_bins = 0;
+	if (nrhs > 5) {
+		if (!getInputArgAsInt64(prhs[5], "numBins", 0, INT_MAX, &num_bins))	return;
+	}
+	
+    
+    //
+    // Conversion factor
+    //
+    
+    bool apply_conv_factor = false;
+	if (nrhs > 6) {
+		if (!getInputArgAsBool(prhs[6], "applyConvFactor", &apply_conv_factor))	return;
+    }
+	
+	
+	// 
+	// read the envelopes
+	// 
+	mxArray *envelopes = read_session_channels_envelope(session_path, channel_names, num_channels, password, range_start, range_end, (si4) num_bins, apply_conv_factor);
+	
+	// free the channel names
+	for (i = 0; i < num_channels; i++)
+		mxFree(channel_names[i]);
+	mxFree(channel_names);
+	
+	// check for errors
+	if (envelopes == NULL)	
+		mexErrMsgTxt("Error while reading channel envelopes");
+    
+	// set the envelopes as output, if output is expected
+	if (nlhs > 0)
+		plhs[0] = envelopes;
+	
+	// succesfull return from call
+	return;
+	
+}
@@ -0,0 +1,45 @@
+%
+%   Read the min/max envelopes of multiple time-series channels in a session
+%
+%   [envelopes] = read_mef_ts_envelope(sessionPath, password, channels, rangeStart, rangeEnd, numBins, applyConvFactor)
+%
+%       sessionPath     = path (absolute or relative) to the MEF3 session directory
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       channels        = a cell array with the names of the time-series channels (e.g. {'Ch1', 'Ch2', 'Ch3'}). 
+%                         The order of channels in this input argument will determine the order of the output struct array.
+%       rangeStart      = Start of the time range as an (microsecond) epoch/unix timestamp. Pass -1 to start at the
+%                         first block of the channels. The default is -1, beginning/first
+%       rangeEnd        = End of the time range as an (microsecond) epoch/unix timestamp. Pass -1 to end at the end
+%                         of the last block of the channels. The default is -1, end/last
+%       numBins         = The number of (equally sized) bins over the range to merge the envelopes of the blocks into,
+%                         e.g. the number of pixels in the width of a plot. Pass 0 to return an envelope for each block.
+%                         Default = 0 - An envelope per block
+%       applyConvFactor = Apply the unit conversion factor to the minimum and maximum values [0 = not apply, 1 = apply]
+%                         Default = 0 - Do not apply conversion factor
+%
+%   Returns:
+%       envelopes       = A struct array with the envelope of each channel, holding the fields:
+%                            name        - the name of the channel
+%                            time        - the start time of each block (or bin) as an int64 epoch/unix timestamp
+%                            numSamples  - the number of samples in each block (or bin)
+%                            min         - the minimum sample value in each block (or bin)
+%                            max         - the maximum sample value in each block (or bin)
+%
+%   Notes:
+%       - The envelopes are built only from the time-series indices of the channels (which store the minimum and maximum
+%         value of each block), no data is read or decoded. This makes it possible to quickly draw an overview of a whole recording.
+%       - The envelope of a block covers all samples of the block. As a result, the first and last block (or bin) may
+%         include values from just outside of the requested range.
+%       - A block that spans multiple bins contributes its minimum and maximum to each of these bins, while its samples
+%         are divided over the bins. Bins that do not overlap with any block (e.g. a gap in the data) are set to NaN.
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function envelopes = read_mef_ts_envelope(sessionPath, password, channels, rangeStart, rangeEnd, numBins, applyConvFactor)
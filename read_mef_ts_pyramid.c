@@ -0,0 +1,137 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Read a decimated (mean, minimum and maximum) version of the data from a time-series channel, served from its pyramid sidecars
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_read.h"
+
+
+/**
+ * Main entry point for 'read_mef_ts_pyramid'
+ *
+ * @param channelPath       Path (absolute or relative) to the MEF3 channel folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @param rangeStart        Start of the time range as an (microsecond) epoch/unix timestamp; -1 for beginning/first
+ * @param rangeEnd          End of the time range as an (microsecond) epoch/unix timestamp; -1 for end/last
+ * @param numPoints         The requested number of points (e.g. the number of pixels to draw); the output holds at least this many points
+ * @param applyConvFactor   Whether to apply the unit conversion factor to the raw data. [0 = not apply (default), 1 = apply]
+ * @param numThreads        The number of threads used to decode the data [1 = single-threaded (default), 0 = one thread per processor]
+ * @param validateCRC       Whether to validate the CRC of each block of data [1 = validate (default), 0 = trusted read, only the structure of the blocks is checked]
+ * @return                  A struct with the start time, number of samples, mean, minimum and maximum of each point
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+
+	
+	//
+	// channel path
+	// 
+	
+	// check the channel path input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:noChannelPathArg", "'channelPath' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:invalidChannelPathArg", "'channelPath' input argument invalid, should be a string (array of characters)");
+	if(mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:invalidChannelPathArg", "'channelPath' input argument invalid, argument is empty");
+	
+	// set the channel path
+	si1 channel_path[MEF_FULL_FILE_NAME_BYTES];
+	char *mat_channel_path = mxArrayToString(prhs[0]);
+	MEF_strncpy(channel_path, mat_channel_path, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_channel_path);
+
+
+	// 
+	// password (optional)
+	// 
+	
+	si1 password[PASSWORD_BYTES] = {0};
+	
+	// check if a password input argument is given and is not empty
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+	
+		// check the password input argument data type
+		if (!mxIsChar(prhs[1]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+
+		// convert password (matlab char-array to UTF-8 character string)
+		if (!cpyMxStringToUtf8CharString(prhs[1], password, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+
+	}
+	
+	
+	//
+	// range (in time)
+	//
+	
+	si8 range_start = -1;
+	si8 range_end = -1;
+	if (nrhs > 2)
+		if (!getInputArgAsInt64(prhs[2], "rangeStart", -1, LLONG_MAX, &range_start))	return;
+	if (nrhs > 3)
+		if (!getInputArgAsInt64(prhs[3], "rangeEnd", -1, LLONG_MAX, &range_end))	return;
+	
+	
+    //
+    // Number of points
+    //
+    
+	if (nrhs < 5)			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_pyramid:noNumPointsArg", "'numPoints' input argument not set");
+	si8 num_points = 0;
+	if (!getInputArgAsInt64(prhs[4], "numPoints", 1, LLONG_MAX, &num_points))	return;
+	
+    
+    //
+    // Conversion factor
+    //
+    
+    bool apply_conv_factor = false;
+	if (nrhs > 5) {
+		if (!getInputArgAsBool(prhs[5], "applyConvFactor", &apply_conv_factor))	return;
+    }
+    
+	
+    //
+    // Number of threads
+    //
+    
+	si8 num_threads = 1;
+	if (nrhs > 6) {
+		if (!getInputArgAsInt64(prhs[6], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
+	
+    //
+    // CRC validation
+    //
+    
+	bool validate_crc = true;
+	if (nrhs > 7) {
+		if (!getInputArgAsBool(prhs[7], "validateCRC", &validate_crc))	return;
+	}
+	
+	
+	// 
+	// read the points
+	// 
+	mxArray *points = read_channel_pyramid_from_path(channel_path, password, range_start, range_end, num_points, apply_conv_factor, (si4) num_threads, validate_crc);
+	if (points == NULL)	
+		mexErrMsgTxt("Error while reading the channel pyramid");
+    
+	// set the points as output, if output is expected
+	if (nlhs > 0)
+		plhs[0] = points;
+	
+	// succesfull return from call
+	return;
+	
+}
@@ -0,0 +1,46 @@
+%
+%   Read a decimated (mean, minimum and maximum) version of the data from a time-series channel, for fast zoomed-out reads
+%
+%   [points] = read_mef_ts_pyramid(channelPath, password, rangeStart, rangeEnd, numPoints, applyConvFactor, numThreads, validateCRC)
+%
+%       channelPath     = path (absolute or relative) to the MEF3 channel folder
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       rangeStart      = Start of the time range as an (microsecond) epoch/unix timestamp. Pass -1 to start at the 
+%                         beginning of the timeseries. The default is -1, beginning/first
+%       rangeEnd        = End of the time range as an (microsecond) epoch/unix timestamp. Pass -1 to end at the end of
+%                         the timeseries. The default is -1, end/last
+%       numPoints       = The requested number of points, e.g. the number of pixels in the width of a plot
+%       applyConvFactor = Apply the unit conversion factor to the raw data [0 = not apply, 1 = apply]
+%                         Default = 0 - Do not apply conversion factor
+%       numThreads      = The number of threads used to decode the data [1 = single-threaded, 0 = one thread per processor]
+%                         Default = 1 - Single-threaded
+%       validateCRC     = Whether to validate the CRC of each block of data [0 = trusted read, 1 = validate].
+%                         Default = 1 - Validate the CRCs
+%
+%   Returns:
+%       points          = A struct holding the fields:
+%                            time        - the start time of each point as an int64 epoch/unix timestamp
+%                            numSamples  - the number of samples that each point is decimated from
+%                            mean        - the mean of the samples of each point (rounded to the nearest raw value)
+%                            min         - the minimum of the samples of each point
+%                            max         - the maximum of the samples of each point
+%
+%   Notes:
+%       - Each segment is read from the coarsest level of its pyramid (see build_mef_ts_pyramid) that still yields at
+%         least the requested number of points, so the output holds between 1 and 4 times the requested number of points.
+%       - Segments without an (up-to-date) pyramid are decimated from the full-rate data instead, to the same points that
+%         the pyramid would give (this is slower, so build the pyramid for channels that are viewed zoomed-out often).
+%       - Ranges that hold fewer than 4 samples per requested point are read from the full-rate data; each sample is then
+%         a point (with the mean, minimum and maximum being the sample itself).
+%       - The points cover whole groups of samples, and can therefore extend slightly past the requested range.
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function points = read_mef_ts_pyramid(channelPath, password, rangeStart, rangeEnd, numPoints, applyConvFactor, numThreads, validateCRC)
@@ -0,0 +1,36 @@
+%
+%   Read the contiguous ranges (the data between discontinuities) of multiple time-series channels in a session
+%
+%   [ranges] = read_mef_ts_ranges(sessionPath, password, channels)
+%
+%       sessionPath     = path (absolute or relative) to the MEF3 session directory
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       channels        = a cell array with the names of the time-series channels (e.g. {'Ch1', 'Ch2', 'Ch3'}). 
+%                         The order of channels in this input argument will determine the order of the output struct array.
+%
+%   Returns:
+%       ranges          = A struct array with the contiguous ranges of each channel, holding the fields:
+%                            name        - the name of the channel
+%                            startSample - the (0-based) first sample of each range, as int64
+%                            endSample   - the end sample of each range (exclusive), as int64
+%                            startTime   - the start time of each range as an int64 epoch/unix timestamp
+%                            endTime     - the end time of each range (exclusive) as an int64 epoch/unix timestamp
+%                            segment     - the (0-based) segment number of each range
+%
+%   Notes:
+%       - The ranges are determined only from the time-series indices of the channels (the discontinuity flags and 
+%         start times of the blocks), no data is read or decoded.
+%       - A new range starts at the first block of each segment and at each block that is flagged as discontinuous.
+%       - The sample numbers can be passed directly as a 'samples' range to read_mef_ts_data (e.g. to read the data
+%         of a range without any gaps), the times as a 'time' range.
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function ranges = read_mef_ts_ranges(sessionPath, password, channels)
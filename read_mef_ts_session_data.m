@@ -0,0 +1,58 @@
+%
+%   Read the MEF3 data from multiple time-series channels in a session
+%
+%   [data] = read_mef_ts_session_data(sessionPath, password, channels, rangeType, rangeStart, rangeEnd, applyConvFactor, numThreads, outputType, validateCRC)
+%
+%       sessionPath     = path (absolute or relative) to the MEF3 session directory
+%       password        = password to the MEF3 data; Pass empty string/variable if not encrypted. Default is ''.
+%       channels        = a cell array with the names of the time-series channels to read (e.g. {'Ch1', 'Ch2', 'Ch3'}). 
+%                         The order of channels in this input argument will determine the order of rows in the output matrix.
+%       rangeType       = Modality that is used to define the data-range to read, can be either 'time' or 'samples'.
+%                         Default is 'samples'.
+%       rangeStart      = Start-point for the reading of data. Can either be an (microsecond) epoch/unix
+%                         timestamp or a (0-based) sample-index. Pass -1 to start at the beginning or first 
+%                         sample of the timeseries. The default is -1, beginning/first
+%       rangeEnd        = End-point to stop the of reading data. Either as an (microsecond) epoch/unix 
+%                         timestamp or (0-based) sample-index. Pass -1 as value to end at the end or last 
+%                         sample of the timeseries. The default is -1, end/last
+%       applyConvFactor = Apply the unit conversion factor to the raw data [0 = not apply, 1 = apply]
+%                         Default = 0 - Do not apply conversion factor
+%       numThreads      = The number of threads used to read the channels [1 = single-threaded, 0 = one thread per processor]
+%                         Default = 0 - One thread per processor
+%       outputType      = The data type of the output, can be either 'double' or 'single'. The 'single' output uses half
+%                         the memory of 'double'. Default is 'double'.
+%       validateCRC     = Whether to validate the CRC of each block of data [0 = trusted read, 1 = validate]. A trusted read
+%                         only checks the structure of the blocks (e.g. their sizes), which is faster but will not detect corrupt
+%                         data; only use it on data that have been validated before. Default = 1 - Validate the CRCs
+%
+%   Returns:
+%       data            = A matrix of doubles (or singles) holding the channel data, formatted as <channels> x <samples/time>
+%
+%   Notes:
+%       - The channels are opened once, within a single call, after which the data of the channels are read and
+%         decoded in parallel; This is considerably faster than calling 'read_mef_ts_data' for each channel.
+%       - When reading with multiple threads, the compressed data of all channels in the range (up to 32MB) is read at
+%         once, with numThreads reads in flight at the same time, which allows NVMe drives and parallel/network
+%         filesystems to reach their throughput. Larger ranges (and single-threaded reads) stream the data of each
+%         channel in windows of 16MB.
+%       - If channels return a different number of samples (e.g. different sampling rates), then the rows of
+%         the shorter channels will be padded with NaN values at the end.
+%       - When the rangeType is set to 'samples', the function simply returns the samples as they are
+%         found (consecutively) in the datafile, without any regard for time or data gaps; Meaning
+%         that, if there is a time-gap between samples, then these will not appear in the result returned.
+%         In contrast, the 'time' rangeType will return the data with NaN values in place for the missing samples.
+%       - Because the range is 0-based, data are loaded "up-till" the range end-index. So the result does not 
+%         include the value at the end-index (e.g. a requested sample range of 0-3 will return first 3 values, being
+%         the values at [0], [1], [2])
+%
+%
+%   Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+%   Adapted from PyMef (by Jan Cimbalnik, Matt Stead, Ben Brinkmann, and Dan Crepeau)
+
+%   This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+%   as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+%   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+%   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+%   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+%
+function data = read_mef_ts_session_data(sessionPath, password, channels, rangeType, rangeStart, rangeEnd, applyConvFactor, numThreads, outputType, validateCRC)
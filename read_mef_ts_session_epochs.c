@@ -0,0 +1,231 @@
+/**
+ * 	@file 
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Read multiple ranges (epochs) of MEF3 data from multiple time-series channels in a session
+ *	
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *  
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <ctype.h>
+#include "mex.h"
+#include "matmef_dataconverter.h"
+#include "matmef_read.h"
+
+
+/**
+ * Main entry point for 'read_mef_ts_session_epochs'
+ *
+ * @param sessionPath       Path (absolute or relative) to the MEF3 session folder
+ * @param password          Password to the MEF3 data; Pass empty string/variable if not encrypted
+ * @param channels          A cell array with the names of the time-series channels to read (or a string for a single channel)
+ * @param rangeType         Modality that is used to define the data-range to read [either 'time' or 'samples' (default)]
+ * @param ranges            A <ranges> x 2 matrix with the start- and end-point of each range to read. These can be either (microsecond) epoch/unix timestamps or (0-based) sample-indices; -1 for beginning/first or end/last)
+ * @param applyConvFactor   Whether to apply the unit conversion factor to the raw data. [0 = not apply (default), 1 = apply]
+ * @param numThreads        The number of threads used to read the channels [0 = one thread per processor (default), 1 = single-threaded]
+ * @param outputType        The data type of the output ['double' (default) or 'single']
+ * @param validateCRC       Whether to validate the CRC of each block of data [1 = validate (default), 0 = trusted read, only the structure of the blocks is checked]
+ * @return                  A matrix of doubles (or singles) holding the channel data (<channels> x <samples> x <ranges>)
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	si4		i;
+	
+	
+	//
+	// session path
+	// 
+	
+	// check the session path input argument
+    if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:noSessionPathArg", "'sessionPath' input argument not set");
+	if(!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidSessionPathArg", "'sessionPath' input argument invalid, should be a string (array of characters)");
+	if(mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidSessionPathArg", "'sessionPath' input argument invalid, argument is empty");
+	
+	// set the session path
+	si1 session_path[MEF_FULL_FILE_NAME_BYTES];
+	char *mat_session_path = mxArrayToString(prhs[0]);
+	MEF_strncpy(session_path, mat_session_path, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_session_path);
+	
+	// remove a trailing path separator
+	size_t path_len = strlen(session_path);
+	if (path_len > 1 && (session_path[path_len - 1] == '/' || session_path[path_len - 1] == '\\'))
+		session_path[path_len - 1] = '\0';
+	
+
+	// 
+	// password (optional)
+	// 
+	
+	si1 password[PASSWORD_BYTES] = {0};
+	
+	// check if a password input argument is given and is not empty
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+	
+		// check the password input argument data type
+		if (!mxIsChar(prhs[1]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidPasswordArg", "'password' input argument invalid, should be a string (array of characters)");
+
+		// convert password (matlab char-array to UTF-8 character string)
+		if (!cpyMxStringToUtf8CharString(prhs[1], password, PASSWORD_BYTES))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidPasswordArg", "'password' input argument invalid, could not convert matlab char-array to UTF-8 bytes");
+
+	}
+	
+	
+	//
+	// channels
+	//
+	
+	// check the channels input argument
+    if (nrhs < 3)										mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:noChannelsArg", "'channels' input argument not set");
+	if (!mxIsCell(prhs[2]) && !mxIsChar(prhs[2]))		mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidChannelsArg", "'channels' input argument invalid, should be a cell array containing channel names (e.g. {'Ch1', 'Ch2', 'Ch3'})");
+	if (mxIsEmpty(prhs[2]))								mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidChannelsArg", "'channels' input argument invalid, argument is empty");
+	
+	// retrieve the channel names
+	si4 num_channels = mxIsChar(prhs[2]) ? 1 : (si4) mxGetNumberOfElements(prhs[2]);
+	si1 **channel_names = (si1 **) mxCalloc((size_t) num_channels, sizeof(si1 *));
+	for (i = 0; i < num_channels; i++) {
+		const mxArray *mat_channel_name = mxIsChar(prhs[2]) ? prhs[2] : mxGetCell(prhs[2], i);
+		if (mat_channel_name == NULL || !mxIsChar(mat_channel_name) || mxIsEmpty(mat_channel_name))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidChannelsArg", "'channels' input argument invalid, should be a cell array containing channel names (e.g. {'Ch1', 'Ch2', 'Ch3'})");
+		channel_names[i] = mxArrayToString(mat_channel_name);
+	}
+	
+	
+	//
+	// ranges
+	//
+	
+	bool range_type = RANGE_BY_SAMPLES;
+	si4 num_ranges = 1;
+	si8 *ranges_start = NULL;
+	si8 *ranges_end = NULL;
+	
+	// check if a range-type input argument is given
+    if (nrhs > 3) {
+		
+		// check valid range type
+		if (!mxIsChar(prhs[3]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidRangeTypeArg", "'rangeType' input argument invalid, should be a string (array of characters)");
+		char *mat_range_type = mxArrayToString(prhs[3]);
+		for(i = 0; mat_range_type[i]; i++)	mat_range_type[i] = tolower(mat_range_type[i]);
+		if (strcmp(mat_range_type, "time") != 0 && strcmp(mat_range_type, "samples") != 0)
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidRangeTypeArg", "'rangeType' input argument invalid, allowed values are 'time' or 'samples'");
+		
+		// set the range type
+		if (strcmp(mat_range_type, "time") == 0)
+			range_type = RANGE_BY_TIME;
+		mxFree(mat_range_type);
+		
+	}
+	
+	// check and retrieve the ranges (<ranges> x 2, as int64 or whole double values)
+	if (nrhs > 4) {
+		if (mxIsEmpty(prhs[4]) || mxGetNumberOfDimensions(prhs[4]) != 2 || mxGetN(prhs[4]) != 2 || !(mxIsInt64(prhs[4]) || mxIsDouble(prhs[4])) || mxIsComplex(prhs[4]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidRangesArg", "'ranges' input argument invalid, should be a Nx2 matrix of int64 (or whole double) values");
+		num_ranges = (si4) mxGetM(prhs[4]);
+	}
+	ranges_start = (si8 *) mxCalloc((size_t) num_ranges, sizeof(si8));
+	ranges_end = (si8 *) mxCalloc((size_t) num_ranges, sizeof(si8));
+	for (i = 0; i < num_ranges; i++) {
+		ranges_start[i] = ranges_end[i] = -1;
+		if (nrhs > 4) {
+			if (mxIsInt64(prhs[4])) {
+				ranges_start[i] = ((si8 *) mxGetData(prhs[4]))[i];
+				ranges_end[i] = ((si8 *) mxGetData(prhs[4]))[num_ranges + i];
+			} else {
+				sf8 mat_start = mxGetPr(prhs[4])[i];
+				sf8 mat_end = mxGetPr(prhs[4])[num_ranges + i];
+				if (mat_start != floor(mat_start) || mat_end != floor(mat_end) || mat_start > (sf8) LLONG_MAX || mat_end > (sf8) LLONG_MAX)
+					mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidRangesArg", "'ranges' input argument invalid, should be a Nx2 matrix of int64 (or whole double) values");
+				ranges_start[i] = (si8) mat_start;
+				ranges_end[i] = (si8) mat_end;
+			}
+		}
+		if (ranges_start[i] < -1 || ranges_end[i] < -1)
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidRangesArg", "'ranges' input argument invalid, values should be either -1 or >= 0");
+	}
+	
+    
+    //
+    // Conversion factor
+    //
+    
+    bool apply_conv_factor = false;
+	if (nrhs > 5) {
+		if (!getInputArgAsBool(prhs[5], "applyConvFactor", &apply_conv_factor))	return;
+    }
+    
+	
+    //
+    // Number of threads
+    //
+    
+	si8 num_threads = 0;
+	if (nrhs > 6) {
+		if (!getInputArgAsInt64(prhs[6], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
+	
+    //
+    // Output type
+    //
+    
+	si4 output_type = OUTPUT_DOUBLE;
+	if (nrhs > 7) {
+		
+		// check valid output type
+		if (!mxIsChar(prhs[7]))
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidOutputTypeArg", "'outputType' input argument invalid, should be a string (array of characters)");
+		char *mat_output_type = mxArrayToString(prhs[7]);
+		for(i = 0; mat_output_type[i]; i++)	mat_output_type[i] = tolower(mat_output_type[i]);
+		if (strcmp(mat_output_type, "double") != 0 && strcmp(mat_output_type, "single") != 0)
+			mexErrMsgIdAndTxt("MATLAB:read_mef_ts_session_epochs:invalidOutputTypeArg", "'outputType' input argument invalid, allowed values are 'double' or 'single'");
+		
+		// set the output type
+		if (strcmp(mat_output_type, "single") == 0)
+			output_type = OUTPUT_SINGLE;
+		mxFree(mat_output_type);
+		
+	}
+	
+	
+    //
+    // CRC validation
+    //
+    
+	bool validate_crc = true;
+	if (nrhs > 8) {
+		if (!getInputArgAsBool(prhs[8], "validateCRC", &validate_crc))	return;
+	}
+	
+	
+	// 
+	// read the data
+	// 
+	mxArray *data = read_session_channels_epochs(session_path, channel_names, num_channels, password, range_type, ranges_start, ranges_end, num_ranges, apply_conv_factor, (si4) num_threads, output_type, validate_crc);
+	
+	// free the channel names and ranges
+	for (i = 0; i < num_channels; i++)
+		mxFree(channel_names[i]);
+	mxFree(channel_names);
+	mxFree(ranges_start);
+	mxFree(ranges_end);
+	
+	// check for errors
+	if (data == NULL)	
+		mexErrMsgTxt("Error while reading channel data");
+    
+	// set the data as output, if output is expected
+	if (nlhs > 0)
+		plhs[0] = data;
+	
+	// succesfull return from call
+	return;
+	
+}
@@ -0,0 +1,279 @@
+/**
+ * 	@file
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Regression check of the RED block decoder (decode_red_block) against the decoder of the MEF 3.0 library (RED_decode)
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "../matmef_read.h"
+
+// the meflib globals (defined in meflib.c, which is included by matmef_read.c)
+extern MEF_GLOBALS	*MEF_globals;
+
+// the maximum number of samples in a test block
+#define TEST_MAX_BLOCK_SAMPLES		4000
+
+// The configurations that blocks are encoded with
+typedef struct {
+	const char	*name;
+	si1			encryption_level;		// NO_ENCRYPTION, LEVEL_1_ENCRYPTION or LEVEL_2_ENCRYPTION
+	si1			discontinuity;			// whether the blocks are flagged as discontinuous
+	si1			detrend;				// whether the blocks are detrended before encoding
+	sf4			scale_factor;			// the scale factor of the blocks (1.0 = lossless, unless detrended)
+} TEST_CONFIGURATION;
+
+static const TEST_CONFIGURATION TEST_CONFIGURATIONS[] = {
+	{"unencrypted",					NO_ENCRYPTION,			MEF_FALSE,	MEF_FALSE,	(sf4) 1.0},
+	{"discontinuity",				NO_ENCRYPTION,			MEF_TRUE,	MEF_FALSE,	(sf4) 1.0},
+	{"level 1 encrypted",			LEVEL_1_ENCRYPTION,		MEF_FALSE,	MEF_FALSE,	(sf4) 1.0},
+	{"level 2 encrypted",			LEVEL_2_ENCRYPTION,		MEF_TRUE,	MEF_FALSE,	(sf4) 1.0},
+	{"detrended",					NO_ENCRYPTION,			MEF_FALSE,	MEF_TRUE,	(sf4) 1.0},
+	{"lossy (scaled)",				NO_ENCRYPTION,			MEF_FALSE,	MEF_FALSE,	(sf4) 3.7},
+	{"lossy (scaled, detrended)",	LEVEL_1_ENCRYPTION,		MEF_TRUE,	MEF_TRUE,	(sf4) 12.0}
+};
+static const int TEST_NUM_CONFIGURATIONS = 7;
+
+
+/**
+ * 	Generate a pseudo-random number (xorshift, so the blocks are the same on every platform)
+ *
+ * 	@param state                Pointer to the state of the generator
+ * 	@return                     The next pseudo-random number
+ */
+static ui4 test_random(ui4 *state) {
+	ui4 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return *state = x;
+}
+
+/**
+ * 	Generate the samples of a test block, the kind of signal alternates between blocks
+ *  (small and large steps, which produce keysamples, full-range values, constant values and a trend)
+ *
+ * 	@param samples              The buffer that will hold the samples
+ * 	@param number_of_samples    The number of samples to generate
+ * 	@param kind                 The kind of signal to generate
+ * 	@param state                Pointer to the state of the random generator
+ */
+static void generate_test_samples(si4 *samples, ui4 number_of_samples, ui4 kind, ui4 *state) {
+	ui4 i;
+	si4 value = (si4) (test_random(state) % 2000001) - 1000000;
+
+	for (i = 0; i < number_of_samples; i++) {
+		switch (kind % 5) {
+			case 0:		value += (si4) (test_random(state) % 41) - 20;									break;
+			case 1:		value += (si4) (test_random(state) % 601) - 300;								break;
+			case 2:		value = (si4) (test_random(state) % 0x7FFFFFFF) - 0x3FFFFFFF;					break;
+			case 3:																						break;
+			default:	value = (si4) i * 250 - 400000 + (si4) (test_random(state) % 2001) - 1000;		break;
+		}
+		samples[i] = value;
+	}
+
+}
+
+/**
+ * 	Main entry point for 'test_red_decode'
+ *
+ *	Encodes pseudo-random blocks with RED_encode in each configuration (unencrypted, level 1 and 2 encrypted, lossy
+ *	and discontinuous) and decodes each block with both RED_decode and decode_red_block. The samples and the block
+ *	headers that result from both decoders should be identical (bit for bit). Also checks that decode_red_block
+ *	refuses to decode a block without access to its encryption level, and that a block whose statistics hold no counts
+ *	is rejected (by the structural checks as well). Raises an error on any difference.
+ *
+ * @param numBlocks         The number of blocks to check per configuration (default 200)
+ * @return                  The total number of blocks that were checked
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	si4		c, b;
+	ui4		state = 0x4D454633;
+	bool	success = true;
+	si8		num_checked = 0;
+
+	// retrieve the number of blocks (optional)
+	si4 num_blocks = 200;
+	if (nrhs > 0 && !mxIsEmpty(prhs[0])) {
+		if (!mxIsNumeric(prhs[0]) || mxGetNumberOfElements(prhs[0]) != 1 || mxGetScalar(prhs[0]) < 1)
+			mexErrMsgIdAndTxt("MATLAB:test_red_decode:invalidNumBlocksArg", "'numBlocks' input argument invalid, should be a positive number");
+		num_blocks = (si4) mxGetScalar(prhs[0]);
+	}
+
+	// initialize MEF library
+	(void) initialize_meflib();
+
+	// process the password data (as the writers do), which gives access to both levels
+	si1 password_l1[PASSWORD_BYTES] = "level1pass";
+	si1 password_l2[PASSWORD_BYTES] = "level2pass";
+	FILE_PROCESSING_STRUCT *gen_fps = allocate_file_processing_struct(UNIVERSAL_HEADER_BYTES, NO_FILE_TYPE_CODE, NULL, NULL, 0);
+	initialize_universal_header(gen_fps, MEF_TRUE, MEF_FALSE, MEF_TRUE);
+	MEF_globals->behavior_on_fail = SUPPRESS_ERROR_OUTPUT;
+	PASSWORD_DATA *pwd = process_password_data(NULL, password_l1, password_l2, gen_fps->universal_header);
+	MEF_globals->behavior_on_fail = EXIT_ON_FAIL;
+
+	// prepare the decryption keys and the settings for decode_red_block
+	// (the keys are prepared for the AES instructions when the processor supports these, odd blocks are decrypted
+	// without the instructions so that both are checked)
+	BLOCK_DECRYPTION decryption;
+	prepare_block_decryption(&decryption, pwd);
+	BLOCK_DECRYPTION software_decryption = decryption;
+	software_decryption.level_1.hardware = software_decryption.level_2.hardware = false;
+	READ_CONTEXT context;
+	capture_read_context(&context);
+
+	// allocate the buffers (the encoded block, a copy of the encoded block for each decoder and the decoded samples)
+	ui8 max_block_bytes = RED_MAX_COMPRESSED_BYTES(TEST_MAX_BLOCK_SAMPLES, 1);
+	si4 *original = (si4 *) malloc(TEST_MAX_BLOCK_SAMPLES * sizeof(si4));
+	ui1 *encoded = (ui1 *) malloc((size_t) max_block_bytes);
+	ui1 *block_ref = (ui1 *) malloc((size_t) max_block_bytes);
+	ui1 *block_test = (ui1 *) malloc((size_t) max_block_bytes);
+	si4 *decoded_ref = (si4 *) malloc(TEST_MAX_BLOCK_SAMPLES * sizeof(si4));
+	si4 *decoded_test = (si4 *) malloc(TEST_MAX_BLOCK_SAMPLES * sizeof(si4));
+	RED_PROCESSING_STRUCT *enc_rps = RED_allocate_processing_struct(0, 0, 0, RED_MAX_DIFFERENCE_BYTES(TEST_MAX_BLOCK_SAMPLES), TEST_MAX_BLOCK_SAMPLES, TEST_MAX_BLOCK_SAMPLES, pwd);
+	RED_PROCESSING_STRUCT *ref_rps = RED_allocate_processing_struct(0, 0, 0, RED_MAX_DIFFERENCE_BYTES(TEST_MAX_BLOCK_SAMPLES) + 1, 0, 0, pwd);
+	RED_PROCESSING_STRUCT *test_rps = RED_allocate_processing_struct(0, 0, 0, RED_MAX_DIFFERENCE_BYTES(TEST_MAX_BLOCK_SAMPLES) + 1, 0, 0, NULL);
+	if (original == NULL || encoded == NULL || block_ref == NULL || block_test == NULL || decoded_ref == NULL || decoded_test == NULL || enc_rps == NULL || ref_rps == NULL || test_rps == NULL)
+		mexErrMsgIdAndTxt("MATLAB:test_red_decode:memory", "could not allocate enough memory for the test");
+	ref_rps->compression.mode = RED_DECOMPRESSION;
+	test_rps->compression.mode = RED_DECOMPRESSION;
+
+	// loop over the configurations
+	for (c = 0; c < TEST_NUM_CONFIGURATIONS && success; c++) {
+		const TEST_CONFIGURATION *config = &TEST_CONFIGURATIONS[c];
+
+		for (b = 0; b < num_blocks && success; b++) {
+			ui4 number_of_samples = (b == 0) ? 1 : 1 + (test_random(&state) % TEST_MAX_BLOCK_SAMPLES);
+			generate_test_samples(original, number_of_samples, (ui4) b, &state);
+
+			// encode the block
+			enc_rps->compressed_data = encoded;
+			enc_rps->block_header = (RED_BLOCK_HEADER *) encoded;
+			enc_rps->original_data = enc_rps->original_ptr = original;
+			enc_rps->block_header->number_of_samples = number_of_samples;
+			enc_rps->block_header->start_time = 1578715810000000 + (si8) b * 1000000;
+			enc_rps->block_header->scale_factor = config->scale_factor;
+			enc_rps->compression.mode = (config->scale_factor > (sf4) 1.0) ? RED_FIXED_SCALE_FACTOR : RED_LOSSLESS_COMPRESSION;
+			enc_rps->directives.detrend_data = config->detrend;
+			enc_rps->directives.require_normality = MEF_FALSE;
+			enc_rps->directives.discontinuity = config->discontinuity;
+			enc_rps->directives.encryption_level = config->encryption_level;
+			RED_encode(enc_rps);
+			ui4 block_bytes = enc_rps->block_header->block_bytes;
+
+			// decode a copy of the block with RED_decode
+			memcpy(block_ref, encoded, block_bytes);
+			ref_rps->compressed_data = block_ref;
+			ref_rps->block_header = (RED_BLOCK_HEADER *) block_ref;
+			ref_rps->decompressed_data = ref_rps->decompressed_ptr = decoded_ref;
+			RED_decode(ref_rps);
+
+			// decode a copy of the block with decode_red_block
+			memcpy(block_test, encoded, block_bytes);
+			test_rps->compressed_data = block_test;
+			test_rps->block_header = (RED_BLOCK_HEADER *) block_test;
+			test_rps->decompressed_data = test_rps->decompressed_ptr = decoded_test;
+			if (!decode_red_block(test_rps, &context, (b % 2) ? &software_decryption : &decryption)) {
+				mexPrintf("Error: '%s' block %i (%u samples) could not be decoded by decode_red_block\n", config->name, b, number_of_samples);
+				success = false;
+				break;
+			}
+
+			// compare the samples and the (decrypted and time-offset) headers
+			if (memcmp(decoded_ref, decoded_test, (size_t) number_of_samples * sizeof(si4)) != 0) {
+				mexPrintf("Error: '%s' block %i (%u samples) decodes to different samples\n", config->name, b, number_of_samples);
+				success = false;
+			} else if (memcmp(block_ref, block_test, RED_BLOCK_HEADER_BYTES) != 0) {
+				mexPrintf("Error: '%s' block %i (%u samples) decodes to a different block header\n", config->name, b, number_of_samples);
+				success = false;
+			} else if (config->scale_factor == (sf4) 1.0 && config->detrend != MEF_TRUE && memcmp(decoded_test, original, (size_t) number_of_samples * sizeof(si4)) != 0) {
+				mexPrintf("Error: '%s' block %i (%u samples) does not decode to the original (lossless) samples\n", config->name, b, number_of_samples);
+				success = false;
+			}
+			num_checked++;
+
+		}
+		if (success)
+			mexPrintf("%-28s %i blocks identical\n", config->name, num_blocks);
+
+	}
+
+	// check that a block is not decoded without access to its encryption level
+	if (success) {
+		generate_test_samples(original, 1000, 0, &state);
+		enc_rps->compressed_data = encoded;
+		enc_rps->block_header = (RED_BLOCK_HEADER *) encoded;
+		enc_rps->original_data = enc_rps->original_ptr = original;
+		enc_rps->block_header->number_of_samples = 1000;
+		enc_rps->block_header->scale_factor = (sf4) 1.0;
+		enc_rps->compression.mode = RED_LOSSLESS_COMPRESSION;
+		enc_rps->directives.detrend_data = MEF_FALSE;
+		enc_rps->directives.encryption_level = LEVEL_2_ENCRYPTION;
+		RED_encode(enc_rps);
+
+		BLOCK_DECRYPTION level_1_decryption = decryption;
+		level_1_decryption.access_level = LEVEL_1_ENCRYPTION;
+		test_rps->compressed_data = encoded;
+		test_rps->block_header = (RED_BLOCK_HEADER *) encoded;
+		test_rps->decompressed_data = test_rps->decompressed_ptr = decoded_test;
+		if (decode_red_block(test_rps, &context, &level_1_decryption) || decode_red_block(test_rps, &context, NULL)) {
+			mexPrintf("Error: a level 2 encrypted block was decoded without level 2 access\n");
+			success = false;
+		} else
+			mexPrintf("%-28s refused\n", "no access");
+	}
+
+	// check that a block whose statistics hold no counts is rejected by the structural checks of a trusted read, and
+	// is not decoded (the range decoder would otherwise divide by zero)
+	if (success) {
+		enc_rps->block_header->number_of_samples = 1000;
+		enc_rps->directives.encryption_level = NO_ENCRYPTION;
+		RED_encode(enc_rps);
+		memset(enc_rps->block_header->statistics, 0, RED_BLOCK_STATISTICS_BYTES);
+
+		test_rps->compressed_data = encoded;
+		test_rps->block_header = (RED_BLOCK_HEADER *) encoded;
+		test_rps->decompressed_data = test_rps->decompressed_ptr = decoded_test;
+		if (check_block(encoded, TEST_MAX_BLOCK_SAMPLES, encoded, enc_rps->block_header->block_bytes, false) || decode_red_block(test_rps, &context, &decryption)) {
+			mexPrintf("Error: a block without statistics counts was accepted\n");
+			success = false;
+		} else
+			mexPrintf("%-28s refused\n", "no statistics counts");
+	}
+
+	// free the memory
+	free (original);
+	free (encoded);
+	free (block_ref);
+	free (block_test);
+	free (decoded_ref);
+	free (decoded_test);
+	RED_PROCESSING_STRUCT *rps_list[3] = {enc_rps, ref_rps, test_rps};
+	for (c = 0; c < 3; c++) {
+		rps_list[c]->compressed_data = NULL;
+		rps_list[c]->block_header = NULL;
+		rps_list[c]->original_data = rps_list[c]->original_ptr = NULL;
+		rps_list[c]->decompressed_data = rps_list[c]->decompressed_ptr = NULL;
+		rps_list[c]->password_data = NULL;
+		RED_free_processing_struct(rps_list[c]);
+	}
+	free (pwd);
+	free_file_processing_struct(gen_fps);
+
+	// check for errors
+	if (!success)
+		mexErrMsgIdAndTxt("MATLAB:test_red_decode:mismatch", "decode_red_block does not decode identically to RED_decode");
+
+	// return the number of blocks that were checked
+	if (nlhs > 0)
+		plhs[0] = mxCreateDoubleScalar((double) num_checked);
+
+}
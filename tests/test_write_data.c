@@ -0,0 +1,276 @@
+/**
+ * 	@file
+ * 	MEF 3.0 Library Matlab Wrapper
+ * 	Regression check of the (multi-threaded) writing of time-series data
+ *
+ *  Copyright 2026, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
+ *
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "mex.h"
+#include "../matmef_write.h"
+#include "../matmef_mapping.h"
+#include "../matmef_dataconverter.h"
+#include "../mex_utils.h"
+
+// the number of samples, samples per block and sampling frequency of the test data (enough small blocks to
+// spread over multiple workers and batches, see WRITE_WORKER_BLOCKS, with a partial block at the end)
+#define TEST_NUM_SAMPLES			250050
+#define TEST_SAMPLES_PER_BLOCK		100
+#define TEST_SAMPLING_FREQUENCY		2000.0
+#define TEST_START_TIME				1578715810000000
+
+// the samples at which the data is split for the appends (at block boundaries, the data of a single write is only
+// divided over the same blocks if each append starts a new block)
+static const si8 TEST_APPEND_SPLITS[] = {100000, 200000};
+static const int TEST_NUM_APPEND_SPLITS = 2;
+
+// the files of a time-series segment that are compared
+static const char *TEST_SEGMENT_EXTENSIONS[] = {TIME_SERIES_DATA_FILE_TYPE_STRING, TIME_SERIES_INDICES_FILE_TYPE_STRING, TIME_SERIES_METADATA_FILE_TYPE_STRING};
+static const int TEST_NUM_SEGMENT_EXTENSIONS = 3;
+
+
+/**
+ * 	Generate the (pseudo-random) test data, a random walk with occasional jumps (so that blocks hold keysamples)
+ *
+ * 	@param samples              The buffer that will hold the samples
+ * 	@param number_of_samples    The number of samples to generate
+ */
+static void generate_test_data(si4 *samples, si8 number_of_samples) {
+	si8 i;
+	ui4 state = 0x4D454633;
+	si4 value = 0;
+
+	for (i = 0; i < number_of_samples; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		value += (si4) (state % 201) - 100;
+		if (i % 5000 == 0)
+			value = (si4) (state % 2000001) - 1000000;
+		samples[i] = value;
+	}
+
+}
+
+/**
+ * 	Write a time-series segment (the metadata and the data) to a test folder
+ *
+ * 	@param test_folder          The folder to write the segment in (a channel folder is created in it)
+ * 	@param name                 The name of the channel
+ * 	@param samples              The samples to write
+ * 	@param number_of_samples    The number of samples to write
+ * 	@param lossy_flag           Whether to compress lossy
+ * 	@param num_threads          The number of threads to encode the data with (0 = one per processor)
+ * 	@param segment_path         The buffer that will hold the path of the segment that was written
+ * 	@return                     True if successful, false on failure
+ */
+static bool write_test_segment(si1 *test_folder, si1 *name, si4 *samples, si8 number_of_samples, bool lossy_flag, si4 num_threads, si1 *segment_path) {
+
+	// create the segment folder
+	MEF_snprintf(segment_path, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s/%s-000000.%s", test_folder, name, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING, name, SEGMENT_DIRECTORY_TYPE_STRING);
+	if (!createDir(segment_path)) {
+		mexPrintf("Error: could not create the folder '%s'\n", segment_path);
+		return false;
+	}
+
+	// write the metadata
+	mxArray *mat_tmd2 = create_init_matlab_tmd2();
+	mxSetField(mat_tmd2, 0, "sampling_frequency", mxDoubleByValue(TEST_SAMPLING_FREQUENCY));
+	mxSetField(mat_tmd2, 0, "units_conversion_factor", mxDoubleByValue(1.0));
+	mxSetField(mat_tmd2, 0, "start_sample", mxInt64ByValue(0));
+	mxArray *mat_md3 = create_init_matlab_md3();
+	mxSetField(mat_md3, 0, "recording_time_offset", mxInt64ByValue(0));
+	si8 end_time = TEST_START_TIME + (si8) (number_of_samples / TEST_SAMPLING_FREQUENCY * 1e6);
+	bool success = write_metadata(segment_path, NULL, NULL, TEST_START_TIME, end_time, "anonymized", TIME_SERIES_CHANNEL_TYPE, mat_tmd2, mat_md3);
+	mxDestroyArray(mat_tmd2);
+	mxDestroyArray(mat_md3);
+	if (!success)
+		return false;
+
+	// write the data
+	mxArray *mat_data = mxCreateNumericMatrix((mwSize) number_of_samples, 1, mxINT32_CLASS, mxREAL);
+	memcpy(mxGetData(mat_data), samples, (size_t) number_of_samples * sizeof(si4));
+	success = write_mef_ts_data_and_indices(segment_path, NULL, NULL, TEST_SAMPLES_PER_BLOCK, mat_data, lossy_flag, num_threads);
+	mxDestroyArray(mat_data);
+	return success;
+
+}
+
+/**
+ * 	Append samples to the time-series data of a written segment
+ *
+ * 	@param segment_path         The path of the segment to append to
+ * 	@param samples              The samples to append
+ * 	@param number_of_samples    The number of samples to append
+ * 	@param lossy_flag           Whether to compress lossy
+ * 	@param num_threads          The number of threads to encode the data with (0 = one per processor)
+ * 	@return                     True if successful, false on failure
+ */
+static bool append_test_segment(si1 *segment_path, si4 *samples, si8 number_of_samples, bool lossy_flag, si4 num_threads) {
+	mxArray *mat_data = mxCreateNumericMatrix((mwSize) number_of_samples, 1, mxINT32_CLASS, mxREAL);
+	memcpy(mxGetData(mat_data), samples, (size_t) number_of_samples * sizeof(si4));
+	bool success = append_mef_ts_data_and_indices(segment_path, NULL, NULL, mat_data, lossy_flag, num_threads);
+	mxDestroyArray(mat_data);
+	return success;
+}
+
+/**
+ * 	Read a file into a newly allocated buffer
+ *
+ * 	@param path                 The path of the file
+ * 	@param bytes                Pointer to a variable that will hold the size of the file
+ * 	@return                     The buffer with the content of the file (to be freed by the caller), or NULL on failure
+ */
+static ui1 *read_test_file(si1 *path, si8 *bytes) {
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL)		return NULL;
+
+	fseek(fp, 0, SEEK_END);
+	*bytes = (si8) ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	ui1 *buffer = (ui1 *) malloc((size_t) (*bytes > 0 ? *bytes : 1));
+	if (buffer != NULL && fread(buffer, sizeof(ui1), (size_t) *bytes, fp) != (size_t) *bytes) {
+		free (buffer);
+		buffer = NULL;
+	}
+	fclose(fp);
+	return buffer;
+}
+
+/**
+ * 	Compare the files (data, indices and metadata) of two written time-series segments
+ *
+ *	The bodies of the files should be identical byte for byte. Of the universal headers (which hold the random
+ *	UUIDs of the files) the body CRC, the number of entries, the maximum entry size and the times are compared.
+ *
+ * 	@param test_folder          The folder the segments were written in
+ * 	@param name_a               The channel name of the first segment
+ * 	@param name_b               The channel name of the second segment
+ * 	@param label                The label of the comparison (for the messages)
+ * 	@return                     True if the files are identical, false otherwise
+ */
+static bool compare_test_segments(si1 *test_folder, si1 *name_a, si1 *name_b, const char *label) {
+	si4		i;
+	si1		path_a[MEF_FULL_FILE_NAME_BYTES], path_b[MEF_FULL_FILE_NAME_BYTES];
+	si8		bytes_a, bytes_b;
+	bool	identical = true;
+
+	for (i = 0; i < TEST_NUM_SEGMENT_EXTENSIONS && identical; i++) {
+		MEF_snprintf(path_a, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s/%s-000000.%s/%s-000000.%s", test_folder, name_a, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING, name_a, SEGMENT_DIRECTORY_TYPE_STRING, name_a, TEST_SEGMENT_EXTENSIONS[i]);
+		MEF_snprintf(path_b, MEF_FULL_FILE_NAME_BYTES, "%s/%s.%s/%s-000000.%s/%s-000000.%s", test_folder, name_b, TIME_SERIES_CHANNEL_DIRECTORY_TYPE_STRING, name_b, SEGMENT_DIRECTORY_TYPE_STRING, name_b, TEST_SEGMENT_EXTENSIONS[i]);
+		ui1 *file_a = read_test_file(path_a, &bytes_a);
+		ui1 *file_b = read_test_file(path_b, &bytes_b);
+
+		if (file_a == NULL || file_b == NULL || bytes_a < UNIVERSAL_HEADER_BYTES || bytes_b < UNIVERSAL_HEADER_BYTES) {
+			mexPrintf("Error: %s, could not read the .%s files\n", label, TEST_SEGMENT_EXTENSIONS[i]);
+			identical = false;
+
+		} else {
+			UNIVERSAL_HEADER *uh_a = (UNIVERSAL_HEADER *) file_a;
+			UNIVERSAL_HEADER *uh_b = (UNIVERSAL_HEADER *) file_b;
+			if (bytes_a != bytes_b) {
+				mexPrintf("Error: %s, the .%s files differ in size (%lld and %lld bytes)\n", label, TEST_SEGMENT_EXTENSIONS[i], (long long) bytes_a, (long long) bytes_b);
+				identical = false;
+			} else if (memcmp(file_a + UNIVERSAL_HEADER_BYTES, file_b + UNIVERSAL_HEADER_BYTES, (size_t) (bytes_a - UNIVERSAL_HEADER_BYTES)) != 0) {
+				mexPrintf("Error: %s, the bodies of the .%s files differ\n", label, TEST_SEGMENT_EXTENSIONS[i]);
+				identical = false;
+			} else if (uh_a->body_CRC != uh_b->body_CRC || uh_a->number_of_entries != uh_b->number_of_entries || uh_a->maximum_entry_size != uh_b->maximum_entry_size ||
+					   uh_a->start_time != uh_b->start_time || uh_a->end_time != uh_b->end_time) {
+				mexPrintf("Error: %s, the universal headers of the .%s files differ\n", label, TEST_SEGMENT_EXTENSIONS[i]);
+				identical = false;
+			}
+		}
+
+		free (file_a);
+		free (file_b);
+	}
+
+	if (identical)
+		mexPrintf("%-40s identical\n", label);
+	return identical;
+
+}
+
+/**
+ * 	Main entry point for 'test_write_data'
+ *
+ *	Writes the same (pseudo-random) data with a single thread and with multiple threads (lossless and lossy), and
+ *	as a first part that the remaining parts are appended to, and checks that the written files are identical to
+ *	those of the single-threaded single write. Raises an error on any difference.
+ *
+ * @param testFolder        An (empty) folder to write the test segments in (e.g. tempname)
+ * @return                  The number of comparisons that were made
+ */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	si4		i;
+	si1		test_folder[MEF_FULL_FILE_NAME_BYTES];
+	si1		segment_path[MEF_FULL_FILE_NAME_BYTES], reference_name[MEF_BASE_FILE_NAME_BYTES], name[MEF_BASE_FILE_NAME_BYTES], label[256];
+	bool	success = true;
+	si4		num_compared = 0;
+
+	// check the test folder input argument
+	if (nrhs < 1)				mexErrMsgIdAndTxt("MATLAB:test_write_data:noTestFolderArg", "'testFolder' input argument not set");
+	if (!mxIsChar(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:test_write_data:invalidTestFolderArg", "'testFolder' input argument invalid, should be a string (array of characters)");
+	if (mxIsEmpty(prhs[0]))		mexErrMsgIdAndTxt("MATLAB:test_write_data:invalidTestFolderArg", "'testFolder' input argument invalid, argument is empty");
+	char *mat_test_folder = mxArrayToString(prhs[0]);
+	MEF_strncpy(test_folder, mat_test_folder, MEF_FULL_FILE_NAME_BYTES);
+	mxFree(mat_test_folder);
+
+	// generate the test data
+	si4 *samples = (si4 *) malloc(TEST_NUM_SAMPLES * sizeof(si4));
+	if (samples == NULL)
+		mexErrMsgIdAndTxt("MATLAB:test_write_data:memory", "could not allocate enough memory for the test data");
+	generate_test_data(samples, TEST_NUM_SAMPLES);
+
+	//
+	// writing with a single thread (the default) and with multiple threads (0 = one thread per processor)
+	//
+	const si4 thread_counts[] = {2, 3, 8, 0};
+	for (si4 lossy = 0; lossy < 2 && success; lossy++) {
+		MEF_snprintf(reference_name, MEF_BASE_FILE_NAME_BYTES, "threads1_%s", lossy ? "lossy" : "lossless");
+		success = write_test_segment(test_folder, reference_name, samples, TEST_NUM_SAMPLES, lossy == 1, 1, segment_path);
+
+		for (i = 0; i < 4 && success; i++) {
+			MEF_snprintf(name, MEF_BASE_FILE_NAME_BYTES, "threads%i_%s", thread_counts[i], lossy ? "lossy" : "lossless");
+			success = write_test_segment(test_folder, name, samples, TEST_NUM_SAMPLES, lossy == 1, thread_counts[i], segment_path);
+			if (success) {
+				MEF_snprintf(label, 256, "%s, 1 vs %i threads", lossy ? "lossy" : "lossless", thread_counts[i]);
+				success = compare_test_segments(test_folder, reference_name, name, label);
+				num_compared++;
+			}
+		}
+
+		// write the first part and append the remaining parts (the segment metadata is first written with the end time
+		// of the first part, each append should extend it)
+		if (success) {
+			MEF_snprintf(name, MEF_BASE_FILE_NAME_BYTES, "append_%s", lossy ? "lossy" : "lossless");
+			success = write_test_segment(test_folder, name, samples, TEST_APPEND_SPLITS[0], lossy == 1, 1, segment_path);
+			for (i = 0; i < TEST_NUM_APPEND_SPLITS && success; i++) {
+				si8 append_end = (i + 1 < TEST_NUM_APPEND_SPLITS) ? TEST_APPEND_SPLITS[i + 1] : TEST_NUM_SAMPLES;
+				success = append_test_segment(segment_path, &samples[TEST_APPEND_SPLITS[i]], append_end - TEST_APPEND_SPLITS[i], lossy == 1, 3);
+			}
+			if (success) {
+				MEF_snprintf(label, 256, "%s, single write vs appends", lossy ? "lossy" : "lossless");
+				success = compare_test_segments(test_folder, reference_name, name, label);
+				num_compared++;
+			}
+		}
+	}
+
+	free (samples);
+
+	// check for errors
+	if (!success)
+		mexErrMsgIdAndTxt("MATLAB:test_write_data:mismatch", "the written data differs");
+
+	// return the number of comparisons
+	if (nlhs > 0)
+		plhs[0] = mxCreateDoubleScalar((double) num_compared);
+
+}
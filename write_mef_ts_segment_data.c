@@ -30,6 +30,7 @@
  * @param passwordL2			Level 2 password on the segment data; Pass empty string/variable for no encryption
  * @param samplesPerMefBlock	Number of samples per MEF3 block
  * @param data					The data to write as a 1-D array of data-type int32
+ * @param numThreads			The number of threads used to encode the data [1 = single-threaded (default), 0 = one thread per processor]
  */
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 	
@@ -122,12 +123,22 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 	if (dims[1] != 1) 							mexErrMsgIdAndTxt("MATLAB:write_mef_ts_segment_data:invalidDataArg", "'data' input argument does not have the right dimensions, should be a vector of N-x-1 int32 values");
 	// TODO: check other dimension, if there are enough samples
 	
+	
+	//
+	// Number of threads
+	//
+	
+	si8 num_threads = 1;
+	if (nrhs > 6) {
+		if (!getInputArgAsInt64(prhs[6], "numThreads", 0, 1024, &num_threads))	return;
+	}
+	
 	// 
 	// write the data
 	// (# lossy compression flag - not used)
 	// 
 	bool lossy_flag = false;
-	if (!write_mef_ts_data_and_indices(segment_path, password_l1, password_l2, (ui4)samples_per_block, prhs[5], lossy_flag))
+	if (!write_mef_ts_data_and_indices(segment_path, password_l1, password_l2, (ui4)samples_per_block, prhs[5], lossy_flag, (si4) num_threads))
 		mexErrMsgTxt("Error while writing time-series data");
 	
 	return;
@@ -1,7 +1,7 @@
 %    
 %   Writes time-series data (.tdat & tidx) for a specified segment
 %
-%   write_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, samplesPerBlock, data)
+%   write_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, samplesPerBlock, data, numThreads)
 %
 %       channelPath         = Absolute path to the MEF3 channel directory (to be created or existing)
 %       segmentNum          = The segment number. Should be 0 or a positive integer (1, 2, ...)
@@ -9,12 +9,16 @@
 %       passwordL2          = Segment data level 2 password; Pass empty string/variable for no encryption
 %       samplesPerBlock     = Number of samples per MEF 3 block
 %       data                = The data to write as a 1-D array of data-type int32
+%       numThreads          = (optional) The number of threads used to encode the data [1 = single-threaded, 0 = one thread per processor]
+%                             Default = 1 - Single-threaded
 %
 %   Note:  This function requires that a time-series metadata file (.tmet) is already written for the 
 %          specified segment. The universal-header data of the metadata file (.tmet) will be the base for
 %          universal-headers of the data files (.tdat & tidx). In addition, universal header fields in the
 %          metadata file (.tmet) will be updated according to the data that is passed to this function
 %
+%   Note:  The blocks are encoded in parallel and written in order, the number of threads does not change the output
+%
 %
 %   Copyright 2022, Max van den Boom (Multimodal Neuroimaging Lab, Mayo Clinic, Rochester MN)
 %   Adapted from PyMef (by Jan Cimbalnik, Matt Stead, Ben Brinkmann, and Dan Crepeau)
@@ -25,4 +29,4 @@
 %   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 %   You should have received a copy of the GNU General Public License along with this program.  If not, see <https://www.gnu.org/licenses/>.
 %
-function write_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, samplesPerBlock, data)
+function write_mef_ts_segment_data(channelPath, segmentNum, passwordL1, passwordL2, samplesPerBlock, data, numThreads)